@@ -0,0 +1,377 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_BUFFER_HPP
+#define IPC_BUFFER_HPP
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+#include <utility>
+#if __has_include(<span>)
+#include <span>
+#endif
+
+extern "C" {
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-io.h"
+}
+
+/*
+ * Move-only owners of managed channel buffers.
+ *
+ * TxBuffer owns an acquired buffer until std::move(buf).send() hands it to the
+ * driver; a buffer destroyed without being sent is given back with
+ * ipc_shm_ext_discard_buf(). RxBuffer owns a received buffer and releases it
+ * to the remote on destruction.
+ *
+ * Shared memory may be mapped as device memory where unaligned accesses fault,
+ * so writes and reads go through the aligned copies of ipc-io.h.
+ */
+namespace ipc_shm {
+
+/**
+ * class TxBuffer - owner of a buffer acquired for transmission
+ *
+ * Bytes are appended in place with write(), put() and format(); send()
+ * transmits the bytes written so far.
+ */
+class TxBuffer {
+public:
+	/* longest message format() builds on the stack */
+	static constexpr std::size_t format_max = 256u;
+
+	TxBuffer() noexcept = default;
+
+	/* acquire buffer for a message size known at run time */
+	static TxBuffer acquire(uint8_t instance, int chan_id,
+				std::size_t size) noexcept
+	{
+		void *buf = ipc_shm_ext_acquire_buf(instance, chan_id, size);
+
+		return TxBuffer(instance, chan_id, buf, size);
+	}
+
+	/* acquire buffer of a Channel<> for a size known at compile time */
+	template <typename Ch, std::size_t Size>
+	static TxBuffer acquire() noexcept
+	{
+		return TxBuffer(Ch::instance_id, Ch::channel_id,
+				Ch::template acquire<Size>(), Size);
+	}
+
+	/* take ownership of a buffer acquired for size bytes */
+	static TxBuffer adopt(uint8_t instance, int chan_id, void *buf,
+			      std::size_t size) noexcept
+	{
+		return TxBuffer(instance, chan_id, buf, size);
+	}
+
+	TxBuffer(const TxBuffer &) = delete;
+	TxBuffer &operator=(const TxBuffer &) = delete;
+
+	TxBuffer(TxBuffer &&other) noexcept
+		: instance_(other.instance_), chan_id_(other.chan_id_),
+		  buf_(std::exchange(other.buf_, nullptr)),
+		  capacity_(other.capacity_), size_(other.size_)
+	{
+	}
+
+	TxBuffer &operator=(TxBuffer &&other) noexcept
+	{
+		if (this != &other) {
+			reset();
+			instance_ = other.instance_;
+			chan_id_ = other.chan_id_;
+			buf_ = std::exchange(other.buf_, nullptr);
+			capacity_ = other.capacity_;
+			size_ = other.size_;
+		}
+		return *this;
+	}
+
+	~TxBuffer()
+	{
+		reset();
+	}
+
+	explicit operator bool() const noexcept
+	{
+		return buf_ != nullptr;
+	}
+
+	/* give the buffer back without sending it */
+	void reset() noexcept
+	{
+		if (buf_)
+			ipc_shm_ext_discard_buf(instance_, chan_id_, buf_,
+						capacity_);
+		buf_ = nullptr;
+		size_ = 0;
+	}
+
+	void *data() const noexcept
+	{
+		return buf_;
+	}
+
+	/* size requested at acquire */
+	std::size_t capacity() const noexcept
+	{
+		return capacity_;
+	}
+
+	/* bytes written so far */
+	std::size_t size() const noexcept
+	{
+		return size_;
+	}
+
+	std::size_t remaining() const noexcept
+	{
+		return capacity_ - size_;
+	}
+
+#ifdef __cpp_lib_span
+	/* raw view, accesses must be naturally aligned */
+	std::span<std::byte> span() const noexcept
+	{
+		return {static_cast<std::byte *>(buf_), buf_ ? capacity_ : 0};
+	}
+#endif
+
+	/* append len bytes, false if they don't fit */
+	bool write(const void *src, std::size_t len) noexcept
+	{
+		if (!buf_ || len > remaining())
+			return false;
+
+		ipc_copy_toio(static_cast<char *>(buf_) + size_, src, len);
+		size_ += len;
+		return true;
+	}
+
+	/* append the object representation of v */
+	template <typename T>
+	bool put(const T &v) noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<T>,
+			      "put of non trivially copyable type");
+
+		return write(&v, sizeof(T));
+	}
+
+	/* zero pad up to a multiple of align bytes (a power of two) */
+	bool align(std::size_t align) noexcept
+	{
+		static const unsigned char zero[8] = {};
+		std::size_t pad = (0u - size_) & (align - 1u);
+
+		for (std::size_t n; pad; pad -= n) {
+			n = pad < sizeof(zero) ? pad : sizeof(zero);
+			if (!write(zero, n))
+				return false;
+		}
+		return true;
+	}
+
+	/*
+	 * Append printf formatted text without the terminating null character.
+	 * snprintf may store unaligned, so the text is built on the stack.
+	 */
+	__attribute__((format(printf, 2, 3)))
+	bool format(const char *fmt, ...) noexcept
+	{
+		char tmp[format_max];
+		va_list args;
+		int len;
+
+		va_start(args, fmt);
+		len = std::vsnprintf(tmp, sizeof(tmp), fmt, args);
+		va_end(args);
+		if (len < 0 || std::size_t(len) >= sizeof(tmp))
+			return false;
+
+		return write(tmp, std::size_t(len));
+	}
+
+	/* transmit the bytes written, the buffer is kept on error */
+	int send() && noexcept
+	{
+		return std::move(*this).send(size_);
+	}
+
+	/* transmit size bytes written through data() or span() */
+	int send(std::size_t size) && noexcept
+	{
+		int err;
+
+		if (!buf_ || size > capacity_)
+			return -EINVAL;
+
+		err = ipc_shm_ext_tx(instance_, chan_id_, buf_, size);
+		if (err)
+			return err;
+
+		buf_ = nullptr;
+		size_ = 0;
+		return 0;
+	}
+
+private:
+	TxBuffer(uint8_t instance, int chan_id, void *buf,
+		 std::size_t capacity) noexcept
+		: instance_(instance), chan_id_(chan_id), buf_(buf),
+		  capacity_(buf ? capacity : 0)
+	{
+	}
+
+	uint8_t instance_ = 0;
+	int chan_id_ = 0;
+	void *buf_ = nullptr;
+	std::size_t capacity_ = 0;
+	std::size_t size_ = 0;
+};
+
+/**
+ * class RxBuffer - owner of a received buffer
+ *
+ * Built in the managed channel Rx callback from its arguments. Bytes are read
+ * in order with read() and get(), or at any offset with read_at().
+ *
+ * It must not outlive the callback unless the channel Rx callback is held with
+ * ipc_shm_ext_hold_rx(), as co::Channel does: on channels in Rx copy-out mode
+ * or compressed, the buffer is a copy reused by the next message, and
+ * releasing it is a no-op. A held channel can't enable either mode, so its
+ * buffers may be moved out of the callback and released later.
+ */
+class RxBuffer {
+public:
+	RxBuffer() noexcept = default;
+
+	RxBuffer(uint8_t instance, int chan_id, void *buf,
+		 std::size_t size) noexcept
+		: instance_(instance), chan_id_(chan_id), buf_(buf),
+		  size_(buf ? size : 0)
+	{
+	}
+
+	RxBuffer(const RxBuffer &) = delete;
+	RxBuffer &operator=(const RxBuffer &) = delete;
+
+	RxBuffer(RxBuffer &&other) noexcept
+		: instance_(other.instance_), chan_id_(other.chan_id_),
+		  buf_(std::exchange(other.buf_, nullptr)),
+		  size_(other.size_), pos_(other.pos_)
+	{
+	}
+
+	RxBuffer &operator=(RxBuffer &&other) noexcept
+	{
+		if (this != &other) {
+			reset();
+			instance_ = other.instance_;
+			chan_id_ = other.chan_id_;
+			buf_ = std::exchange(other.buf_, nullptr);
+			size_ = other.size_;
+			pos_ = other.pos_;
+		}
+		return *this;
+	}
+
+	~RxBuffer()
+	{
+		reset();
+	}
+
+	explicit operator bool() const noexcept
+	{
+		return buf_ != nullptr;
+	}
+
+	/* release the buffer to the remote */
+	int reset() noexcept
+	{
+		int err = 0;
+
+		if (buf_)
+			err = ipc_shm_ext_release_buf(instance_, chan_id_,
+						      buf_);
+		buf_ = nullptr;
+		size_ = 0;
+		pos_ = 0;
+		return err;
+	}
+
+	const void *data() const noexcept
+	{
+		return buf_;
+	}
+
+	/* received message size */
+	std::size_t size() const noexcept
+	{
+		return size_;
+	}
+
+	/* bytes not read yet */
+	std::size_t remaining() const noexcept
+	{
+		return size_ - pos_;
+	}
+
+#ifdef __cpp_lib_span
+	/* raw view, accesses must be naturally aligned */
+	std::span<const std::byte> span() const noexcept
+	{
+		return {static_cast<const std::byte *>(buf_), size_};
+	}
+#endif
+
+	/* copy len bytes at offset off, false if out of message bounds */
+	bool read_at(std::size_t off, void *dst, std::size_t len) const noexcept
+	{
+		if (!buf_ || off > size_ || len > size_ - off)
+			return false;
+
+		ipc_copy_fromio(dst, static_cast<const char *>(buf_) + off,
+				    len);
+		return true;
+	}
+
+	/* copy the next len bytes */
+	bool read(void *dst, std::size_t len) noexcept
+	{
+		if (!read_at(pos_, dst, len))
+			return false;
+
+		pos_ += len;
+		return true;
+	}
+
+	/* read the object representation of v */
+	template <typename T>
+	bool get(T &v) noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<T>,
+			      "get of non trivially copyable type");
+
+		return read(&v, sizeof(T));
+	}
+
+private:
+	uint8_t instance_ = 0;
+	int chan_id_ = 0;
+	void *buf_ = nullptr;
+	std::size_t size_ = 0;
+	std::size_t pos_ = 0;
+};
+
+} /* namespace ipc_shm */
+
+#endif /* IPC_BUFFER_HPP */
@@ -0,0 +1,518 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_CORO_HPP
+#define IPC_CORO_HPP
+
+#if __cplusplus < 202002L
+#error "ipc-coro.hpp requires C++20"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <utility>
+
+#include <pthread.h>
+
+#include "ipc-buffer.hpp"
+
+extern "C" {
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-flowctl.h"
+#include "ipc-rpc.h"
+}
+
+/*
+ * C++20 coroutine front end of managed channels.
+ *
+ * Coroutines of an Executor are resumed directly from the events that
+ * complete their awaits: received buffers in the channel Rx callback and
+ * released buffers in the Rx event hook of the flow control helpers, both
+ * running on the instance Rx softirq thread. There is no handoff to another
+ * thread per message. The executor lock serializes the coroutines, so at most
+ * one of them runs at a time and they need no locking among themselves. A
+ * coroutine must not block, as that stalls reception for the whole instance.
+ */
+namespace ipc_shm::co {
+
+/**
+ * class task - coroutine started with Executor::spawn()
+ *
+ * The coroutine frame is destroyed when the coroutine returns.
+ */
+class task {
+public:
+	struct promise_type {
+		task get_return_object() noexcept
+		{
+			return task(handle::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void() noexcept
+		{
+		}
+
+		void unhandled_exception() noexcept
+		{
+			std::terminate();
+		}
+	};
+
+	using handle = std::coroutine_handle<promise_type>;
+
+	task(task &&other) noexcept : h_(std::exchange(other.h_, {}))
+	{
+	}
+
+	task(const task &) = delete;
+	task &operator=(const task &) = delete;
+	task &operator=(task &&) = delete;
+
+	~task()
+	{
+		if (h_)
+			h_.destroy();
+	}
+
+	handle release() noexcept
+	{
+		return std::exchange(h_, {});
+	}
+
+private:
+	explicit task(handle h) noexcept : h_(h)
+	{
+	}
+
+	handle h_;
+};
+
+/**
+ * class pi_mutex - mutex with priority inheritance
+ *
+ * Taken by the SCHED_FIFO Rx thread and by application threads, so that a
+ * preempted application thread holding it can't hold back the Rx thread.
+ */
+class pi_mutex {
+public:
+	pi_mutex() noexcept
+	{
+		pthread_mutexattr_t attr;
+
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+		pthread_mutex_init(&m_, &attr);
+		pthread_mutexattr_destroy(&attr);
+	}
+
+	~pi_mutex()
+	{
+		pthread_mutex_destroy(&m_);
+	}
+
+	pi_mutex(const pi_mutex &) = delete;
+	pi_mutex &operator=(const pi_mutex &) = delete;
+
+	void lock() noexcept
+	{
+		pthread_mutex_lock(&m_);
+	}
+
+	void unlock() noexcept
+	{
+		pthread_mutex_unlock(&m_);
+	}
+
+private:
+	pthread_mutex_t m_;
+};
+
+/**
+ * class Executor - serializes the coroutines of an instance
+ * @instance:	instance id
+ */
+class Executor {
+public:
+	explicit Executor(uint8_t instance) noexcept : instance_(instance)
+	{
+	}
+
+	Executor(const Executor &) = delete;
+	Executor &operator=(const Executor &) = delete;
+
+	uint8_t instance() const noexcept
+	{
+		return instance_;
+	}
+
+	/* start t on the calling thread, up to its first suspension */
+	void spawn(task t) noexcept
+	{
+		task::handle h = t.release();
+
+		if (h)
+			resume(h);
+	}
+
+	/* resume h with the executor lock held */
+	void resume(std::coroutine_handle<> h) noexcept
+	{
+		run([h] { h.resume(); });
+	}
+
+	/* call f with the executor lock held, nested calls don't relock */
+	template <typename F>
+	void run(F &&f) noexcept
+	{
+		Executor *&cur = current();
+
+		if (cur == this) {
+			f();
+			return;
+		}
+
+		std::lock_guard<pi_mutex> guard(lock_);
+		Executor *prev = std::exchange(cur, this);
+
+		f();
+		cur = prev;
+	}
+
+private:
+	/* executor whose lock is held by the calling thread */
+	static Executor *&current() noexcept
+	{
+		static thread_local Executor *cur;
+
+		return cur;
+	}
+
+	uint8_t instance_;
+	pi_mutex lock_;
+};
+
+/**
+ * class Channel - managed channel served by an Executor
+ * @exec:	executor of the channel instance
+ * @chan_id:	channel index
+ *
+ * Holds the channel Rx callback until destroyed (see ipc_shm_ext_hold_rx()),
+ * as received buffers are kept after the callback returns, so channels in Rx
+ * copy-out mode, compressed or held by another layer are refused, and both
+ * modes are refused while the channel exists. Requests start with a
+ * struct ipc_rpc_hdr whose corr_id is set by request(), and the remote copies
+ * it to the reply (see ipc-rpc.h). Received buffers starting with the
+ * correlation id of a pending request() complete it, in any order; other
+ * buffers complete receive() awaits in order, and buffers nobody waits for
+ * are queued for the next receive().
+ */
+class Channel {
+	/* suspended receive() or request() */
+	struct rx_waiter {
+		rx_waiter *next = nullptr;
+		std::coroutine_handle<> h;
+		uint32_t corr_id = 0;
+		RxBuffer msg;
+	};
+
+	/* FIFO of suspended awaits */
+	struct rx_waiters {
+		rx_waiter *head = nullptr;
+		rx_waiter *tail = nullptr;
+
+		void push(rx_waiter *w) noexcept
+		{
+			w->next = nullptr;
+			if (tail)
+				tail->next = w;
+			else
+				head = w;
+			tail = w;
+		}
+
+		rx_waiter *pop() noexcept
+		{
+			rx_waiter *w = head;
+
+			if (w) {
+				head = w->next;
+				if (!head)
+					tail = nullptr;
+			}
+			return w;
+		}
+
+		/* remove the request waiting for a correlation id */
+		rx_waiter *take(uint32_t corr_id) noexcept
+		{
+			rx_waiter *w, *prev = nullptr;
+
+			for (w = head; w; prev = w, w = w->next) {
+				if (w->corr_id != corr_id)
+					continue;
+				if (prev)
+					prev->next = w->next;
+				else
+					head = w->next;
+				if (tail == w)
+					tail = prev;
+				break;
+			}
+			return w;
+		}
+	};
+
+public:
+	Channel(Executor &exec, int chan_id) noexcept
+		: exec_(exec), chan_id_(chan_id)
+	{
+		err_ = ipc_shm_ext_hold_rx(exec.instance(), chan_id, rx_cb,
+					   this, &saved_cb_, &saved_arg_);
+	}
+
+	/* give the channel back to its previous Rx callback */
+	~Channel()
+	{
+		if (err_)
+			return;
+
+		ipc_shm_ext_unhold_rx(exec_.instance(), chan_id_, saved_cb_,
+				      saved_arg_);
+		/* wait for a callback still running on the Rx thread */
+		exec_.run([] {});
+	}
+
+	Channel(const Channel &) = delete;
+	Channel &operator=(const Channel &) = delete;
+
+	/* error code of holding the channel Rx callback */
+	int error() const noexcept
+	{
+		return err_;
+	}
+
+	uint8_t instance() const noexcept
+	{
+		return exec_.instance();
+	}
+
+	int id() const noexcept
+	{
+		return chan_id_;
+	}
+
+	class receive_awaiter : rx_waiter {
+	public:
+		explicit receive_awaiter(Channel &ch) noexcept : ch_(ch)
+		{
+		}
+
+		bool await_ready() noexcept
+		{
+			if (ch_.backlog_.empty())
+				return false;
+
+			this->msg = std::move(ch_.backlog_.front());
+			ch_.backlog_.pop_front();
+			return true;
+		}
+
+		void await_suspend(std::coroutine_handle<> h) noexcept
+		{
+			this->h = h;
+			ch_.receivers_.push(this);
+		}
+
+		RxBuffer await_resume() noexcept
+		{
+			return std::move(this->msg);
+		}
+
+	private:
+		Channel &ch_;
+	};
+
+	class request_awaiter : rx_waiter {
+	public:
+		request_awaiter(Channel &ch, TxBuffer &&req) noexcept
+			: ch_(ch), req_(std::move(req))
+		{
+		}
+
+		bool await_ready() noexcept
+		{
+			return false;
+		}
+
+		/*
+		 * Replies can't overtake the registration: the Rx callback
+		 * waits for the executor lock, held while this runs.
+		 */
+		bool await_suspend(std::coroutine_handle<> h) noexcept
+		{
+			if (req_.size() < sizeof(ipc_rpc_hdr))
+				return false;
+
+			this->corr_id = ++ch_.next_corr_id_;
+			ipc_copy_toio(static_cast<char *>(req_.data())
+				      + offsetof(ipc_rpc_hdr, corr_id),
+				      &this->corr_id, sizeof(this->corr_id));
+			if (std::move(req_).send())
+				return false;
+
+			this->h = h;
+			ch_.requests_.push(this);
+			return true;
+		}
+
+		RxBuffer await_resume() noexcept
+		{
+			return std::move(this->msg);
+		}
+
+	private:
+		Channel &ch_;
+		TxBuffer req_;
+	};
+
+	class acquire_awaiter {
+		enum { submitting, waiting, completed };
+
+	public:
+		acquire_awaiter(Channel &ch, std::size_t size) noexcept
+			: ch_(ch), size_(size)
+		{
+		}
+
+		/* both paths reserve room for the payload trailers */
+		bool await_ready() noexcept
+		{
+			buf_ = TxBuffer::acquire(ch_.instance(), ch_.id(),
+						 size_);
+			return bool(buf_);
+		}
+
+		/*
+		 * The completion may run right away on this thread or on the
+		 * Rx thread before this returns; whoever moves state_ from
+		 * submitting first decides if the coroutine suspends.
+		 */
+		bool await_suspend(std::coroutine_handle<> h) noexcept
+		{
+			int expected = submitting;
+
+			h_ = h;
+			if (ipc_shm_acquire_buf_async(ch_.instance(), ch_.id(),
+						      size_, acquired, this))
+				return false;
+
+			return state_.compare_exchange_strong(expected,
+							      waiting);
+		}
+
+		TxBuffer await_resume() noexcept
+		{
+			return std::move(buf_);
+		}
+
+	private:
+		static void acquired(void *arg, const uint8_t instance,
+				     int chan_id, void *buf)
+		{
+			auto *a = static_cast<acquire_awaiter *>(arg);
+			int expected = submitting;
+
+			if (buf)
+				a->buf_ = TxBuffer::adopt(instance, chan_id,
+							  buf, a->size_);
+			if (!a->state_.compare_exchange_strong(expected,
+							       completed))
+				a->ch_.exec_.resume(a->h_);
+		}
+
+		Channel &ch_;
+		std::size_t size_;
+		TxBuffer buf_;
+		std::coroutine_handle<> h_;
+		std::atomic<int> state_{submitting};
+	};
+
+	/* next received buffer */
+	receive_awaiter receive() noexcept
+	{
+		return receive_awaiter(*this);
+	}
+
+	/* buffer of at least size bytes, empty if it can't be waited for */
+	acquire_awaiter acquire(std::size_t size) noexcept
+	{
+		return acquire_awaiter(*this, size);
+	}
+
+	/*
+	 * Send req, starting with a struct ipc_rpc_hdr, and wait for the reply,
+	 * empty if req can't be sent
+	 */
+	request_awaiter request(TxBuffer &&req) noexcept
+	{
+		return request_awaiter(*this, std::move(req));
+	}
+
+private:
+	static void rx_cb(void *arg, const uint8_t instance, int chan_id,
+			  void *buf, size_t size)
+	{
+		auto *ch = static_cast<Channel *>(arg);
+
+		ch->exec_.run([&] {
+			RxBuffer msg(instance, chan_id, buf, size);
+			rx_waiter *w = nullptr;
+			uint32_t corr_id;
+
+			if (ch->requests_.head
+			    && msg.read_at(offsetof(ipc_rpc_hdr, corr_id),
+					   &corr_id, sizeof(corr_id)))
+				w = ch->requests_.take(corr_id);
+			if (!w)
+				w = ch->receivers_.pop();
+			if (!w) {
+				ch->backlog_.push_back(std::move(msg));
+				return;
+			}
+
+			w->msg = std::move(msg);
+			w->h.resume();
+		});
+	}
+
+	Executor &exec_;
+	int chan_id_;
+	int err_;
+	ipc_shm_rx_cb saved_cb_ = nullptr;
+	void *saved_arg_ = nullptr;
+	uint32_t next_corr_id_ = 0;
+	std::deque<RxBuffer> backlog_;
+	rx_waiters receivers_;
+	rx_waiters requests_;
+};
+
+} /* namespace ipc_shm::co */
+
+#endif /* IPC_CORO_HPP */
@@ -0,0 +1,460 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_SHM_HPP
+#define IPC_SHM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-layout.h"
+}
+
+/*
+ * Compile-time validated C++17 front end of the driver.
+ *
+ * Instances, channels and pools are declared constexpr and checked with
+ * static_assert: pools sorted by buffer size, buffer sizes aligned and the
+ * footprint of each instance within its shm_size. Channel<> handles have the
+ * instance, channel and first fitting pool resolved and the message size
+ * checked against the pools at compile time, and call the extended API
+ * without argument checks nor lookups, so that payload trailers, Rx copies and
+ * the discard stash are still handled. c_config<> builds the C configuration
+ * passed to the driver from the constexpr declaration.
+ */
+namespace ipc_shm {
+
+/**
+ * struct pool - buffer pool declaration
+ * @num_bufs:	number of buffers
+ * @buf_size:	buffer size
+ */
+struct pool {
+	uint16_t num_bufs;
+	uint32_t buf_size;
+};
+
+/**
+ * struct channel - channel declaration
+ * @type:	managed or unmanaged
+ * @size:	unmanaged channel memory size
+ * @num_pools:	number of pools of a managed channel
+ * @pools:	pools of a managed channel, sorted ascending by buffer size
+ */
+struct channel {
+	ipc_shm_channel_type type;
+	uint32_t size;
+	int num_pools;
+	pool pools[IPC_SHM_MAX_POOLS];
+};
+
+template <typename... Pools>
+constexpr channel managed(Pools... pools)
+{
+	static_assert(sizeof...(Pools) > 0, "managed channel without pools");
+	static_assert(sizeof...(Pools) <= IPC_SHM_MAX_POOLS, "too many pools");
+
+	return channel{IPC_SHM_MANAGED, 0, int(sizeof...(Pools)), {pools...}};
+}
+
+constexpr channel unmanaged(uint32_t size)
+{
+	return channel{IPC_SHM_UNMANAGED, size, 0, {}};
+}
+
+/**
+ * struct instance - instance declaration
+ * @local_shm_addr:	local shared memory physical address
+ * @remote_shm_addr:	remote shared memory physical address
+ * @shm_size:		local/remote shared memory size
+ * @inter_core_tx_irq:	inter-core interrupt for Tx notifications
+ * @inter_core_rx_irq:	inter-core interrupt for Rx notifications
+ * @local_core:		local core targeted by remote notifications
+ * @remote_core:	remote core to notify
+ * @num_channels:	number of channels
+ * @channels:		channels declaration
+ */
+struct instance {
+	uintptr_t local_shm_addr;
+	uintptr_t remote_shm_addr;
+	uint32_t shm_size;
+	int inter_core_tx_irq;
+	int inter_core_rx_irq;
+	ipc_shm_local_core local_core;
+	ipc_shm_remote_core remote_core;
+	int num_channels;
+	channel channels[IPC_SHM_MAX_CHANNELS];
+};
+
+/**
+ * struct config - configuration of all instances
+ * @num_instances:	number of instances
+ * @instances:		instances declaration
+ */
+template <std::size_t N>
+struct config {
+	static_assert(N > 0, "configuration without instances");
+
+	static constexpr std::size_t num_instances = N;
+	instance instances[N];
+};
+
+template <typename... Channels>
+constexpr instance make_instance(uintptr_t local_shm_addr,
+		uintptr_t remote_shm_addr, uint32_t shm_size,
+		int inter_core_tx_irq, int inter_core_rx_irq,
+		ipc_shm_local_core local_core, ipc_shm_remote_core remote_core,
+		Channels... channels)
+{
+	static_assert(sizeof...(Channels) > 0, "instance without channels");
+	static_assert(sizeof...(Channels) <= IPC_SHM_MAX_CHANNELS,
+		      "too many channels");
+
+	return instance{local_shm_addr, remote_shm_addr, shm_size,
+			inter_core_tx_irq, inter_core_rx_irq, local_core,
+			remote_core, int(sizeof...(Channels)), {channels...}};
+}
+
+template <typename... Instances>
+constexpr config<sizeof...(Instances)> make_config(Instances... instances)
+{
+	return config<sizeof...(Instances)>{{instances...}};
+}
+
+/* checks usable on constexpr declarations as well as C structs */
+
+constexpr bool pools_sorted(const ipc_shm_pool_cfg *pools, int num_pools)
+{
+	for (int i = 1; i < num_pools; i++)
+		if (pools[i].buf_size < pools[i - 1].buf_size)
+			return false;
+	return true;
+}
+
+constexpr bool pools_sorted(const channel &ch)
+{
+	for (int i = 1; i < ch.num_pools; i++)
+		if (ch.pools[i].buf_size < ch.pools[i - 1].buf_size)
+			return false;
+	return true;
+}
+
+constexpr bool pools_aligned(const channel &ch)
+{
+	for (int i = 0; i < ch.num_pools; i++)
+		if (ch.pools[i].buf_size % IPC_LAYOUT_BUF_ALIGN)
+			return false;
+	return true;
+}
+
+constexpr bool pools_valid(const channel &ch)
+{
+	if (ch.type != IPC_SHM_MANAGED)
+		return ch.size > 0;
+	if (ch.num_pools <= 0 || ch.num_pools > int(IPC_SHM_MAX_POOLS))
+		return false;
+	for (int i = 0; i < ch.num_pools; i++)
+		if (!ch.pools[i].num_bufs || !ch.pools[i].buf_size
+		    || ch.pools[i].num_bufs > IPC_SHM_MAX_BUFS_PER_POOL)
+			return false;
+	return true;
+}
+
+constexpr uint64_t footprint(const channel &ch)
+{
+	uint64_t size = 0, bufs = 0;
+
+	if (ch.type != IPC_SHM_MANAGED)
+		return ch.size;
+
+	for (int i = 0; i < ch.num_pools; i++) {
+		size += IPC_LAYOUT_POOL_SIZE(uint64_t(ch.pools[i].buf_size),
+					     uint64_t(ch.pools[i].num_bufs));
+		bufs += ch.pools[i].num_bufs;
+	}
+
+	return size + IPC_LAYOUT_MANAGED_SIZE(bufs);
+}
+
+constexpr uint64_t footprint(const instance &inst)
+{
+	uint64_t size = IPC_LAYOUT_GLOBAL_SIZE;
+
+	for (int i = 0; i < inst.num_channels; i++)
+		size += footprint(inst.channels[i]);
+
+	return size;
+}
+
+template <std::size_t N>
+constexpr bool shm_fits(const config<N> &cfg)
+{
+	for (std::size_t i = 0; i < N; i++)
+		if (footprint(cfg.instances[i]) > cfg.instances[i].shm_size)
+			return false;
+	return true;
+}
+
+template <std::size_t N>
+constexpr bool shm_aligned(const config<N> &cfg)
+{
+	for (std::size_t i = 0; i < N; i++)
+		if (cfg.instances[i].local_shm_addr % IPC_LAYOUT_BUF_ALIGN
+		    || cfg.instances[i].remote_shm_addr % IPC_LAYOUT_BUF_ALIGN)
+			return false;
+	return true;
+}
+
+template <std::size_t N>
+constexpr bool channels_sorted(const config<N> &cfg)
+{
+	for (std::size_t i = 0; i < N; i++)
+		for (int j = 0; j < cfg.instances[i].num_channels; j++)
+			if (!pools_sorted(cfg.instances[i].channels[j]))
+				return false;
+	return true;
+}
+
+template <std::size_t N>
+constexpr bool channels_aligned(const config<N> &cfg)
+{
+	for (std::size_t i = 0; i < N; i++)
+		for (int j = 0; j < cfg.instances[i].num_channels; j++)
+			if (!pools_aligned(cfg.instances[i].channels[j]))
+				return false;
+	return true;
+}
+
+template <std::size_t N>
+constexpr bool channels_valid(const config<N> &cfg)
+{
+	for (std::size_t i = 0; i < N; i++)
+		for (int j = 0; j < cfg.instances[i].num_channels; j++)
+			if (!pools_valid(cfg.instances[i].channels[j]))
+				return false;
+	return true;
+}
+
+/* validate a whole configuration at compile time */
+template <const auto &Cfg>
+struct validate {
+	static_assert(channels_valid(Cfg),
+		      "channel without pools, buffers or memory");
+	static_assert(channels_sorted(Cfg),
+		      "pools must be sorted in ascending order by buffer size");
+	static_assert(channels_aligned(Cfg),
+		      "pool buffer sizes must be multiple of 8 bytes");
+	static_assert(shm_aligned(Cfg),
+		      "shared memory addresses must be 8 byte aligned");
+	static_assert(shm_fits(Cfg),
+		      "channels don't fit in shm_size");
+	static constexpr bool value = true;
+};
+
+/* first pool that fits size, num_pools if none */
+constexpr int first_fit(const channel &ch, std::size_t size)
+{
+	int i = 0;
+
+	while (i < ch.num_pools && ch.pools[i].buf_size < size)
+		i++;
+
+	return i;
+}
+
+/**
+ * class Channel - channel handle specialized at compile time
+ * @Cfg:	constexpr configuration
+ * @Inst:	instance id
+ * @Chan:	channel index
+ *
+ * The compile-time size check of acquire<Size>() doesn't account for payload
+ * trailers, enabled at run time: on channels with integrity or compression
+ * trailers, a size that passes it may need a larger pool than the channel has,
+ * and acquire<Size>() then returns nullptr.
+ */
+template <const auto &Cfg, uint8_t Inst, int Chan>
+class Channel {
+	static_assert(validate<Cfg>::value);
+	static_assert(Inst < Cfg.num_instances, "invalid instance");
+	static_assert(Chan >= 0 && Chan < Cfg.instances[Inst].num_channels,
+		      "invalid channel");
+
+	static constexpr const channel &desc =
+		Cfg.instances[Inst].channels[Chan];
+
+	/* resolved once, valid across initializations */
+	static inline ipc_ext_chan *const ext_ =
+		ipc_shm_ext_get_chan(Inst, Chan);
+
+public:
+	static constexpr uint8_t instance_id = Inst;
+	static constexpr int channel_id = Chan;
+	static constexpr bool is_managed = desc.type == IPC_SHM_MANAGED;
+	static constexpr uint32_t max_size =
+		is_managed ? desc.pools[desc.num_pools - 1].buf_size
+			   : desc.size;
+
+	/* acquire buffer for a message size known at compile time */
+	template <std::size_t Size>
+	static void *acquire() noexcept
+	{
+		static_assert(is_managed, "acquire on unmanaged channel");
+		static_assert(first_fit(desc, Size) < desc.num_pools,
+			      "no pool fits message size");
+
+		/* room for the payload trailers is added at run time */
+		return ipc_shm_ext_chan_acquire_buf(ext_, first_fit(desc, Size),
+						    Size);
+	}
+
+	/* acquire buffer for a message size known at run time */
+	static void *acquire(std::size_t size) noexcept
+	{
+		static_assert(is_managed, "acquire on unmanaged channel");
+
+		return ipc_shm_ext_acquire_buf(Inst, Chan, size);
+	}
+
+	static int tx(void *buf, std::size_t size) noexcept
+	{
+		static_assert(is_managed, "tx buffer on unmanaged channel");
+
+		return ipc_shm_ext_chan_tx(ext_, buf, size);
+	}
+
+	static int release(const void *buf) noexcept
+	{
+		static_assert(is_managed, "release on unmanaged channel");
+
+		return ipc_shm_ext_release_buf(Inst, Chan, buf);
+	}
+
+	/* unmanaged channel memory */
+	static void *memory() noexcept
+	{
+		static_assert(!is_managed, "memory of managed channel");
+
+		return ipc_shm_unmanaged_acquire(Inst, Chan);
+	}
+
+	static int tx() noexcept
+	{
+		static_assert(!is_managed, "tx memory of managed channel");
+
+		return ipc_shm_unmanaged_tx(Inst, Chan);
+	}
+};
+
+/**
+ * class c_config - C configuration built from a constexpr declaration
+ * @Cfg:	constexpr configuration
+ *
+ * Rx callbacks are bound at run time, before init().
+ */
+template <const auto &Cfg>
+class c_config {
+	static_assert(validate<Cfg>::value);
+
+	static constexpr std::size_t N = Cfg.num_instances;
+
+	static inline ipc_shm_pool_cfg pools[N][IPC_SHM_MAX_CHANNELS]
+					    [IPC_SHM_MAX_POOLS];
+	static inline ipc_shm_channel_cfg channels[N][IPC_SHM_MAX_CHANNELS];
+	static inline ipc_shm_cfg shm_cfg[N];
+	static inline ipc_shm_instances_cfg cfg;
+
+	static void build()
+	{
+		for (std::size_t i = 0; i < N; i++) {
+			const instance &inst = Cfg.instances[i];
+
+			for (int j = 0; j < inst.num_channels; j++) {
+				const channel &ch = inst.channels[j];
+				ipc_shm_channel_cfg &c = channels[i][j];
+
+				c.type = ch.type;
+				if (ch.type != IPC_SHM_MANAGED) {
+					c.ch.unmanaged.size = ch.size;
+					continue;
+				}
+				for (int k = 0; k < ch.num_pools; k++) {
+					pools[i][j][k].num_bufs =
+						ch.pools[k].num_bufs;
+					pools[i][j][k].buf_size =
+						ch.pools[k].buf_size;
+				}
+				c.ch.managed.num_pools = ch.num_pools;
+				c.ch.managed.pools = pools[i][j];
+			}
+
+			shm_cfg[i].local_shm_addr = inst.local_shm_addr;
+			shm_cfg[i].remote_shm_addr = inst.remote_shm_addr;
+			shm_cfg[i].shm_size = inst.shm_size;
+			shm_cfg[i].inter_core_tx_irq = inst.inter_core_tx_irq;
+			shm_cfg[i].inter_core_rx_irq = inst.inter_core_rx_irq;
+			shm_cfg[i].local_core = inst.local_core;
+			shm_cfg[i].remote_core = inst.remote_core;
+			shm_cfg[i].num_channels = inst.num_channels;
+			shm_cfg[i].channels = channels[i];
+		}
+
+		cfg.num_instances = uint8_t(N);
+		cfg.shm_cfg = shm_cfg;
+	}
+
+	static void ensure_built()
+	{
+		static const bool done = (build(), true);
+
+		(void)done;
+	}
+
+public:
+	template <uint8_t Inst, int Chan>
+	static void bind(void (*rx_cb)(void *, const uint8_t, int, void *,
+				       size_t), void *arg = nullptr) noexcept
+	{
+		static_assert(Channel<Cfg, Inst, Chan>::is_managed);
+
+		ensure_built();
+		channels[Inst][Chan].ch.managed.rx_cb = rx_cb;
+		channels[Inst][Chan].ch.managed.cb_arg = arg;
+	}
+
+	template <uint8_t Inst, int Chan>
+	static void bind(void (*rx_cb)(void *, const uint8_t, int, void *),
+			 void *arg = nullptr) noexcept
+	{
+		static_assert(!Channel<Cfg, Inst, Chan>::is_managed);
+
+		ensure_built();
+		channels[Inst][Chan].ch.unmanaged.rx_cb = rx_cb;
+		channels[Inst][Chan].ch.unmanaged.cb_arg = arg;
+	}
+
+	/* C configuration, e.g. to pass to C code or ipc_shm_init() */
+	static const ipc_shm_instances_cfg &get() noexcept
+	{
+		ensure_built();
+		return cfg;
+	}
+
+	static int init() noexcept
+	{
+		return ipc_shm_ext_init(&get());
+	}
+
+	static void free() noexcept
+	{
+		ipc_shm_ext_free();
+	}
+};
+
+} /* namespace ipc_shm */
+
+#endif /* IPC_SHM_HPP */
@@ -0,0 +1,411 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-broker-proto.h"
+#include "ipc-broker.h"
+
+/**
+ * struct ipc_client_inst - shared memory of an instance mapped by the client
+ * @local_map:		local ShM mapped page address, NULL if not mapped
+ * @remote_map:		remote ShM mapped page address
+ * @local_map_size:	local ShM mapping size
+ * @remote_map_size:	remote ShM mapping size
+ * @local_shm:		local ShM address
+ * @remote_shm:		remote ShM address
+ * @shm_size:		local/remote ShM size
+ */
+struct ipc_client_inst {
+	void *local_map;
+	void *remote_map;
+	size_t local_map_size;
+	size_t remote_map_size;
+	char *local_shm;
+	char *remote_shm;
+	size_t shm_size;
+};
+
+/**
+ * struct ipc_client_chan - client data of a claimed channel
+ * @claimed:	true once claimed
+ * @area:	rings shared with the broker
+ * @rx_fd:	eventfd signaled by the broker on Rx
+ * @kick_fd:	eventfd signaled to the broker on Tx and release
+ * @num_pools:	number of buffer pools
+ * @buf_size:	buffer size of each pool
+ * @rx_held:	offset + 1 of the received buffer of each Rx slot, 0 if free
+ * @tx_held:	offset + 1 of the acquired buffer of each Tx slot, 0 if free
+ */
+struct ipc_client_chan {
+	bool claimed;
+	struct ipc_broker_area *area;
+	int rx_fd;
+	int kick_fd;
+	uint32_t num_pools;
+	uint32_t buf_size[IPC_SHM_MAX_POOLS];
+	uint32_t rx_held[IPC_BROKER_RX_SLOTS];
+	uint32_t tx_held[IPC_BROKER_TX_SLOTS];
+};
+
+/**
+ * struct ipc_client_priv - client private data
+ * @sock:	broker connection, -1 if not connected
+ * @inst:	mappings per instance
+ * @chan:	client data per instance and channel
+ */
+static struct ipc_client_priv {
+	int sock;
+	struct ipc_client_inst inst[IPC_SHM_MAX_INSTANCES];
+	struct ipc_client_chan
+		chan[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+} priv = {
+	.sock = -1,
+};
+
+static struct ipc_client_chan *ipc_client_get_chan(const uint8_t instance,
+		int chan_id)
+{
+	if (instance >= IPC_SHM_MAX_INSTANCES || chan_id < 0
+	    || chan_id >= (int)IPC_SHM_MAX_CHANNELS
+	    || !priv.chan[instance][chan_id].claimed)
+		return NULL;
+
+	return &priv.chan[instance][chan_id];
+}
+
+static void ipc_client_kick(struct ipc_client_chan *chan)
+{
+	const uint64_t one = 1u;
+
+	if (write(chan->kick_fd, &one, sizeof(one)) != sizeof(one)) {
+		shm_dbg("Can't kick broker\n");
+	}
+}
+
+/* map file range, mmap offsets must be page aligned */
+static char *ipc_client_map(int fd, off_t off, size_t size, void **map,
+		size_t *map_size)
+{
+	off_t page_off = off - off % sysconf(_SC_PAGE_SIZE);
+
+	*map_size = off - page_off + size;
+	*map = mmap(NULL, *map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+		    page_off);
+	if (*map == MAP_FAILED) {
+		*map = NULL;
+		return NULL;
+	}
+
+	return (char *)*map + (off - page_off);
+}
+
+static void ipc_client_unmap_inst(struct ipc_client_inst *inst)
+{
+	if (!inst->local_map)
+		return;
+
+	munmap(inst->remote_map, inst->remote_map_size);
+	munmap(inst->local_map, inst->local_map_size);
+	inst->local_map = NULL;
+}
+
+static int ipc_client_map_inst(struct ipc_client_inst *inst,
+		const struct ipc_broker_resp *resp, const int *fds)
+{
+	if (inst->local_map)
+		return 0;
+
+	inst->shm_size = resp->shm_size;
+	inst->local_shm = ipc_client_map(fds[IPC_BROKER_FD_LOCAL_SHM],
+					 resp->local_off, resp->shm_size,
+					 &inst->local_map,
+					 &inst->local_map_size);
+	if (!inst->local_shm)
+		return -ENOMEM;
+
+	inst->remote_shm = ipc_client_map(fds[IPC_BROKER_FD_REMOTE_SHM],
+					  resp->remote_off, resp->shm_size,
+					  &inst->remote_map,
+					  &inst->remote_map_size);
+	if (!inst->remote_shm) {
+		munmap(inst->local_map, inst->local_map_size);
+		inst->local_map = NULL;
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/* receive broker reply and the file descriptors passed with it */
+static int ipc_client_recv_resp(struct ipc_broker_resp *resp, int *fds)
+{
+	char control[CMSG_SPACE(IPC_BROKER_NUM_FDS * sizeof(int))];
+	struct iovec iov = {
+		.iov_base = resp,
+		.iov_len = sizeof(*resp),
+	};
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = control,
+		.msg_controllen = sizeof(control),
+	};
+	struct cmsghdr *cmsg;
+	ssize_t len;
+
+	len = recvmsg(priv.sock, &msg, MSG_CMSG_CLOEXEC);
+	if (len < 0)
+		return -errno;
+	if (len != sizeof(*resp))
+		return -EPROTO;
+	if (resp->err)
+		return resp->err;
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS
+	    || cmsg->cmsg_len != CMSG_LEN(IPC_BROKER_NUM_FDS * sizeof(int)))
+		return -EPROTO;
+	memcpy(fds, CMSG_DATA(cmsg), IPC_BROKER_NUM_FDS * sizeof(int));
+
+	return 0;
+}
+
+int ipc_shm_client_open(const char *path)
+{
+	struct sockaddr_un addr = {
+		.sun_family = AF_UNIX,
+	};
+
+	if (priv.sock >= 0 || !path || strlen(path) >= sizeof(addr.sun_path))
+		return -EINVAL;
+
+	strcpy(addr.sun_path, path);
+	priv.sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (priv.sock < 0)
+		return -errno;
+
+	if (connect(priv.sock, (struct sockaddr *)&addr, sizeof(addr))) {
+		shm_err("Can't connect to broker %s\n", path);
+		close(priv.sock);
+		priv.sock = -1;
+		return -ECONNREFUSED;
+	}
+
+	return 0;
+}
+
+void ipc_shm_client_close(void)
+{
+	struct ipc_client_chan *chan;
+	uint32_t i, j;
+
+	if (priv.sock < 0)
+		return;
+
+	/* the broker takes back the buffers of the client on disconnect */
+	close(priv.sock);
+	priv.sock = -1;
+
+	for (i = 0; i < IPC_SHM_MAX_INSTANCES; i++) {
+		for (j = 0; j < IPC_SHM_MAX_CHANNELS; j++) {
+			chan = &priv.chan[i][j];
+			if (!chan->claimed)
+				continue;
+			munmap(chan->area, sizeof(*chan->area));
+			close(chan->kick_fd);
+			close(chan->rx_fd);
+			memset(chan, 0, sizeof(*chan));
+		}
+		ipc_client_unmap_inst(&priv.inst[i]);
+	}
+}
+
+int ipc_shm_client_claim(const uint8_t instance, int chan_id)
+{
+	struct ipc_broker_req req = {
+		.op = IPC_BROKER_CLAIM,
+		.instance = instance,
+		.chan_id = chan_id,
+	};
+	struct ipc_broker_resp resp;
+	struct ipc_client_chan *chan;
+	int fds[IPC_BROKER_NUM_FDS];
+	int err;
+
+	if (priv.sock < 0 || instance >= IPC_SHM_MAX_INSTANCES || chan_id < 0
+	    || chan_id >= (int)IPC_SHM_MAX_CHANNELS)
+		return -EINVAL;
+
+	chan = &priv.chan[instance][chan_id];
+	if (chan->claimed)
+		return 0;
+
+	if (send(priv.sock, &req, sizeof(req), MSG_NOSIGNAL) != sizeof(req))
+		return -errno;
+
+	err = ipc_client_recv_resp(&resp, fds);
+	if (err)
+		return err;
+
+	err = ipc_client_map_inst(&priv.inst[instance], &resp, fds);
+	if (err)
+		goto out;
+
+	chan->area = mmap(NULL, sizeof(*chan->area), PROT_READ | PROT_WRITE,
+			  MAP_SHARED, fds[IPC_BROKER_FD_AREA], 0);
+	if (chan->area == MAP_FAILED) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	chan->rx_fd = fds[IPC_BROKER_FD_RX];
+	chan->kick_fd = fds[IPC_BROKER_FD_KICK];
+	chan->num_pools = resp.num_pools;
+	memcpy(chan->buf_size, resp.buf_size, sizeof(chan->buf_size));
+	chan->claimed = true;
+
+out:
+	close(fds[IPC_BROKER_FD_AREA]);
+	close(fds[IPC_BROKER_FD_LOCAL_SHM]);
+	close(fds[IPC_BROKER_FD_REMOTE_SHM]);
+	if (err) {
+		close(fds[IPC_BROKER_FD_RX]);
+		close(fds[IPC_BROKER_FD_KICK]);
+	}
+
+	return err;
+}
+
+int ipc_shm_client_get_fd(const uint8_t instance, int chan_id)
+{
+	struct ipc_client_chan *chan = ipc_client_get_chan(instance, chan_id);
+
+	if (!chan)
+		return -EINVAL;
+
+	return chan->rx_fd;
+}
+
+int ipc_shm_client_poll(const uint8_t instance, int chan_id,
+		ipc_shm_rx_cb rx_cb, void *cb_arg)
+{
+	struct ipc_client_chan *chan = ipc_client_get_chan(instance, chan_id);
+	struct ipc_client_inst *inst = &priv.inst[instance];
+	struct ipc_broker_desc desc;
+	uint64_t count;
+	int work = 0;
+
+	if (!chan || !rx_cb)
+		return -EINVAL;
+
+	/* reset notification before looking at the ring, not to miss one */
+	if (read(chan->rx_fd, &count, sizeof(count)) != sizeof(count)) {
+		shm_dbg_ch(instance, chan_id,
+			   "No Rx notification on channel %d\n", chan_id);
+	}
+
+	while (ipc_broker_pop(&chan->area->rx, &desc)) {
+		if (desc.slot >= IPC_BROKER_RX_SLOTS
+		    || desc.off + (size_t)desc.size > inst->shm_size)
+			return -EPROTO;
+
+		chan->rx_held[desc.slot] = desc.off + 1u;
+		rx_cb(cb_arg, instance, chan_id, inst->remote_shm + desc.off,
+		      desc.size);
+		work++;
+	}
+
+	return work;
+}
+
+void *ipc_shm_client_acquire_buf(const uint8_t instance, int chan_id,
+		size_t size)
+{
+	struct ipc_client_chan *chan = ipc_client_get_chan(instance, chan_id);
+	struct ipc_broker_desc desc;
+	uint32_t i;
+
+	if (!chan)
+		return NULL;
+
+	for (i = 0; i < chan->num_pools; i++) {
+		if (chan->buf_size[i] < size)
+			continue;
+		if (ipc_broker_pop(&chan->area->free[i], &desc)
+		    && desc.slot < IPC_BROKER_TX_SLOTS) {
+			chan->tx_held[desc.slot] = desc.off + 1u;
+			return priv.inst[instance].local_shm + desc.off;
+		}
+	}
+
+	/* ask the broker for more buffers, for the next attempt */
+	ipc_client_kick(chan);
+
+	return NULL;
+}
+
+int ipc_shm_client_tx(const uint8_t instance, int chan_id, void *buf,
+		size_t size)
+{
+	struct ipc_client_chan *chan = ipc_client_get_chan(instance, chan_id);
+	struct ipc_broker_desc desc = {0};
+	bool was_empty;
+	uint32_t off;
+
+	if (!chan)
+		return -EINVAL;
+
+	off = (uint32_t)((char *)buf - priv.inst[instance].local_shm);
+	for (desc.slot = 0; desc.slot < IPC_BROKER_TX_SLOTS; desc.slot++)
+		if (chan->tx_held[desc.slot] == off + 1u)
+			break;
+	if (desc.slot == IPC_BROKER_TX_SLOTS)
+		return -EINVAL;
+
+	desc.off = off;
+	desc.size = size;
+	if (!ipc_broker_push(&chan->area->tx, &desc, &was_empty))
+		return -ENOSPC;
+	chan->tx_held[desc.slot] = 0;
+
+	if (was_empty)
+		ipc_client_kick(chan);
+
+	return 0;
+}
+
+int ipc_shm_client_release_buf(const uint8_t instance, int chan_id,
+		const void *buf)
+{
+	struct ipc_client_chan *chan = ipc_client_get_chan(instance, chan_id);
+	struct ipc_broker_desc desc = {0};
+	bool was_empty;
+	uint32_t off;
+
+	if (!chan)
+		return -EINVAL;
+
+	off = (uint32_t)((const char *)buf - priv.inst[instance].remote_shm);
+	for (desc.slot = 0; desc.slot < IPC_BROKER_RX_SLOTS; desc.slot++)
+		if (chan->rx_held[desc.slot] == off + 1u)
+			break;
+	if (desc.slot == IPC_BROKER_RX_SLOTS)
+		return -EINVAL;
+
+	desc.off = off;
+	if (!ipc_broker_push(&chan->area->release, &desc, &was_empty))
+		return -ENOSPC;
+	chan->rx_held[desc.slot] = 0;
+
+	if (was_empty)
+		ipc_client_kick(chan);
+
+	return 0;
+}
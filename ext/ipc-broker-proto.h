@@ -0,0 +1,184 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_BROKER_PROTO_H
+#define IPC_BROKER_PROTO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ipc-shm.h"
+#include "ipc-atomic.h"
+
+/*
+ * Protocol between the broker and its clients. Requests and replies are
+ * exchanged on a SOCK_SEQPACKET Unix socket; a claimed channel is then driven
+ * through descriptor rings in a memory area shared by the broker and the
+ * client, while payloads stay in the driver shared memory mapped by both.
+ */
+
+/* descriptors per ring, a power of 2 */
+#define IPC_BROKER_RING_LEN 64u
+/* Tx buffers acquired in advance per pool of a claimed channel */
+#define IPC_BROKER_TX_BUFS 4u
+/* Tx buffer slots of a claimed channel */
+#define IPC_BROKER_TX_SLOTS (IPC_SHM_MAX_POOLS * IPC_BROKER_TX_BUFS)
+/* Rx buffer slots of a claimed channel, at most one per Rx descriptor */
+#define IPC_BROKER_RX_SLOTS IPC_BROKER_RING_LEN
+
+/* request operations */
+enum ipc_broker_op {
+	IPC_BROKER_CLAIM = 1,
+};
+
+/* file descriptors passed with a claim reply, in order */
+enum ipc_broker_fd {
+	IPC_BROKER_FD_AREA,
+	IPC_BROKER_FD_LOCAL_SHM,
+	IPC_BROKER_FD_REMOTE_SHM,
+	IPC_BROKER_FD_RX,
+	IPC_BROKER_FD_KICK,
+	IPC_BROKER_NUM_FDS,
+};
+
+/**
+ * struct ipc_broker_req - client request
+ * @op:		IPC_BROKER_CLAIM
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ */
+struct ipc_broker_req {
+	uint32_t op;
+	uint32_t instance;
+	int32_t chan_id;
+};
+
+/**
+ * struct ipc_broker_resp - broker reply, with file descriptors on success
+ * @err:		0 on success, error code otherwise
+ * @shm_size:		local/remote ShM size
+ * @local_off:		local ShM offset in its file
+ * @remote_off:		remote ShM offset in its file
+ * @num_pools:		number of buffer pools of the channel
+ * @buf_size:		buffer size of each pool, in increasing order
+ */
+struct ipc_broker_resp {
+	int32_t err;
+	uint32_t shm_size;
+	uint64_t local_off;
+	uint64_t remote_off;
+	uint32_t num_pools;
+	uint32_t buf_size[IPC_SHM_MAX_POOLS];
+};
+
+/**
+ * struct ipc_broker_desc - buffer descriptor
+ * @slot:	buffer slot in the broker, checked on return
+ * @pool:	pool the buffer was acquired for (Tx only)
+ * @off:	buffer offset in local (Tx) or remote (Rx) ShM
+ * @size:	message size or, for free Tx buffers, buffer size
+ */
+struct ipc_broker_desc {
+	uint16_t slot;
+	uint16_t pool;
+	uint32_t off;
+	uint32_t size;
+	uint32_t reserved;
+};
+
+/**
+ * struct ipc_broker_ring - single producer single consumer descriptor ring
+ * @head:	next descriptor to consume, written by consumer
+ * @tail:	next descriptor to produce, written by producer
+ * @desc:	descriptors
+ */
+struct ipc_broker_ring {
+	uint32_t head __attribute__((aligned(64)));
+	uint32_t tail __attribute__((aligned(64)));
+	struct ipc_broker_desc desc[IPC_BROKER_RING_LEN]
+		__attribute__((aligned(64)));
+};
+
+/**
+ * struct ipc_broker_area - rings of a claimed channel
+ * @rx:		received buffers, broker to client
+ * @release:	received buffers released, client to broker
+ * @tx:		buffers to send, client to broker
+ * @free:	Tx buffers acquired per pool, broker to client
+ * @rx_dropped:	messages released by the broker for lack of Rx slot
+ */
+struct ipc_broker_area {
+	struct ipc_broker_ring rx;
+	struct ipc_broker_ring release;
+	struct ipc_broker_ring tx;
+	struct ipc_broker_ring free[IPC_SHM_MAX_POOLS];
+	uint64_t rx_dropped;
+};
+
+static inline uint32_t ipc_broker_ring_count(struct ipc_broker_ring *ring)
+{
+	return smp_load_acquire(&ring->tail) - smp_load_acquire(&ring->head);
+}
+
+/**
+ * ipc_broker_push() - produce a descriptor
+ * @ring:	ring
+ * @desc:	descriptor
+ * @was_empty:	set if the consumer had consumed all previous descriptors and
+ *		must be woken up
+ *
+ * Return: true on success, false if the ring is full
+ */
+static inline bool ipc_broker_push(struct ipc_broker_ring *ring,
+		const struct ipc_broker_desc *desc, bool *was_empty)
+{
+	uint32_t tail = READ_ONCE(ring->tail);
+
+	/* the consumer is done with the slot once it moved head past it */
+	if (tail - smp_load_acquire(&ring->head) >= IPC_BROKER_RING_LEN)
+		return false;
+
+	ring->desc[tail % IPC_BROKER_RING_LEN] = *desc;
+	smp_store_release(&ring->tail, tail + 1u);
+
+	/* pairs with the barrier of a consumer finding the ring empty */
+	smp_mb();
+	*was_empty = (READ_ONCE(ring->head) == tail);
+
+	return true;
+}
+
+/**
+ * ipc_broker_pop() - consume a descriptor
+ * @ring:	ring
+ * @desc:	descriptor
+ *
+ * Return: true on success, false if the ring is empty or corrupted
+ */
+static inline bool ipc_broker_pop(struct ipc_broker_ring *ring,
+		struct ipc_broker_desc *desc)
+{
+	uint32_t head = READ_ONCE(ring->head);
+	uint32_t tail = smp_load_acquire(&ring->tail);
+
+	if (head == tail) {
+		/*
+		 * the consumer goes to sleep on an empty ring: the producer
+		 * either sees the last head published or the tail load here
+		 * sees its descriptor
+		 */
+		smp_mb();
+		tail = smp_load_acquire(&ring->tail);
+	}
+
+	if (head == tail || tail - head > IPC_BROKER_RING_LEN)
+		return false;
+
+	*desc = ring->desc[head % IPC_BROKER_RING_LEN];
+	smp_store_release(&ring->head, head + 1u);
+
+	return true;
+}
+
+#endif /* IPC_BROKER_PROTO_H */
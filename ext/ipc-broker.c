@@ -0,0 +1,579 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-ext.h"
+#include "ipc-broker-proto.h"
+#include "ipc-broker.h"
+
+/* poll entries: stop event, listening socket, clients and claimed channels */
+#define IPC_BROKER_MAX_FDS (2u + IPC_BROKER_MAX_CLIENTS \
+			    + IPC_SHM_MAX_INSTANCES * IPC_SHM_MAX_CHANNELS)
+
+/**
+ * struct ipc_broker_chan - broker data of a managed channel
+ * @client:		index of the client that claimed the channel, or -1
+ * @instance:		instance id
+ * @chan_id:		channel index
+ * @area:		rings shared with the client
+ * @rx_fd:		eventfd signaled to the client on Rx
+ * @kick_fd:		eventfd signaled by the client on Tx and release
+ * @saved_rx:		Rx callback of the channel before it was claimed
+ * @lock:		lock protecting @client, @area and the Rx slots, taken
+ *			by the Rx thread
+ * @rx_free_len:	number of free Rx slots
+ * @rx_free:		free Rx slots
+ * @rx_buf:		received buffer of each Rx slot, NULL if free
+ * @tx_free_len:	number of free Tx slots
+ * @tx_free:		free Tx slots
+ * @tx_buf:		acquired buffer of each Tx slot, NULL if free
+ * @tx_size:		buffer size of each Tx slot
+ */
+struct ipc_broker_chan {
+	int client;
+	uint8_t instance;
+	int chan_id;
+	struct ipc_broker_area *area;
+	int rx_fd;
+	int kick_fd;
+	struct ipc_ext_rx saved_rx;
+	pthread_mutex_t lock;
+	uint32_t rx_free_len;
+	uint16_t rx_free[IPC_BROKER_RX_SLOTS];
+	void *rx_buf[IPC_BROKER_RX_SLOTS];
+	uint32_t tx_free_len;
+	uint16_t tx_free[IPC_BROKER_TX_SLOTS];
+	void *tx_buf[IPC_BROKER_TX_SLOTS];
+	uint32_t tx_size[IPC_BROKER_TX_SLOTS];
+};
+
+/**
+ * struct ipc_broker_priv - broker private data
+ * @running:	true while the broker thread runs
+ * @listen_fd:	listening socket
+ * @stop_fd:	eventfd signaled to stop the broker thread
+ * @thread:	broker thread, serving requests and claimed channels
+ * @path:	listening socket path
+ * @client_fd:	connected client sockets, -1 if unused
+ * @chan:	broker data per instance and channel
+ */
+static struct ipc_broker_priv {
+	bool running;
+	int listen_fd;
+	int stop_fd;
+	pthread_t thread;
+	char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+	int client_fd[IPC_BROKER_MAX_CLIENTS];
+	struct ipc_broker_chan
+		chan[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+} priv;
+
+static void ipc_broker_signal(int fd)
+{
+	const uint64_t one = 1u;
+
+	if (write(fd, &one, sizeof(one)) != sizeof(one)) {
+		shm_dbg("Can't signal eventfd %d\n", fd);
+	}
+}
+
+/* claimed channels Rx callback: hand received buffer to the client */
+static void ipc_broker_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size)
+{
+	struct ipc_broker_chan *bc = arg;
+	struct ipc_broker_desc desc = {0};
+	bool was_empty;
+
+	pthread_mutex_lock(&bc->lock);
+	if (bc->client < 0)
+		goto release;
+
+	if (!bc->rx_free_len) {
+		bc->area->rx_dropped++;
+		goto release;
+	}
+
+	desc.slot = bc->rx_free[bc->rx_free_len - 1u];
+	desc.off = (uint32_t)((uintptr_t)buf - ipc_os_get_remote_shm(instance));
+	desc.size = size;
+	if (!ipc_broker_push(&bc->area->rx, &desc, &was_empty)) {
+		bc->area->rx_dropped++;
+		goto release;
+	}
+	bc->rx_free_len--;
+	bc->rx_buf[desc.slot] = buf;
+
+	if (was_empty)
+		ipc_broker_signal(bc->rx_fd);
+	pthread_mutex_unlock(&bc->lock);
+
+	return;
+
+release:
+	pthread_mutex_unlock(&bc->lock);
+	ipc_shm_ext_release_buf(instance, chan_id, buf);
+}
+
+/* acquire Tx buffers in advance, up to IPC_BROKER_TX_BUFS per pool */
+static void ipc_broker_refill(struct ipc_broker_chan *bc)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(bc->instance, bc->chan_id);
+	uintptr_t base = ipc_os_get_local_shm(bc->instance);
+	size_t trailer = ipc_ext_trailer(bc->instance, bc->chan_id);
+	struct ipc_broker_desc desc = {0};
+	struct ipc_broker_ring *ring;
+	bool was_empty;
+	void *buf;
+	int i;
+
+	/* clients fill payloads, trailers of the channel excluded */
+	for (i = 0; i < chan->sc.num_pools; i++) {
+		ring = &bc->area->free[i];
+		while (bc->tx_free_len
+		       && ipc_broker_ring_count(ring) < IPC_BROKER_TX_BUFS) {
+			buf = ipc_shm_ext_acquire_buf(bc->instance, bc->chan_id,
+						      chan->sc.buf_size[i]
+						      - trailer);
+			if (!buf)
+				break;
+
+			desc.slot = bc->tx_free[--bc->tx_free_len];
+			desc.pool = i;
+			desc.off = (uint32_t)((uintptr_t)buf - base);
+			desc.size = chan->sc.buf_size[i] - trailer;
+			bc->tx_buf[desc.slot] = buf;
+			bc->tx_size[desc.slot] = desc.size;
+			ipc_broker_push(ring, &desc, &was_empty);
+		}
+	}
+}
+
+/* release and send the buffers handed back by the client */
+static void ipc_broker_kick(struct ipc_broker_chan *bc)
+{
+	struct ipc_broker_desc desc;
+	uint64_t count;
+	void *buf;
+
+	if (read(bc->kick_fd, &count, sizeof(count)) != sizeof(count)) {
+		shm_dbg_ch(bc->instance, bc->chan_id,
+			   "Spurious kick on channel %d\n", bc->chan_id);
+	}
+
+	while (ipc_broker_pop(&bc->area->release, &desc)) {
+		if (desc.slot >= IPC_BROKER_RX_SLOTS
+		    || !bc->rx_buf[desc.slot]) {
+			shm_err_ch(bc->instance, bc->chan_id,
+				   "Invalid release on channel %d\n",
+				   bc->chan_id);
+			continue;
+		}
+
+		ipc_shm_ext_release_buf(bc->instance, bc->chan_id,
+					bc->rx_buf[desc.slot]);
+		pthread_mutex_lock(&bc->lock);
+		bc->rx_buf[desc.slot] = NULL;
+		bc->rx_free[bc->rx_free_len++] = desc.slot;
+		pthread_mutex_unlock(&bc->lock);
+	}
+
+	/* a burst of messages rings the doorbell once */
+	ipc_os_notify_batch_begin();
+	while (ipc_broker_pop(&bc->area->tx, &desc)) {
+		if (desc.slot >= IPC_BROKER_TX_SLOTS || !bc->tx_buf[desc.slot]
+		    || desc.size > bc->tx_size[desc.slot]) {
+			shm_err_ch(bc->instance, bc->chan_id,
+				   "Invalid Tx on channel %d\n", bc->chan_id);
+			continue;
+		}
+
+		buf = bc->tx_buf[desc.slot];
+		bc->tx_buf[desc.slot] = NULL;
+		bc->tx_free[bc->tx_free_len++] = desc.slot;
+		if (ipc_shm_ext_tx(bc->instance, bc->chan_id, buf, desc.size))
+			ipc_shm_ext_discard_buf(bc->instance, bc->chan_id, buf,
+						bc->tx_size[desc.slot]);
+	}
+	ipc_os_notify_batch_end();
+
+	ipc_broker_refill(bc);
+}
+
+/* give channel back to the broker process, with the buffers of the client */
+static void ipc_broker_unclaim(struct ipc_broker_chan *bc)
+{
+	int i;
+
+	/* messages the client sent before leaving still go out */
+	ipc_broker_kick(bc);
+
+	ipc_shm_ext_unhold_rx(bc->instance, bc->chan_id, bc->saved_rx.cb,
+			      bc->saved_rx.arg);
+	pthread_mutex_lock(&bc->lock);
+	bc->client = -1;
+	pthread_mutex_unlock(&bc->lock);
+
+	for (i = 0; i < (int)IPC_BROKER_RX_SLOTS; i++) {
+		if (bc->rx_buf[i])
+			ipc_shm_ext_release_buf(bc->instance, bc->chan_id,
+						bc->rx_buf[i]);
+		bc->rx_buf[i] = NULL;
+	}
+
+	for (i = 0; i < (int)IPC_BROKER_TX_SLOTS; i++) {
+		if (bc->tx_buf[i])
+			ipc_shm_ext_discard_buf(bc->instance, bc->chan_id,
+						bc->tx_buf[i], bc->tx_size[i]);
+		bc->tx_buf[i] = NULL;
+	}
+
+	munmap(bc->area, sizeof(*bc->area));
+	bc->area = NULL;
+	close(bc->kick_fd);
+	close(bc->rx_fd);
+}
+
+static int ipc_broker_send_resp(int sock, const struct ipc_broker_resp *resp,
+		const int *fds)
+{
+	char control[CMSG_SPACE(IPC_BROKER_NUM_FDS * sizeof(int))] = {0};
+	struct iovec iov = {
+		.iov_base = (void *)resp,
+		.iov_len = sizeof(*resp),
+	};
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+	};
+	struct cmsghdr *cmsg;
+
+	if (fds) {
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+		cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(IPC_BROKER_NUM_FDS * sizeof(int));
+		memcpy(CMSG_DATA(cmsg), fds, IPC_BROKER_NUM_FDS * sizeof(int));
+	}
+
+	if (sendmsg(sock, &msg, MSG_NOSIGNAL) != sizeof(*resp))
+		return -errno;
+
+	return 0;
+}
+
+static int ipc_broker_claim(int client, const struct ipc_broker_req *req)
+{
+	struct ipc_broker_resp resp = {0};
+	struct ipc_broker_chan *bc;
+	struct ipc_ext_chan *chan;
+	int fds[IPC_BROKER_NUM_FDS];
+	off_t off;
+	int i, err;
+
+	chan = req->instance < IPC_SHM_MAX_INSTANCES
+	       ? ipc_ext_get_chan(req->instance, req->chan_id) : NULL;
+	if (!chan || !chan->managed) {
+		err = -EINVAL;
+		goto err_resp;
+	}
+
+	/*
+	 * clients get buffer offsets, not copies, and the channel may be held
+	 * by another client or a local layer; buffers received until the
+	 * client is set are released
+	 */
+	bc = &priv.chan[req->instance][req->chan_id];
+	err = ipc_shm_ext_hold_rx(req->instance, req->chan_id,
+				  ipc_broker_rx_cb, bc, &bc->saved_rx.cb,
+				  &bc->saved_rx.arg);
+	if (err)
+		goto err_resp;
+
+	fds[IPC_BROKER_FD_AREA] = memfd_create("ipc-shm-broker", MFD_CLOEXEC);
+	if (fds[IPC_BROKER_FD_AREA] < 0) {
+		err = -errno;
+		goto err_unhold;
+	}
+
+	if (ftruncate(fds[IPC_BROKER_FD_AREA], sizeof(*bc->area))) {
+		err = -errno;
+		goto err_close_area;
+	}
+
+	bc->area = mmap(NULL, sizeof(*bc->area), PROT_READ | PROT_WRITE,
+			MAP_SHARED, fds[IPC_BROKER_FD_AREA], 0);
+	if (bc->area == MAP_FAILED) {
+		err = -errno;
+		goto err_close_area;
+	}
+
+	bc->rx_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (bc->rx_fd < 0) {
+		err = -errno;
+		goto err_unmap_area;
+	}
+
+	bc->kick_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (bc->kick_fd < 0) {
+		err = -errno;
+		goto err_close_rx_fd;
+	}
+
+	bc->instance = req->instance;
+	bc->chan_id = req->chan_id;
+	bc->rx_free_len = IPC_BROKER_RX_SLOTS;
+	for (i = 0; i < (int)IPC_BROKER_RX_SLOTS; i++)
+		bc->rx_free[i] = i;
+	bc->tx_free_len = IPC_BROKER_TX_SLOTS;
+	for (i = 0; i < (int)IPC_BROKER_TX_SLOTS; i++)
+		bc->tx_free[i] = i;
+
+	resp.shm_size = ipc_ext_get_cfg(bc->instance)->shm_size;
+	resp.num_pools = chan->sc.num_pools;
+	memcpy(resp.buf_size, chan->sc.buf_size, sizeof(resp.buf_size));
+	fds[IPC_BROKER_FD_LOCAL_SHM] = ipc_os_get_shm_fd(bc->instance, false,
+							 &off);
+	resp.local_off = off;
+	fds[IPC_BROKER_FD_REMOTE_SHM] = ipc_os_get_shm_fd(bc->instance, true,
+							  &off);
+	resp.remote_off = off;
+	fds[IPC_BROKER_FD_RX] = bc->rx_fd;
+	fds[IPC_BROKER_FD_KICK] = bc->kick_fd;
+
+	pthread_mutex_lock(&bc->lock);
+	bc->client = client;
+	pthread_mutex_unlock(&bc->lock);
+	ipc_broker_refill(bc);
+
+	err = ipc_broker_send_resp(priv.client_fd[client], &resp, fds);
+	close(fds[IPC_BROKER_FD_AREA]);
+	if (err)
+		ipc_broker_unclaim(bc);
+
+	return err;
+
+err_close_rx_fd:
+	close(bc->rx_fd);
+err_unmap_area:
+	munmap(bc->area, sizeof(*bc->area));
+	bc->area = NULL;
+err_close_area:
+	close(fds[IPC_BROKER_FD_AREA]);
+err_unhold:
+	ipc_shm_ext_unhold_rx(req->instance, req->chan_id, bc->saved_rx.cb,
+			      bc->saved_rx.arg);
+err_resp:
+	resp.err = err;
+	return ipc_broker_send_resp(priv.client_fd[client], &resp, NULL);
+}
+
+static void ipc_broker_disconnect(int client)
+{
+	struct ipc_broker_chan *bc;
+	uint32_t i, j;
+
+	for (i = 0; i < IPC_SHM_MAX_INSTANCES; i++) {
+		for (j = 0; j < IPC_SHM_MAX_CHANNELS; j++) {
+			bc = &priv.chan[i][j];
+			if (bc->client == client)
+				ipc_broker_unclaim(bc);
+		}
+	}
+
+	close(priv.client_fd[client]);
+	priv.client_fd[client] = -1;
+}
+
+static void ipc_broker_request(int client)
+{
+	struct ipc_broker_req req;
+	struct ipc_broker_resp resp = {0};
+	ssize_t len;
+	int err;
+
+	len = recv(priv.client_fd[client], &req, sizeof(req), 0);
+	if (len <= 0) {
+		ipc_broker_disconnect(client);
+		return;
+	}
+
+	if (len == sizeof(req) && req.op == IPC_BROKER_CLAIM) {
+		err = ipc_broker_claim(client, &req);
+	} else {
+		resp.err = -EINVAL;
+		err = ipc_broker_send_resp(priv.client_fd[client], &resp, NULL);
+	}
+
+	if (err)
+		ipc_broker_disconnect(client);
+}
+
+static void ipc_broker_accept(void)
+{
+	int fd, i;
+
+	fd = accept4(priv.listen_fd, NULL, NULL, SOCK_CLOEXEC);
+	if (fd < 0)
+		return;
+
+	for (i = 0; i < (int)IPC_BROKER_MAX_CLIENTS; i++) {
+		if (priv.client_fd[i] < 0) {
+			priv.client_fd[i] = fd;
+			return;
+		}
+	}
+
+	shm_err("Too many clients\n");
+	close(fd);
+}
+
+/* broker thread: serve requests and kicks of claimed channels */
+static void *ipc_broker_thread(void *arg)
+{
+	struct pollfd fds[IPC_BROKER_MAX_FDS];
+	struct ipc_broker_chan *chans[IPC_BROKER_MAX_FDS];
+	int clients[IPC_BROKER_MAX_FDS];
+	struct ipc_broker_chan *bc;
+	uint32_t i, j, n;
+
+	while (1) {
+		fds[0].fd = priv.stop_fd;
+		fds[1].fd = priv.listen_fd;
+		n = 2;
+		for (i = 0; i < IPC_BROKER_MAX_CLIENTS; i++) {
+			if (priv.client_fd[i] < 0)
+				continue;
+			fds[n].fd = priv.client_fd[i];
+			clients[n] = i;
+			chans[n++] = NULL;
+		}
+		for (i = 0; i < IPC_SHM_MAX_INSTANCES; i++) {
+			for (j = 0; j < IPC_SHM_MAX_CHANNELS; j++) {
+				bc = &priv.chan[i][j];
+				if (bc->client < 0)
+					continue;
+				fds[n].fd = bc->kick_fd;
+				chans[n++] = bc;
+			}
+		}
+		for (i = 0; i < n; i++)
+			fds[i].events = POLLIN;
+
+		if (poll(fds, n, -1) < 0)
+			continue;
+
+		if (fds[0].revents)
+			break;
+		if (fds[1].revents)
+			ipc_broker_accept();
+
+		/* channels first, a request may unclaim them */
+		for (i = n; i-- > 2; ) {
+			if (!fds[i].revents)
+				continue;
+			if (chans[i])
+				ipc_broker_kick(chans[i]);
+			else
+				ipc_broker_request(clients[i]);
+		}
+	}
+
+	return NULL;
+}
+
+int ipc_shm_broker_start(const char *path)
+{
+	struct sockaddr_un addr = {
+		.sun_family = AF_UNIX,
+	};
+	uint32_t i, j;
+	int err;
+
+	if (priv.running || !path || !ipc_ext_num_instances()
+	    || strlen(path) >= sizeof(addr.sun_path))
+		return -EINVAL;
+
+	strcpy(addr.sun_path, path);
+	strcpy(priv.path, path);
+
+	for (i = 0; i < IPC_BROKER_MAX_CLIENTS; i++)
+		priv.client_fd[i] = -1;
+	for (i = 0; i < IPC_SHM_MAX_INSTANCES; i++) {
+		for (j = 0; j < IPC_SHM_MAX_CHANNELS; j++) {
+			priv.chan[i][j].client = -1;
+			pthread_mutex_init(&priv.chan[i][j].lock, NULL);
+		}
+	}
+
+	priv.listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (priv.listen_fd < 0)
+		return -errno;
+
+	unlink(path);
+	if (bind(priv.listen_fd, (struct sockaddr *)&addr, sizeof(addr))
+	    || listen(priv.listen_fd, IPC_BROKER_MAX_CLIENTS)) {
+		shm_err("Can't listen on %s\n", path);
+		err = -errno;
+		goto err_close_listen;
+	}
+
+	priv.stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (priv.stop_fd < 0) {
+		err = -errno;
+		goto err_unlink;
+	}
+
+	err = pthread_create(&priv.thread, NULL, ipc_broker_thread, NULL);
+	if (err) {
+		shm_err("Can't start broker thread\n");
+		err = -err;
+		goto err_close_stop;
+	}
+	priv.running = true;
+
+	return 0;
+
+err_close_stop:
+	close(priv.stop_fd);
+err_unlink:
+	unlink(path);
+err_close_listen:
+	close(priv.listen_fd);
+	return err;
+}
+
+void ipc_shm_broker_stop(void)
+{
+	uint32_t i;
+
+	if (!priv.running)
+		return;
+
+	ipc_broker_signal(priv.stop_fd);
+	pthread_join(priv.thread, NULL);
+
+	for (i = 0; i < IPC_BROKER_MAX_CLIENTS; i++)
+		if (priv.client_fd[i] >= 0)
+			ipc_broker_disconnect(i);
+
+	close(priv.stop_fd);
+	close(priv.listen_fd);
+	unlink(priv.path);
+	priv.running = false;
+}
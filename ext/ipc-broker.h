@@ -0,0 +1,137 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_BROKER_H
+#define IPC_BROKER_H
+
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+
+/* client connections served by the broker */
+#define IPC_BROKER_MAX_CLIENTS 16u
+
+/**
+ * ipc_shm_broker_start() - share initialized instances with other processes
+ * @path:	Unix socket path clients connect to
+ *
+ * Only one process can initialize the driver. Once it has, with
+ * ipc_shm_ext_init(), the broker lets client processes claim managed
+ * channels: each claimed channel is driven by its client alone, from
+ * buffers it maps itself, until the client disconnects. The broker keeps
+ * driving the descriptors the client hands over, so payloads are never
+ * copied. Messages of unclaimed channels reach the Rx callbacks of the
+ * broker process as usual.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_broker_start(const char *path);
+
+/**
+ * ipc_shm_broker_stop() - disconnect clients and stop the broker
+ */
+void ipc_shm_broker_stop(void);
+
+/**
+ * ipc_shm_client_open() - connect to a broker
+ * @path:	Unix socket path of the broker
+ *
+ * The client API is used instead of the driver API in processes that don't
+ * own the instances. Each claimed channel must be driven by a single thread
+ * at a time.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_client_open(const char *path);
+
+/**
+ * ipc_shm_client_close() - release claimed channels and disconnect
+ *
+ * Buffers received and not released and Tx buffers acquired and not sent are
+ * given back by the broker.
+ */
+void ipc_shm_client_close(void);
+
+/**
+ * ipc_shm_client_claim() - take ownership of a managed channel
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ *
+ * The broker holds the channel Rx callback (see ipc_shm_ext_hold_rx()) while
+ * it is claimed, as clients get the received buffers in shared memory, so
+ * channels in Rx copy-out mode or compressed (see ipc_shm_compress_enable())
+ * can't be claimed, nor channels subscribed in the broker process.
+ *
+ * Return: 0 on success, -EBUSY if claimed by another client or otherwise held
+ *	   in the broker process, error code otherwise
+ */
+int ipc_shm_client_claim(const uint8_t instance, int chan_id);
+
+/**
+ * ipc_shm_client_get_fd() - get Rx notification file of a claimed channel
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ *
+ * The returned eventfd becomes readable when messages are received; the
+ * client then calls ipc_shm_client_poll(), e.g. from its own event loop.
+ *
+ * Return: file descriptor, error code otherwise
+ */
+int ipc_shm_client_get_fd(const uint8_t instance, int chan_id);
+
+/**
+ * ipc_shm_client_poll() - pass received messages to a callback
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ * @rx_cb:	called for each message, with the buffer in shared memory
+ * @cb_arg:	callback argument
+ *
+ * Each buffer is owned by the client until given to
+ * ipc_shm_client_release_buf().
+ *
+ * Return: number of messages, error code otherwise
+ */
+int ipc_shm_client_poll(const uint8_t instance, int chan_id,
+		ipc_shm_rx_cb rx_cb, void *cb_arg);
+
+/**
+ * ipc_shm_client_acquire_buf() - request a buffer for a claimed channel
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ * @size:	required size
+ *
+ * Takes a buffer acquired in advance by the broker from the first pool that
+ * fits @size. When none is left, the broker is asked to acquire more and
+ * NULL is returned; the caller retries later.
+ *
+ * Return: pointer to the buffer base address or NULL if buffer not found
+ */
+void *ipc_shm_client_acquire_buf(const uint8_t instance, int chan_id,
+		size_t size);
+
+/**
+ * ipc_shm_client_tx() - send data on a claimed channel
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ * @buf:	buffer from ipc_shm_client_acquire_buf()
+ * @size:	size of data written in buffer
+ *
+ * The buffer is handed to the broker, which sends it.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_client_tx(const uint8_t instance, int chan_id, void *buf,
+		size_t size);
+
+/**
+ * ipc_shm_client_release_buf() - release a received buffer
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ * @buf:	buffer passed to the callback of ipc_shm_client_poll()
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_client_release_buf(const uint8_t instance, int chan_id,
+		const void *buf);
+
+#endif /* IPC_BROKER_H */
@@ -0,0 +1,215 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-io.h"
+#include "ipc-capture.h"
+
+/**
+ * struct ipc_capture_priv - capture private data
+ * @enabled:		true while capturing
+ * @writers:		records being written
+ * @fd:			capture file descriptor
+ * @map:		capture file mapping
+ * @map_size:		capture file size
+ * @tail:		offset of the next record, may exceed @map_size
+ * @dropped:		records dropped because the file was full
+ * @payload_max:	message payload bytes recorded
+ */
+static struct ipc_capture_priv {
+	bool enabled;
+	uint32_t writers;
+	int fd;
+	char *map;
+	size_t map_size;
+	uint64_t tail;
+	uint64_t dropped;
+	size_t payload_max;
+} priv;
+
+static uint64_t ipc_capture_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static size_t ipc_capture_align(size_t n)
+{
+	return (n + 7u) & ~(size_t)7u;
+}
+
+int ipc_shm_capture_start(const char *path, size_t max_size,
+		size_t payload_max)
+{
+	struct ipc_capture_hdr *hdr;
+	int err;
+
+	if (!path || priv.map || max_size < sizeof(*hdr))
+		return -EINVAL;
+
+	priv.fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (priv.fd < 0) {
+		shm_err("Can't open %s\n", path);
+		return -errno;
+	}
+
+	max_size = ipc_capture_align(max_size);
+	if (ftruncate(priv.fd, max_size)) {
+		err = -errno;
+		goto err_close;
+	}
+
+	priv.map = mmap(NULL, max_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			priv.fd, 0);
+	if (priv.map == MAP_FAILED) {
+		err = -errno;
+		priv.map = NULL;
+		goto err_close;
+	}
+
+	hdr = (struct ipc_capture_hdr *)priv.map;
+	hdr->magic = IPC_CAPTURE_MAGIC;
+	hdr->version = IPC_CAPTURE_FORMAT_VERSION;
+	hdr->hdr_size = sizeof(*hdr);
+	hdr->start_ns = ipc_capture_now();
+
+	priv.map_size = max_size;
+	priv.tail = sizeof(*hdr);
+	priv.dropped = 0;
+	priv.payload_max = payload_max;
+	__atomic_store_n(&priv.enabled, true, __ATOMIC_RELEASE);
+
+	return 0;
+
+err_close:
+	shm_err("Can't map %s\n", path);
+	close(priv.fd);
+	return err;
+}
+
+int ipc_shm_capture_stop(void)
+{
+	struct ipc_capture_hdr *hdr;
+	uint64_t data_end;
+	int err = 0;
+
+	if (!priv.map)
+		return -EINVAL;
+
+	/* let records being written complete before unmapping */
+	__atomic_store_n(&priv.enabled, false, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&priv.writers, __ATOMIC_SEQ_CST))
+		sched_yield();
+
+	data_end = priv.tail < priv.map_size ? priv.tail : priv.map_size;
+	hdr = (struct ipc_capture_hdr *)priv.map;
+	hdr->data_size = data_end - sizeof(*hdr);
+	hdr->dropped = priv.dropped;
+
+	if (msync(priv.map, priv.map_size, MS_SYNC))
+		err = -errno;
+	munmap(priv.map, priv.map_size);
+	priv.map = NULL;
+
+	if (ftruncate(priv.fd, data_end) && !err)
+		err = -errno;
+	if (close(priv.fd) && !err)
+		err = -errno;
+
+	if (priv.dropped)
+		shm_err("%llu records dropped, capture file full\n",
+			(unsigned long long)priv.dropped);
+
+	return err;
+}
+
+struct ipc_capture_rec *ipc_capture_recv(enum ipc_capture_dir dir,
+		const uint8_t instance, int chan_id, const struct iovec *iov,
+		int iovcnt)
+{
+	struct ipc_capture_rec *rec;
+	size_t size = 0, payload_len, rec_len, off = 0, len;
+	uint64_t tail;
+	int i;
+
+	if (!__atomic_load_n(&priv.enabled, __ATOMIC_ACQUIRE))
+		return NULL;
+
+	/* checking enabled again orders the count with capture stop */
+	__atomic_fetch_add(&priv.writers, 1u, __ATOMIC_SEQ_CST);
+	if (!__atomic_load_n(&priv.enabled, __ATOMIC_SEQ_CST))
+		goto out;
+
+	for (i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+
+	payload_len = size < priv.payload_max ? size : priv.payload_max;
+	rec_len = ipc_capture_align(sizeof(*rec) + payload_len);
+
+	tail = __atomic_fetch_add(&priv.tail, rec_len, __ATOMIC_RELAXED);
+	if (tail + rec_len > priv.map_size) {
+		__atomic_fetch_add(&priv.dropped, 1u, __ATOMIC_RELAXED);
+		goto out;
+	}
+
+	rec = (struct ipc_capture_rec *)(priv.map + tail);
+	rec->dir = dir;
+	rec->instance = instance;
+	rec->chan_id = chan_id;
+	rec->ts_ns = ipc_capture_now();
+	rec->size = size;
+	rec->payload_len = payload_len;
+	for (i = 0; i < iovcnt && off < payload_len; i++) {
+		len = iov[i].iov_len;
+		if (len > payload_len - off)
+			len = payload_len - off;
+		ipc_copy_fromio((char *)(rec + 1) + off, iov[i].iov_base,
+				len);
+		off += len;
+	}
+
+	/* rec_len is still 0 from the file truncation, set on commit */
+	return rec;
+
+out:
+	__atomic_fetch_sub(&priv.writers, 1u, __ATOMIC_SEQ_CST);
+	return NULL;
+}
+
+struct ipc_capture_rec *ipc_capture_rec(enum ipc_capture_dir dir,
+		const uint8_t instance, int chan_id, const void *buf,
+		size_t size)
+{
+	struct iovec iov = {
+		.iov_base = (void *)buf,
+		.iov_len = size,
+	};
+
+	return ipc_capture_recv(dir, instance, chan_id, &iov, 1);
+}
+
+void ipc_capture_commit(struct ipc_capture_rec *rec, bool valid)
+{
+	if (!rec)
+		return;
+
+	/* cancelled records keep their length so that readers skip them */
+	if (!valid)
+		rec->dir = 0;
+
+	__atomic_store_n(&rec->rec_len,
+			 ipc_capture_align(sizeof(*rec) + rec->payload_len),
+			 __ATOMIC_RELEASE);
+	__atomic_fetch_sub(&priv.writers, 1u, __ATOMIC_SEQ_CST);
+}
@@ -0,0 +1,99 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_CAPTURE_H
+#define IPC_CAPTURE_H
+
+#include <stdbool.h>
+#include <sys/uio.h>
+
+#include "ipc-shm.h"
+
+#define IPC_CAPTURE_MAGIC 0x50414349u /* "ICAP" */
+#define IPC_CAPTURE_FORMAT_VERSION 2u
+
+/* record direction */
+enum ipc_capture_dir {
+	IPC_CAPTURE_TX = 1,
+	IPC_CAPTURE_RX = 2,
+};
+
+/**
+ * struct ipc_capture_hdr - header at the start of a capture file
+ * @magic:	IPC_CAPTURE_MAGIC
+ * @version:	IPC_CAPTURE_FORMAT_VERSION
+ * @hdr_size:	size of this header, records follow it
+ * @data_size:	bytes of records, 0 until the capture is stopped
+ * @dropped:	records dropped because the file was full
+ * @start_ns:	CLOCK_MONOTONIC time of capture start in ns
+ */
+struct ipc_capture_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t hdr_size;
+	uint64_t data_size;
+	uint64_t dropped;
+	uint64_t start_ns;
+};
+
+/**
+ * struct ipc_capture_rec - message record
+ * @rec_len:	record length including payload, a multiple of 8 bytes;
+ *		0 for a record not completely written, which ends the records
+ * @dir:	IPC_CAPTURE_TX or IPC_CAPTURE_RX
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @ts_ns:	CLOCK_MONOTONIC time of the message in ns
+ * @size:	message size; for Tx, the payload size given by the application,
+ *		before compression and trailers
+ * @payload_len: bytes of the message payload following the record
+ *
+ * Tx records are written before the message is compressed or sealed and sent,
+ * and cancelled with a 0 @dir if sending fails, so that replaying them with
+ * the extended API rebuilds the same messages. Rx records hold the message as
+ * received, trailers included.
+ */
+struct ipc_capture_rec {
+	uint32_t rec_len;
+	uint8_t dir;
+	uint8_t instance;
+	uint16_t chan_id;
+	uint64_t ts_ns;
+	uint32_t size;
+	uint32_t payload_len;
+};
+
+/**
+ * ipc_shm_capture_start() - start recording messages to a file
+ * @path:	capture file path
+ * @max_size:	capture file size limit, later records are dropped
+ * @payload_max: message payload bytes recorded, 0 for sizes only
+ *
+ * Records the messages sent with ipc_shm_ext_tx() or ipc_shm_ext_tx_copyv()
+ * and the ones received on managed channels initialized with
+ * ipc_shm_ext_init(), appending them to a memory mapped file from any thread
+ * without locking. Forwarded messages are recorded once, when received.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_capture_start(const char *path, size_t max_size,
+		size_t payload_max);
+
+/**
+ * ipc_shm_capture_stop() - stop recording and complete the capture file
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_capture_stop(void);
+
+/* hooks called by the extended API */
+struct ipc_capture_rec *ipc_capture_rec(enum ipc_capture_dir dir,
+		const uint8_t instance, int chan_id, const void *buf,
+		size_t size);
+struct ipc_capture_rec *ipc_capture_recv(enum ipc_capture_dir dir,
+		const uint8_t instance, int chan_id, const struct iovec *iov,
+		int iovcnt);
+void ipc_capture_commit(struct ipc_capture_rec *rec, bool valid);
+
+#endif /* IPC_CAPTURE_H */
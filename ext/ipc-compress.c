@@ -0,0 +1,585 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-ext.h"
+#include "ipc-io.h"
+#include "ipc-compress.h"
+
+#define NSEC_PER_SEC		1000000000ull
+
+/* smaller payloads are sent raw, not worth the compression time */
+#define IPC_COMPRESS_MIN_SIZE	128u
+/* trailer flag of compressed payloads, next to the payload size */
+#define IPC_COMPRESS_FLAG	(1u << 31)
+
+/*
+ * LZ4 block format: sequences made of a token holding the literal length and
+ * the match length minus IPC_LZ_MIN_MATCH in its high and low nibbles, the
+ * literal length extension, the literals, a 2 byte little endian match offset
+ * and the match length extension. Extensions are runs of 255 ended by a
+ * smaller byte. The last sequence has literals only and covers at least the
+ * last IPC_LZ_LAST_LITERALS bytes; no match starts in the last IPC_LZ_MFLIMIT
+ * bytes.
+ */
+#define IPC_LZ_MIN_MATCH	4u
+#define IPC_LZ_LAST_LITERALS	5u
+#define IPC_LZ_MFLIMIT		12u
+#define IPC_LZ_MAX_OFFSET	65535u
+#define IPC_LZ_HASH_BITS	12u
+/* inputs skipped faster as matches are missed, every 2^skip bytes */
+#define IPC_LZ_SKIP_TRIGGER	6u
+
+/**
+ * struct ipc_compress_chan - compression private data per channel
+ * @stats:	statistics, updated atomically
+ */
+struct ipc_compress_chan {
+	struct ipc_shm_compress_stats stats;
+} __attribute__((aligned(IPC_EXT_CACHE_LINE)));
+
+/**
+ * struct ipc_compress_priv - compression private data
+ * @enabled:	compressed channels of each instance, one bit per channel
+ * @chan:	private data per instance and channel
+ */
+static struct ipc_compress_priv {
+	uint32_t enabled[IPC_SHM_MAX_INSTANCES];
+	struct ipc_compress_chan
+		chan[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+} priv;
+
+/**
+ * struct ipc_compress_scratch - cached buffer of a Tx thread
+ * @buf:	gathered payload followed by its compressed form
+ * @size:	buffer size
+ *
+ * Freed when the thread exits.
+ */
+static __thread struct ipc_compress_scratch {
+	void *buf;
+	size_t size;
+} scratch;
+
+static pthread_key_t scratch_key;
+static pthread_once_t scratch_once = PTHREAD_ONCE_INIT;
+
+static void ipc_compress_scratch_key_init(void)
+{
+	if (pthread_key_create(&scratch_key, free))
+		shm_err("can't free compression buffers on thread exit\n");
+}
+
+static void *ipc_compress_scratch(size_t size)
+{
+	void *buf;
+
+	if (size <= scratch.size)
+		return scratch.buf;
+
+	buf = malloc(size);
+	if (!buf)
+		return NULL;
+
+	pthread_once(&scratch_once, ipc_compress_scratch_key_init);
+	pthread_setspecific(scratch_key, buf);
+	free(scratch.buf);
+	scratch.buf = buf;
+	scratch.size = size;
+
+	return buf;
+}
+
+static uint64_t ipc_compress_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+static uint32_t ipc_lz_read32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+
+	return v;
+}
+
+static uint32_t ipc_lz_hash(uint32_t v)
+{
+	return (v * 2654435761u) >> (32u - IPC_LZ_HASH_BITS);
+}
+
+/* write a length extension, NULL if it doesn't fit */
+static uint8_t *ipc_lz_put_len(uint8_t *op, const uint8_t *oend, size_t len)
+{
+	for (; len >= 255u; len -= 255u) {
+		if (op >= oend)
+			return NULL;
+		*op++ = 255u;
+	}
+	if (op >= oend)
+		return NULL;
+	*op++ = (uint8_t)len;
+
+	return op;
+}
+
+/* write a sequence, NULL if it doesn't fit */
+static uint8_t *ipc_lz_put_seq(uint8_t *op, const uint8_t *oend,
+		const uint8_t *lit, size_t lit_len, size_t off,
+		size_t match_len)
+{
+	uint8_t *token = op++;
+
+	if (op > oend)
+		return NULL;
+
+	*token = (uint8_t)((lit_len < 15u ? lit_len : 15u) << 4);
+	if (lit_len >= 15u) {
+		op = ipc_lz_put_len(op, oend, lit_len - 15u);
+		if (!op)
+			return NULL;
+	}
+
+	if (lit_len > (size_t)(oend - op))
+		return NULL;
+	memcpy(op, lit, lit_len);
+	op += lit_len;
+
+	/* the last sequence has no match */
+	if (!off)
+		return op;
+
+	if (oend - op < 2)
+		return NULL;
+	*op++ = (uint8_t)off;
+	*op++ = (uint8_t)(off >> 8);
+
+	match_len -= IPC_LZ_MIN_MATCH;
+	*token |= (uint8_t)(match_len < 15u ? match_len : 15u);
+	if (match_len >= 15u)
+		op = ipc_lz_put_len(op, oend, match_len - 15u);
+
+	return op;
+}
+
+/**
+ * ipc_lz_compress() - compress to LZ4 block format
+ * @src:	data to compress
+ * @len:	data size
+ * @dst:	compressed data
+ * @cap:	compressed data capacity
+ *
+ * Return: compressed size, 0 if it exceeds @cap
+ */
+static size_t ipc_lz_compress(const void *src, size_t len, void *dst,
+		size_t cap)
+{
+	uint32_t table[1u << IPC_LZ_HASH_BITS] = {0};
+	const uint8_t *base = src, *ip = base, *anchor = base, *ref;
+	const uint8_t *iend = base + len, *mflimit = iend - IPC_LZ_MFLIMIT;
+	uint8_t *op = dst, *oend = op + cap;
+	size_t match_len;
+	uint32_t h, misses = 0;
+
+	if (len <= IPC_LZ_MFLIMIT)
+		goto last;
+
+	for (ip++; ip < mflimit;) {
+		h = ipc_lz_hash(ipc_lz_read32(ip));
+		ref = base + table[h];
+		table[h] = (uint32_t)(ip - base);
+
+		if (ip - ref > IPC_LZ_MAX_OFFSET ||
+		    ipc_lz_read32(ref) != ipc_lz_read32(ip)) {
+			ip += 1u + (misses++ >> IPC_LZ_SKIP_TRIGGER);
+			continue;
+		}
+		misses = 0;
+
+		/* extend the match backwards over pending literals */
+		while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+			ip--;
+			ref--;
+		}
+
+		match_len = IPC_LZ_MIN_MATCH;
+		while (ip + match_len < iend - IPC_LZ_LAST_LITERALS &&
+		       ip[match_len] == ref[match_len])
+			match_len++;
+
+		op = ipc_lz_put_seq(op, oend, anchor, ip - anchor, ip - ref,
+				    match_len);
+		if (!op)
+			return 0;
+
+		ip += match_len;
+		anchor = ip;
+	}
+
+last:
+	op = ipc_lz_put_seq(op, oend, anchor, iend - anchor, 0, 0);
+	if (!op)
+		return 0;
+
+	return op - (uint8_t *)dst;
+}
+
+/* read a length extension, false past the end of input */
+static bool ipc_lz_get_len(const uint8_t **ip, const uint8_t *iend,
+		size_t *len)
+{
+	uint8_t b;
+
+	do {
+		if (*ip >= iend)
+			return false;
+		b = *(*ip)++;
+		*len += b;
+	} while (b == 255u);
+
+	return true;
+}
+
+/**
+ * ipc_lz_decompress() - decompress LZ4 block format
+ * @src:	compressed data
+ * @len:	compressed data size
+ * @dst:	decompressed data
+ * @size:	expected decompressed size
+ *
+ * Return: 0 if exactly @size bytes were decompressed, -EINVAL otherwise
+ */
+static int ipc_lz_decompress(const void *src, size_t len, void *dst,
+		size_t size)
+{
+	const uint8_t *ip = src, *iend = ip + len, *ref;
+	uint8_t *op = dst, *oend = op + size;
+	size_t lit_len, match_len, off, i;
+	uint8_t token;
+
+	while (ip < iend) {
+		token = *ip++;
+
+		lit_len = token >> 4;
+		if (lit_len == 15u && !ipc_lz_get_len(&ip, iend, &lit_len))
+			return -EINVAL;
+		if (lit_len > (size_t)(iend - ip) ||
+		    lit_len > (size_t)(oend - op))
+			return -EINVAL;
+		memcpy(op, ip, lit_len);
+		op += lit_len;
+		ip += lit_len;
+
+		if (ip == iend)
+			break;
+
+		if (iend - ip < 2)
+			return -EINVAL;
+		off = ip[0] | (size_t)ip[1] << 8;
+		ip += 2;
+		if (!off || off > (size_t)(op - (uint8_t *)dst))
+			return -EINVAL;
+
+		match_len = token & 15u;
+		if (match_len == 15u && !ipc_lz_get_len(&ip, iend, &match_len))
+			return -EINVAL;
+		match_len += IPC_LZ_MIN_MATCH;
+		if (match_len > (size_t)(oend - op))
+			return -EINVAL;
+
+		/* overlapping matches repeat the last off bytes */
+		ref = op - off;
+		if (off >= match_len) {
+			memcpy(op, ref, match_len);
+		} else {
+			for (i = 0; i < match_len; i++)
+				op[i] = ref[i];
+		}
+		op += match_len;
+	}
+
+	return op == oend ? 0 : -EINVAL;
+}
+
+int ipc_shm_compress_enable(const uint8_t instance, int chan_id, bool enable)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+
+	if (!chan || !chan->managed)
+		return -EINVAL;
+
+	/* decompressed copies don't outlive the Rx callback */
+	pthread_mutex_lock(&chan->hold_lock);
+	if (enable && __atomic_load_n(&chan->rx_hold, __ATOMIC_ACQUIRE)) {
+		pthread_mutex_unlock(&chan->hold_lock);
+		return -EBUSY;
+	}
+
+	if (enable)
+		__atomic_fetch_or(&priv.enabled[instance], 1u << chan_id,
+				  __ATOMIC_RELAXED);
+	else
+		__atomic_fetch_and(&priv.enabled[instance], ~(1u << chan_id),
+				   __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&chan->hold_lock);
+	ipc_ext_update_trailer(instance, chan_id);
+
+	return 0;
+}
+
+int ipc_shm_compress_get_stats(const uint8_t instance, int chan_id,
+		struct ipc_shm_compress_stats *stats)
+{
+	if (!ipc_ext_get_chan(instance, chan_id) || !stats)
+		return -EINVAL;
+
+	*stats = priv.chan[instance][chan_id].stats;
+
+	return 0;
+}
+
+/**
+ * ipc_compress_trailer() - get compression trailer size of a channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ *
+ * Return: IPC_SHM_COMPRESS_TRAILER for compressed channels, 0 otherwise
+ */
+size_t ipc_compress_trailer(const uint8_t instance, int chan_id)
+{
+	if (instance >= IPC_SHM_MAX_INSTANCES || chan_id < 0
+	    || chan_id >= (int)IPC_SHM_MAX_CHANNELS)
+		return 0;
+
+	if (__atomic_load_n(&priv.enabled[instance], __ATOMIC_RELAXED)
+	    & (1u << chan_id))
+		return IPC_SHM_COMPRESS_TRAILER;
+
+	return 0;
+}
+
+static void ipc_compress_put_trailer(uint8_t *trailer, uint32_t hdr)
+{
+	uint32_t i;
+
+	for (i = 0; i < IPC_SHM_COMPRESS_TRAILER; i++)
+		trailer[i] = (uint8_t)(hdr >> (8u * i));
+}
+
+/**
+ * ipc_compress_seal() - append raw trailer to a payload filled in place
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	buffer in shared memory, with room for the trailer
+ * @size:	payload size
+ *
+ * Return: trailer size, 0 if the channel isn't compressed
+ */
+size_t ipc_compress_seal(const uint8_t instance, int chan_id, void *buf,
+		size_t size)
+{
+	uint8_t trailer[IPC_SHM_COMPRESS_TRAILER];
+	struct ipc_shm_compress_stats *stats;
+
+	if (!ipc_compress_trailer(instance, chan_id))
+		return 0;
+
+	ipc_compress_put_trailer(trailer, (uint32_t)size);
+	ipc_copy_toio((char *)buf + size, trailer, sizeof(trailer));
+
+	stats = &priv.chan[instance][chan_id].stats;
+	__atomic_fetch_add(&stats->tx_msgs, 1u, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->tx_bytes, size, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->tx_wire_bytes, size + sizeof(trailer),
+			   __ATOMIC_RELAXED);
+
+	return sizeof(trailer);
+}
+
+/**
+ * ipc_compress_tx() - send a payload on a compressed channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @iov:	payload segments, in order
+ * @iovcnt:	number of segments
+ *
+ * The payload is gathered and compressed in cached memory, then copied to
+ * shared memory with its trailer, raw if it didn't shrink.
+ *
+ * Return: 0 on success, -ENOMEM if no buffer is free, error code otherwise
+ */
+int ipc_compress_tx(const uint8_t instance, int chan_id,
+		const struct iovec *iov, int iovcnt)
+{
+	struct ipc_shm_compress_stats *stats;
+	uint8_t trailer[IPC_SHM_COMPRESS_TRAILER];
+	size_t size = 0, off = 0, zsize = 0;
+	struct iovec msg[2];
+	uint64_t start = 0;
+	uint8_t *buf = NULL;
+	uint32_t hdr;
+	int i, err;
+
+	for (i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+	if (size > IPC_SHM_COMPRESS_MAX_SIZE)
+		return -EINVAL;
+
+	msg[0] = iovcnt == 1 ? iov[0] : (struct iovec){ NULL, 0 };
+	if (!size || (iovcnt == 1 && size < IPC_COMPRESS_MIN_SIZE))
+		goto send;
+
+	/* gathered payload, if needed, then its compressed form */
+	buf = ipc_compress_scratch(2 * size);
+	if (!buf)
+		return -ENOMEM;
+
+	if (iovcnt != 1) {
+		for (i = 0; i < iovcnt; i++) {
+			memcpy(buf + off, iov[i].iov_base, iov[i].iov_len);
+			off += iov[i].iov_len;
+		}
+		msg[0].iov_base = buf;
+		msg[0].iov_len = size;
+	}
+
+	if (size >= IPC_COMPRESS_MIN_SIZE) {
+		start = ipc_compress_now();
+		zsize = ipc_lz_compress(msg[0].iov_base, size, buf + size,
+					size - 1u);
+		start = ipc_compress_now() - start;
+	}
+
+send:
+	hdr = (uint32_t)size;
+	if (zsize) {
+		msg[0].iov_base = buf + size;
+		msg[0].iov_len = zsize;
+		hdr |= IPC_COMPRESS_FLAG;
+	}
+	ipc_compress_put_trailer(trailer, hdr);
+	msg[1].iov_base = trailer;
+	msg[1].iov_len = sizeof(trailer);
+
+	err = ipc_ext_tx_copyv(instance, chan_id, msg, 2);
+	if (err)
+		return err;
+
+	stats = &priv.chan[instance][chan_id].stats;
+	__atomic_fetch_add(&stats->tx_msgs, 1u, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->tx_compressed, zsize ? 1u : 0u,
+			   __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->tx_bytes, size, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->tx_wire_bytes,
+			   msg[0].iov_len + sizeof(trailer), __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->tx_ns, start, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+/**
+ * ipc_compress_parse() - strip the trailer of a received message
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @msg:	received message, in cached memory
+ * @size:	received size, then size without trailer
+ * @orig:	payload size
+ *
+ * Return: 0 for raw payloads, 1 for compressed ones, -EINVAL if malformed
+ */
+int ipc_compress_parse(const uint8_t instance, int chan_id, const void *msg,
+		size_t *size, size_t *orig)
+{
+	struct ipc_shm_compress_stats *stats;
+	const uint8_t *trailer;
+	uint32_t hdr = 0, i;
+
+	stats = &priv.chan[instance][chan_id].stats;
+	if (*size < IPC_SHM_COMPRESS_TRAILER)
+		goto err;
+
+	__atomic_fetch_add(&stats->rx_msgs, 1u, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->rx_wire_bytes, *size, __ATOMIC_RELAXED);
+
+	*size -= IPC_SHM_COMPRESS_TRAILER;
+	trailer = (const uint8_t *)msg + *size;
+	for (i = 0; i < IPC_SHM_COMPRESS_TRAILER; i++)
+		hdr |= (uint32_t)trailer[i] << (8u * i);
+
+	*orig = hdr & ~IPC_COMPRESS_FLAG;
+	if (!(hdr & IPC_COMPRESS_FLAG)) {
+		if (*orig != *size)
+			goto err;
+		__atomic_fetch_add(&stats->rx_bytes, *size, __ATOMIC_RELAXED);
+		return 0;
+	}
+
+	if (*orig > IPC_SHM_COMPRESS_MAX_SIZE)
+		goto err;
+
+	return 1;
+
+err:
+	__atomic_fetch_add(&stats->rx_errors, 1u, __ATOMIC_RELAXED);
+	shm_dbg_ch(instance, chan_id,
+		   "Malformed compressed message on channel %d\n", chan_id);
+	return -EINVAL;
+}
+
+/**
+ * ipc_compress_rx() - decompress a received payload
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @in:		compressed payload, in cached memory
+ * @size:	compressed payload size
+ * @out:	decompressed payload
+ * @orig:	payload size
+ *
+ * Return: 0 on success, -EINVAL if corrupted
+ */
+int ipc_compress_rx(const uint8_t instance, int chan_id, const void *in,
+		size_t size, void *out, size_t orig)
+{
+	struct ipc_shm_compress_stats *stats;
+	uint64_t start;
+	int err;
+
+	stats = &priv.chan[instance][chan_id].stats;
+
+	start = ipc_compress_now();
+	err = ipc_lz_decompress(in, size, out, orig);
+	__atomic_fetch_add(&stats->rx_ns, ipc_compress_now() - start,
+			   __ATOMIC_RELAXED);
+
+	if (err) {
+		__atomic_fetch_add(&stats->rx_errors, 1u, __ATOMIC_RELAXED);
+		shm_dbg_ch(instance, chan_id,
+			   "Corrupted compressed message on channel %d\n",
+			   chan_id);
+		return err;
+	}
+
+	__atomic_fetch_add(&stats->rx_compressed, 1u, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->rx_bytes, orig, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+/* forget compressed channels and statistics of a previous initialization */
+void ipc_compress_reset(void)
+{
+	memset(&priv, 0, sizeof(priv));
+}
@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_COMPRESS_H
+#define IPC_COMPRESS_H
+
+#include <stdbool.h>
+#include <sys/uio.h>
+
+#include "ipc-shm.h"
+
+/* size of the trailer appended to messages of compressed channels */
+#define IPC_SHM_COMPRESS_TRAILER	4u
+/* largest payload of compressed channels */
+#define IPC_SHM_COMPRESS_MAX_SIZE	(1u << 20)
+
+/**
+ * struct ipc_shm_compress_stats - compression statistics of a channel
+ * @tx_msgs:		messages sent
+ * @tx_compressed:	messages sent compressed
+ * @tx_bytes:		payload bytes sent
+ * @tx_wire_bytes:	bytes written to shared memory, trailers included
+ * @tx_ns:		time spent compressing
+ * @rx_msgs:		messages received
+ * @rx_compressed:	messages received compressed
+ * @rx_bytes:		payload bytes received
+ * @rx_wire_bytes:	bytes read from shared memory, trailers included
+ * @rx_ns:		time spent decompressing
+ * @rx_errors:		messages dropped because they can't be decompressed
+ *
+ * The compression ratio of each direction is bytes / wire_bytes.
+ */
+struct ipc_shm_compress_stats {
+	uint64_t tx_msgs;
+	uint64_t tx_compressed;
+	uint64_t tx_bytes;
+	uint64_t tx_wire_bytes;
+	uint64_t tx_ns;
+	uint64_t rx_msgs;
+	uint64_t rx_compressed;
+	uint64_t rx_bytes;
+	uint64_t rx_wire_bytes;
+	uint64_t rx_ns;
+	uint64_t rx_errors;
+};
+
+/**
+ * ipc_shm_compress_enable() - set compression mode of a managed channel
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ * @enable:	true to compress messages of the channel
+ *
+ * Payloads sent with ipc_shm_ext_tx_copy() or ipc_shm_ext_tx_copyv() on a
+ * compressed channel are compressed in cached memory with an LZ4 block style
+ * codec, and the smaller result is written to a buffer of the first pool that
+ * fits it, so compressible payloads take fewer bytes of uncached shared memory
+ * and smaller buffers, and may exceed the largest pool. Payloads that don't
+ * shrink are sent raw. Buffers filled in place and sent with ipc_shm_ext_tx()
+ * are sent raw. Each message carries a trailer of IPC_SHM_COMPRESS_TRAILER
+ * bytes, accounted for when acquiring buffers.
+ *
+ * Received messages are copied out to cached memory, decompressed if needed
+ * and passed to the Rx callback as in Rx copy-out mode (see
+ * ipc_shm_ext_set_rx_copy()). Both sides must compress the channel, which
+ * must be set before traffic starts. Channels whose received buffers are kept
+ * after the Rx callback returns, i.e. held with ipc_shm_ext_hold_rx(), can't
+ * be compressed.
+ *
+ * Return: 0 on success, -EBUSY if the channel is held, error code otherwise
+ */
+int ipc_shm_compress_enable(const uint8_t instance, int chan_id, bool enable);
+
+/**
+ * ipc_shm_compress_get_stats() - get compression statistics of a channel
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ * @stats:	statistics since initialization
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_compress_get_stats(const uint8_t instance, int chan_id,
+		struct ipc_shm_compress_stats *stats);
+
+/* hooks called by the extended API */
+size_t ipc_compress_trailer(const uint8_t instance, int chan_id);
+size_t ipc_compress_seal(const uint8_t instance, int chan_id, void *buf,
+		size_t size);
+int ipc_compress_tx(const uint8_t instance, int chan_id,
+		const struct iovec *iov, int iovcnt);
+int ipc_compress_parse(const uint8_t instance, int chan_id, const void *msg,
+		size_t *size, size_t *orig);
+int ipc_compress_rx(const uint8_t instance, int chan_id, const void *in,
+		size_t size, void *out, size_t orig);
+void ipc_compress_reset(void);
+
+#endif /* IPC_COMPRESS_H */
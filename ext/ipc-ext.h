@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_EXT_H
+#define IPC_EXT_H
+
+#include <pthread.h>
+
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-sizeclass.h"
+
+/*
+ * Largest cache line size of supported cores. Per channel data written on the
+ * Tx path is aligned to it, so that channels driven from different cores
+ * share no cache lines.
+ */
+#define IPC_EXT_CACHE_LINE 64u
+
+/* discarded buffers kept for reuse per pool */
+#define IPC_EXT_STASH_BUFS 4u
+
+/**
+ * struct ipc_ext_rx - application Rx callback of a managed channel
+ * @cb:		callback function
+ * @arg:	callback argument
+ */
+struct ipc_ext_rx {
+	ipc_shm_rx_cb cb;
+	void *arg;
+};
+
+/**
+ * struct ipc_ext_chan - user-space extensions private data per channel
+ * @managed:		true for managed channels
+ * @instance:		instance id
+ * @chan_id:		channel index
+ * @trailer:		size of the payload trailers, for resolved channels
+ * @sc:			size class table (managed channels only)
+ * @rx:			application Rx callback, double buffered so that it
+ *			can be replaced while the channel is receiving
+ * @rx_sel:		index of the active Rx callback
+ * @rx_copy:		pass cached copies of received buffers to the
+ *			application Rx callback
+ * @rx_hold:		the Rx callback keeps received buffers after it
+ *			returns (publish/subscribe, broker clients, C++
+ *			coroutine channels), which rules out cached copies
+ * @hold_lock:		lock ordering taking @rx_hold with enabling copy-out
+ *			and compression, and updates of @trailer
+ * @stash_lock:		lock protecting discarded buffers
+ * @stash_count:	number of discarded buffers in all pools
+ * @stash_len:		number of discarded buffers per pool
+ * @stash:		discarded buffers per pool
+ */
+struct ipc_ext_chan {
+	bool managed;
+	uint8_t instance;
+	int chan_id;
+	uint32_t trailer;
+	struct ipc_sizeclass sc;
+	struct ipc_ext_rx rx[2];
+	uint32_t rx_sel;
+	bool rx_copy;
+	bool rx_hold;
+	pthread_mutex_t hold_lock;
+	pthread_mutex_t stash_lock;
+	uint32_t stash_count;
+	uint32_t stash_len[IPC_SHM_MAX_POOLS];
+	void *stash[IPC_SHM_MAX_POOLS][IPC_EXT_STASH_BUFS];
+} __attribute__((aligned(IPC_EXT_CACHE_LINE)));
+
+struct ipc_ext_chan *ipc_ext_get_chan(const uint8_t instance, int chan_id);
+const struct ipc_shm_cfg *ipc_ext_get_cfg(const uint8_t instance);
+int ipc_ext_num_instances(void);
+/* call the application Rx callback of a message deferred by the watchdog */
+void ipc_ext_rx_deliver(const uint8_t instance, int chan_id, void *buf,
+		size_t size, bool copy);
+
+/* extended API without payload trailers handling, unless noted */
+size_t ipc_ext_trailer(const uint8_t instance, int chan_id);
+void ipc_ext_update_trailer(const uint8_t instance, int chan_id);
+void *ipc_ext_acquire_buf(const uint8_t instance, int chan_id, size_t size,
+		bool probe);
+int ipc_ext_tx(const uint8_t instance, int chan_id, void *buf, size_t size);
+int ipc_ext_discard_buf(const uint8_t instance, int chan_id, void *buf,
+		size_t size);
+/* appends the integrity trailer but doesn't compress */
+int ipc_ext_tx_copyv(const uint8_t instance, int chan_id,
+		const struct iovec *iov, int iovcnt);
+
+#endif /* IPC_EXT_H */
@@ -0,0 +1,301 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <pthread.h>
+#include <time.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-ext.h"
+#include "ipc-flowctl.h"
+
+/*
+ * Remote buffer releases do not raise an interrupt, so waiters are woken by
+ * the next Rx softirq pass (the remote usually transmits when it releases) or
+ * after this interval, whichever comes first.
+ */
+#define IPC_FLOWCTL_POLL_NS	1000000L
+
+#define NSEC_PER_SEC		1000000000L
+#define NSEC_PER_MSEC		1000000L
+
+/**
+ * struct ipc_flowctl_req - pending asynchronous acquire request
+ * @size:	required buffer size
+ * @cb:		completion callback
+ * @arg:	completion callback argument
+ */
+struct ipc_flowctl_req {
+	size_t size;
+	ipc_shm_buf_cb cb;
+	void *arg;
+};
+
+/**
+ * struct ipc_flowctl_chan - flow control private data per channel
+ * @lock:	lock protecting the pending requests queue, with priority
+ *		inheritance
+ * @servicing:	a thread is completing requests, others leave it to it
+ * @again:	requests to retry once the servicing thread is done
+ * @cancel:	complete pending requests with a NULL buffer
+ * @head:	index of oldest pending request
+ * @count:	number of pending requests
+ * @req:	pending requests circular queue
+ *
+ * Completion callbacks run without @lock held, so @servicing keeps a single
+ * thread completing the requests of a channel, one at a time and in order.
+ */
+struct ipc_flowctl_chan {
+	pthread_mutex_t lock;
+	bool servicing;
+	bool again;
+	bool cancel;
+	uint32_t head;
+	uint32_t count;
+	struct ipc_flowctl_req req[IPC_FLOWCTL_MAX_PENDING];
+} __attribute__((aligned(IPC_EXT_CACHE_LINE)));
+
+/**
+ * struct ipc_flowctl_priv - flow control private data
+ * @once:	one-time initialization control
+ * @chan:	private data per instance and channel
+ */
+static struct ipc_flowctl_priv {
+	pthread_once_t once;
+	struct ipc_flowctl_chan chan[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+} priv = {
+	.once = PTHREAD_ONCE_INIT,
+};
+
+static void timespec_add_ns(struct timespec *ts, long ns)
+{
+	ts->tv_sec += ns / NSEC_PER_SEC;
+	ts->tv_nsec += ns % NSEC_PER_SEC;
+	if (ts->tv_nsec >= NSEC_PER_SEC) {
+		ts->tv_sec++;
+		ts->tv_nsec -= NSEC_PER_SEC;
+	}
+}
+
+static int timespec_before(const struct timespec *a, const struct timespec *b)
+{
+	if (a->tv_sec != b->tv_sec)
+		return a->tv_sec < b->tv_sec;
+	return a->tv_nsec < b->tv_nsec;
+}
+
+static int ipc_flowctl_check_args(const uint8_t instance, int chan_id)
+{
+	if (instance >= IPC_SHM_MAX_INSTANCES)
+		return -EINVAL;
+	if (chan_id < 0 || chan_id >= (int)IPC_SHM_MAX_CHANNELS)
+		return -EINVAL;
+
+	return 0;
+}
+
+/* retry an acquire, trailers included, probing all pools */
+static void *ipc_flowctl_acquire(const uint8_t instance, int chan_id,
+		size_t size)
+{
+	size += ipc_ext_trailer(instance, chan_id);
+
+	return ipc_ext_acquire_buf(instance, chan_id, size, true);
+}
+
+/*
+ * complete pending requests of a channel in order, while buffers are free or
+ * with a NULL buffer if canceled; a thread finding another one completing
+ * requests leaves them to it
+ */
+static void ipc_flowctl_service_chan(const uint8_t instance, int chan_id,
+		bool cancel)
+{
+	struct ipc_flowctl_chan *chan = &priv.chan[instance][chan_id];
+	struct ipc_flowctl_req req;
+	void *buf;
+
+	pthread_mutex_lock(&chan->lock);
+	chan->cancel |= cancel;
+	if (chan->servicing) {
+		chan->again = true;
+		pthread_mutex_unlock(&chan->lock);
+		return;
+	}
+	chan->servicing = true;
+
+	do {
+		chan->again = false;
+		while (chan->count) {
+			req = chan->req[chan->head];
+			buf = NULL;
+			if (!chan->cancel) {
+				buf = ipc_flowctl_acquire(instance, chan_id,
+							  req.size);
+				if (!buf)
+					break;
+			}
+
+			chan->head = (chan->head + 1u)
+				     % IPC_FLOWCTL_MAX_PENDING;
+			__atomic_store_n(&chan->count, chan->count - 1u,
+					 __ATOMIC_RELAXED);
+
+			/* callback may submit new requests */
+			pthread_mutex_unlock(&chan->lock);
+			req.cb(req.arg, instance, chan_id, buf);
+			pthread_mutex_lock(&chan->lock);
+		}
+	} while (chan->again);
+
+	chan->cancel = false;
+	chan->servicing = false;
+	pthread_mutex_unlock(&chan->lock);
+}
+
+/* Rx event hook: remote may have released buffers */
+static void ipc_flowctl_rx_event(const uint8_t instance)
+{
+	int chan_id;
+
+	for (chan_id = 0; chan_id < (int)IPC_SHM_MAX_CHANNELS; chan_id++) {
+		/* unlocked peek, a missed request is retried on next event */
+		if (__atomic_load_n(&priv.chan[instance][chan_id].count,
+				    __ATOMIC_RELAXED))
+			ipc_flowctl_service_chan(instance, chan_id, false);
+	}
+}
+
+static void ipc_flowctl_init_once(void)
+{
+	pthread_mutexattr_t attr;
+	int i, j;
+
+	/* the Rx thread takes the locks too */
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	for (i = 0; i < (int)IPC_SHM_MAX_INSTANCES; i++)
+		for (j = 0; j < (int)IPC_SHM_MAX_CHANNELS; j++)
+			pthread_mutex_init(&priv.chan[i][j].lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	if (ipc_os_add_rx_event_hook(ipc_flowctl_rx_event))
+		shm_err("can't register Rx event hook\n");
+}
+
+void *ipc_shm_acquire_buf_timed(const uint8_t instance, int chan_id,
+		size_t size, int timeout_ms)
+{
+	struct timespec deadline, wake;
+	uint32_t seq;
+	void *buf;
+
+	buf = ipc_shm_ext_acquire_buf(instance, chan_id, size);
+	if (buf || timeout_ms == 0)
+		return buf;
+
+	if (ipc_flowctl_check_args(instance, chan_id))
+		return NULL;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	timespec_add_ns(&deadline, (long)timeout_ms * NSEC_PER_MSEC);
+
+	while (1) {
+		/*
+		 * Sample event sequence before retrying to not miss a wakeup.
+		 * Retries probe all pools, bypassing the exhaustion hints.
+		 */
+		seq = ipc_os_rx_event_seq(instance);
+
+		buf = ipc_flowctl_acquire(instance, chan_id, size);
+		if (buf)
+			return buf;
+
+		clock_gettime(CLOCK_MONOTONIC, &wake);
+		if (timeout_ms > 0 && !timespec_before(&wake, &deadline))
+			break;
+
+		timespec_add_ns(&wake, IPC_FLOWCTL_POLL_NS);
+		if (timeout_ms > 0 && timespec_before(&deadline, &wake))
+			wake = deadline;
+
+		ipc_os_rx_event_wait(instance, seq, &wake);
+	}
+
+	shm_dbg_ch(instance, chan_id,
+		   "timeout acquiring %zu bytes on channel %d\n", size,
+		   chan_id);
+
+	return NULL;
+}
+
+int ipc_shm_acquire_buf_async(const uint8_t instance, int chan_id,
+		size_t size, ipc_shm_buf_cb cb, void *arg)
+{
+	struct ipc_flowctl_chan *chan;
+	uint32_t tail;
+	void *buf;
+	int err;
+
+	err = ipc_flowctl_check_args(instance, chan_id);
+	if (err)
+		return err;
+	if (!cb)
+		return -EINVAL;
+
+	pthread_once(&priv.once, ipc_flowctl_init_once);
+	chan = &priv.chan[instance][chan_id];
+
+	pthread_mutex_lock(&chan->lock);
+
+	/*
+	 * complete right away only if that doesn't overtake pending requests
+	 * or run concurrently with their completion
+	 */
+	if (chan->count == 0 && !chan->servicing) {
+		buf = ipc_shm_ext_acquire_buf(instance, chan_id, size);
+		if (buf) {
+			pthread_mutex_unlock(&chan->lock);
+			cb(arg, instance, chan_id, buf);
+			return 0;
+		}
+	}
+
+	if (chan->count == IPC_FLOWCTL_MAX_PENDING) {
+		pthread_mutex_unlock(&chan->lock);
+		shm_err_ch(instance, chan_id,
+			   "too many pending requests on channel %d\n",
+			   chan_id);
+		return -ENOSPC;
+	}
+
+	tail = (chan->head + chan->count) % IPC_FLOWCTL_MAX_PENDING;
+	chan->req[tail].size = size;
+	chan->req[tail].cb = cb;
+	chan->req[tail].arg = arg;
+	__atomic_store_n(&chan->count, chan->count + 1u, __ATOMIC_RELAXED);
+
+	pthread_mutex_unlock(&chan->lock);
+
+	return 0;
+}
+
+void ipc_shm_acquire_buf_cancel(const uint8_t instance, int chan_id)
+{
+	if (ipc_flowctl_check_args(instance, chan_id))
+		return;
+
+	pthread_once(&priv.once, ipc_flowctl_init_once);
+	ipc_flowctl_service_chan(instance, chan_id, true);
+}
+
+void ipc_shm_acquire_buf_poll(const uint8_t instance)
+{
+	if (instance >= IPC_SHM_MAX_INSTANCES)
+		return;
+
+	pthread_once(&priv.once, ipc_flowctl_init_once);
+	ipc_flowctl_rx_event(instance);
+}
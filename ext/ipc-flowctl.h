@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_FLOWCTL_H
+#define IPC_FLOWCTL_H
+
+#include "ipc-shm.h"
+
+/* maximum number of pending asynchronous acquire requests per channel */
+#define IPC_FLOWCTL_MAX_PENDING 16u
+
+/**
+ * typedef ipc_shm_buf_cb - asynchronous acquire completion callback
+ * @arg:	argument passed to ipc_shm_acquire_buf_async()
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	acquired buffer or NULL if the request was canceled
+ */
+typedef void (*ipc_shm_buf_cb)(void *arg, const uint8_t instance, int chan_id,
+		void *buf);
+
+/**
+ * ipc_shm_acquire_buf_timed() - acquire buffer, waiting for a free one
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @size:	required size
+ * @timeout_ms:	maximum wait time in ms, 0 to not wait, negative to wait forever
+ *
+ * Sleeps until the remote releases a buffer large enough for @size or until
+ * @timeout_ms elapses.
+ *
+ * Return: pointer to the buffer base address or NULL on timeout
+ */
+void *ipc_shm_acquire_buf_timed(const uint8_t instance, int chan_id,
+		size_t size, int timeout_ms);
+
+/**
+ * ipc_shm_acquire_buf_async() - acquire buffer when one becomes available
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @size:	required size
+ * @cb:		completion callback
+ * @arg:	completion callback argument
+ *
+ * If a buffer is available and no other request is pending on the channel,
+ * @cb is called before returning. Otherwise the request is queued and @cb is
+ * called from the Rx softirq thread once the remote releases a buffer of a
+ * suitable size. Requests on a channel complete in submission order, one at a
+ * time.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_acquire_buf_async(const uint8_t instance, int chan_id,
+		size_t size, ipc_shm_buf_cb cb, void *arg);
+
+/**
+ * ipc_shm_acquire_buf_cancel() - cancel pending asynchronous requests
+ * @instance:	instance id
+ * @chan_id:	channel index
+ *
+ * Completion callbacks of canceled requests are called with a NULL buffer. If
+ * requests are being completed by another thread, or by the caller from a
+ * completion callback, that thread cancels them after the current one.
+ */
+void ipc_shm_acquire_buf_cancel(const uint8_t instance, int chan_id);
+
+/**
+ * ipc_shm_acquire_buf_poll() - retry pending asynchronous requests
+ * @instance:	instance id
+ *
+ * Remote buffer releases are not signaled by an interrupt, so pending
+ * requests are retried after each Rx softirq pass. Applications talking to a
+ * remote that seldom transmits (e.g. in polling mode) may call this function
+ * periodically instead.
+ */
+void ipc_shm_acquire_buf_poll(const uint8_t instance);
+
+#endif /* IPC_FLOWCTL_H */
@@ -0,0 +1,249 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <pthread.h>
+#include <sched.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-ext.h"
+#include "ipc-io.h"
+#include "ipc-integrity.h"
+#include "ipc-compress.h"
+#include "ipc-fwd.h"
+
+/**
+ * struct ipc_fwd_table - forwarding rules of a source channel
+ * @count:	number of rules, published after the rule is written
+ * @busy:	messages being matched against the rules
+ * @rule:	rules in matching order
+ * @stats:	forwarding statistics, written by the Rx thread only
+ */
+struct ipc_fwd_table {
+	uint32_t count;
+	uint32_t busy;
+	struct ipc_shm_fwd_rule rule[IPC_FWD_MAX_RULES];
+	struct ipc_shm_fwd_stats stats;
+} __attribute__((aligned(IPC_EXT_CACHE_LINE)));
+
+/**
+ * struct ipc_fwd_priv - forwarding private data
+ * @lock:	lock serializing rule updates
+ * @table:	forwarding rules per instance and channel
+ */
+static struct ipc_fwd_priv {
+	pthread_mutex_t lock;
+	struct ipc_fwd_table table[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+} priv = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* true while the Rx thread defers the doorbells of forwarded messages */
+static __thread bool batch_open;
+
+static struct ipc_fwd_table *ipc_fwd_get_table(const uint8_t instance,
+		int chan_id)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+
+	if (!chan || !chan->managed)
+		return NULL;
+
+	return &priv.table[instance][chan_id];
+}
+
+/* messages are forwarded sealed, so both channels must seal them alike */
+static bool ipc_fwd_same_trailers(const uint8_t instance, int chan_id,
+		const struct ipc_shm_fwd_rule *rule)
+{
+	return ipc_integrity_trailer(instance, chan_id)
+	       == ipc_integrity_trailer(rule->dst_instance, rule->dst_chan_id)
+	       && ipc_compress_trailer(instance, chan_id)
+	       == ipc_compress_trailer(rule->dst_instance, rule->dst_chan_id);
+}
+
+void ipc_fwd_reset(void)
+{
+	memset(priv.table, 0, sizeof(priv.table));
+}
+
+int ipc_shm_fwd_add(const uint8_t instance, int chan_id,
+		const struct ipc_shm_fwd_rule *rule)
+{
+	struct ipc_fwd_table *table = ipc_fwd_get_table(instance, chan_id);
+	struct ipc_ext_chan *dst;
+	int err = 0;
+
+	if (!table || !rule || (rule->match_off & 7u))
+		return -EINVAL;
+
+	dst = ipc_ext_get_chan(rule->dst_instance, rule->dst_chan_id);
+	if (!dst || !dst->managed)
+		return -EINVAL;
+	if (rule->dst_instance == instance && rule->dst_chan_id == chan_id)
+		return -EINVAL;
+	if (!ipc_fwd_same_trailers(instance, chan_id, rule))
+		return -EINVAL;
+	/* the header word of compressed messages is compressed too */
+	if (rule->match_mask && ipc_compress_trailer(instance, chan_id))
+		return -EINVAL;
+
+	pthread_mutex_lock(&priv.lock);
+	if (table->count == IPC_FWD_MAX_RULES) {
+		err = -ENOSPC;
+		goto out;
+	}
+	table->rule[table->count] = *rule;
+	table->rule[table->count].match_val &= rule->match_mask;
+	__atomic_store_n(&table->count, table->count + 1u, __ATOMIC_SEQ_CST);
+
+out:
+	pthread_mutex_unlock(&priv.lock);
+
+	return err;
+}
+
+int ipc_shm_fwd_clear(const uint8_t instance, int chan_id)
+{
+	struct ipc_fwd_table *table = ipc_fwd_get_table(instance, chan_id);
+
+	if (!table)
+		return -EINVAL;
+
+	/* rules can be overwritten once no message is matched against them */
+	pthread_mutex_lock(&priv.lock);
+	__atomic_store_n(&table->count, 0u, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&table->busy, __ATOMIC_SEQ_CST))
+		sched_yield();
+	pthread_mutex_unlock(&priv.lock);
+
+	return 0;
+}
+
+int ipc_shm_fwd_get_stats(const uint8_t instance, int chan_id,
+		struct ipc_shm_fwd_stats *stats)
+{
+	struct ipc_fwd_table *table = ipc_fwd_get_table(instance, chan_id);
+
+	if (!table || !stats)
+		return -EINVAL;
+
+	stats->forwarded = __atomic_load_n(&table->stats.forwarded,
+					   __ATOMIC_RELAXED);
+	stats->dropped = __atomic_load_n(&table->stats.dropped,
+					 __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+static void ipc_fwd_count(uint64_t *counter)
+{
+	__atomic_store_n(counter, *counter + 1u, __ATOMIC_RELAXED);
+}
+
+static bool ipc_fwd_match(const struct ipc_shm_fwd_rule *rule,
+		const void *buf, size_t size)
+{
+	uint64_t word;
+
+	if (!rule->match_mask)
+		return true;
+	if (size < rule->match_off + 8u)
+		return false;
+
+	/* buffers are 8 byte aligned, so is the header word */
+	word = *(const volatile uint64_t *)((const char *)buf
+					    + rule->match_off);
+
+	return (word & rule->match_mask) == rule->match_val;
+}
+
+/* copy message to a destination buffer and send it, false if dropped */
+static bool ipc_fwd_send(const struct ipc_shm_fwd_rule *rule, void *buf,
+		size_t size)
+{
+	void *out;
+
+	/* messages are forwarded as is, integrity trailer included */
+	out = ipc_ext_acquire_buf(rule->dst_instance, rule->dst_chan_id, size,
+				  false);
+	if (!out)
+		return false;
+
+	ipc_copy_io(out, buf, size);
+
+	if (!batch_open) {
+		ipc_os_notify_batch_begin();
+		batch_open = true;
+	}
+
+	if (ipc_ext_tx(rule->dst_instance, rule->dst_chan_id, out, size)) {
+		ipc_ext_discard_buf(rule->dst_instance, rule->dst_chan_id, out,
+				    size);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * ipc_fwd_rx() - forward a received message matching a rule
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	received buffer
+ * @size:	received message size
+ *
+ * Return: true if the message was consumed, false to pass it to the
+ *	   application
+ */
+bool ipc_fwd_rx(const uint8_t instance, int chan_id, void *buf, size_t size)
+{
+	struct ipc_fwd_table *table = &priv.table[instance][chan_id];
+	const struct ipc_shm_fwd_rule *rule = NULL;
+	uint32_t i, count;
+
+	if (!__atomic_load_n(&table->count, __ATOMIC_RELAXED))
+		return false;
+
+	/* counting busy before reading rules orders them with rules clear */
+	__atomic_fetch_add(&table->busy, 1u, __ATOMIC_SEQ_CST);
+	count = __atomic_load_n(&table->count, __ATOMIC_SEQ_CST);
+	for (i = 0; i < count; i++) {
+		if (ipc_fwd_match(&table->rule[i], buf, size)) {
+			rule = &table->rule[i];
+			break;
+		}
+	}
+
+	if (rule) {
+		/* dropped if settings changed since the rule was added */
+		if (ipc_fwd_same_trailers(instance, chan_id, rule)
+		    && ipc_fwd_send(rule, buf, size))
+			ipc_fwd_count(&table->stats.forwarded);
+		else
+			ipc_fwd_count(&table->stats.dropped);
+	}
+	__atomic_fetch_sub(&table->busy, 1u, __ATOMIC_SEQ_CST);
+
+	if (!rule)
+		return false;
+
+	ipc_shm_ext_release_buf(instance, chan_id, buf);
+
+	return true;
+}
+
+/**
+ * ipc_fwd_rx_event() - ring doorbells deferred during an Rx pass
+ * @instance:	instance id
+ */
+void ipc_fwd_rx_event(const uint8_t instance)
+{
+	if (!batch_open)
+		return;
+
+	batch_open = false;
+	ipc_os_notify_batch_end();
+}
@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_FWD_H
+#define IPC_FWD_H
+
+#include <stdbool.h>
+
+#include "ipc-shm.h"
+
+/* forwarding rules per source channel */
+#define IPC_FWD_MAX_RULES 8u
+
+/**
+ * struct ipc_shm_fwd_rule - forwarding rule of a source channel
+ * @dst_instance:	destination instance id
+ * @dst_chan_id:	destination managed channel index
+ * @match_off:		offset of the matched header word, a multiple of 8
+ * @match_mask:		bits of the header word compared, 0 to match all
+ *			messages
+ * @match_val:		value of the compared bits
+ *
+ * The header word is the 8 bytes at @match_off, loaded in native byte order.
+ * Messages shorter than @match_off + 8 bytes only match a rule with a 0
+ * @match_mask.
+ */
+struct ipc_shm_fwd_rule {
+	uint8_t dst_instance;
+	int dst_chan_id;
+	uint32_t match_off;
+	uint64_t match_mask;
+	uint64_t match_val;
+};
+
+/**
+ * struct ipc_shm_fwd_stats - forwarding statistics of a source channel
+ * @forwarded:	messages sent on their destination channel
+ * @dropped:	messages matched but lost for lack of destination buffer or
+ *		destination Tx error
+ */
+struct ipc_shm_fwd_stats {
+	uint64_t forwarded;
+	uint64_t dropped;
+};
+
+/**
+ * ipc_shm_fwd_add() - forward messages of a managed channel to another one
+ * @instance:	source instance id
+ * @chan_id:	source managed channel index
+ * @rule:	forwarding rule
+ *
+ * Messages received on the source channel are checked against its rules in
+ * the order they were added. The first matching rule forwards the message
+ * unchanged: the Rx thread copies it straight from the received buffer to a
+ * buffer of the destination channel, sends it and releases the received
+ * buffer, without calling the application Rx callback. Messages matching no
+ * rule reach the application as usual. Doorbells of forwarded messages are
+ * rung once per destination instance at the end of each Rx pass.
+ *
+ * Both channels must belong to instances initialized with ipc_shm_ext_init().
+ * Rules can be added while the source channel receives. Messages are
+ * forwarded with their trailers, so both channels must have the same
+ * integrity (see ipc_shm_integrity_enable()) and compression (see
+ * ipc_shm_compress_enable()) settings, and rules of compressed source
+ * channels can't match a header word. Messages matching a rule whose
+ * channels settings differ since it was added are dropped.
+ *
+ * Return: 0 on success, -EINVAL if the channels seal messages differently,
+ *	   error code otherwise
+ */
+int ipc_shm_fwd_add(const uint8_t instance, int chan_id,
+		const struct ipc_shm_fwd_rule *rule);
+
+/**
+ * ipc_shm_fwd_clear() - remove forwarding rules of a managed channel
+ * @instance:	source instance id
+ * @chan_id:	source managed channel index
+ *
+ * Waits for the message being forwarded from the channel, if any, so must not
+ * be called from an Rx callback.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_fwd_clear(const uint8_t instance, int chan_id);
+
+/**
+ * ipc_shm_fwd_get_stats() - get forwarding statistics of a managed channel
+ * @instance:	source instance id
+ * @chan_id:	source managed channel index
+ * @stats:	statistics since initialization
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_fwd_get_stats(const uint8_t instance, int chan_id,
+		struct ipc_shm_fwd_stats *stats);
+
+/* hooks called by the extended API */
+bool ipc_fwd_rx(const uint8_t instance, int chan_id, void *buf, size_t size);
+void ipc_fwd_rx_event(const uint8_t instance);
+void ipc_fwd_reset(void);
+
+#endif /* IPC_FWD_H */
@@ -0,0 +1,301 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <pthread.h>
+#include <string.h>
+#if defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-ext.h"
+#include "ipc-io.h"
+#include "ipc-integrity.h"
+
+/* reflected polynomial of CRC32C (Castagnoli) */
+#define IPC_CRC32C_POLY		0x82F63B78u
+/* bytes copied then summed while still in the L1 cache */
+#define IPC_CRC_CHUNK		IPC_IO_BOUNCE
+
+typedef uint32_t (*ipc_crc32c_fn)(uint32_t crc, const void *buf, size_t len);
+
+/**
+ * struct ipc_integrity_priv - payload integrity private data
+ * @once:	one-time selection of the CRC implementation
+ * @crc32c:	CRC32C implementation for the core
+ * @table:	lookup table of the software implementation
+ * @enabled:	protected channels of each instance, one bit per channel
+ * @errors:	check failures per instance and channel
+ * @err_cb:	check failure callback
+ * @err_arg:	check failure callback argument
+ */
+static struct ipc_integrity_priv {
+	pthread_once_t once;
+	ipc_crc32c_fn crc32c;
+	uint32_t table[256];
+	uint32_t enabled[IPC_SHM_MAX_INSTANCES];
+	uint64_t errors[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+	ipc_shm_crc_err_cb err_cb;
+	void *err_arg;
+} priv = {
+	.once = PTHREAD_ONCE_INIT,
+};
+
+static uint32_t ipc_crc32c_sw(uint32_t crc, const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+
+	for (; len; p++, len--)
+		crc = priv.table[(crc ^ *p) & 0xffu] ^ (crc >> 8);
+
+	return crc;
+}
+
+#if defined(__aarch64__)
+__attribute__((target("+crc")))
+static uint32_t ipc_crc32c_armv8(uint32_t crc, const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+	uint64_t v;
+
+	for (; len >= 8u; p += 8, len -= 8u) {
+		memcpy(&v, p, 8u);
+		crc = __builtin_aarch64_crc32cx(crc, v);
+	}
+	for (; len; p++, len--)
+		crc = __builtin_aarch64_crc32cb(crc, *p);
+
+	return crc;
+}
+#elif defined(__x86_64__)
+__attribute__((target("sse4.2")))
+static uint32_t ipc_crc32c_sse42(uint32_t crc, const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+	uint64_t v, c = crc;
+
+	for (; len >= 8u; p += 8, len -= 8u) {
+		memcpy(&v, p, 8u);
+		c = __builtin_ia32_crc32di(c, v);
+	}
+	crc = (uint32_t)c;
+	for (; len; p++, len--)
+		crc = __builtin_ia32_crc32qi(crc, *p);
+
+	return crc;
+}
+#endif
+
+/* select the CRC instructions of the core, if any */
+static void ipc_integrity_init(void)
+{
+	uint32_t crc, i, j;
+
+	for (i = 0; i < 256u; i++) {
+		crc = i;
+		for (j = 0; j < 8u; j++)
+			crc = (crc >> 1) ^ (IPC_CRC32C_POLY & -(crc & 1u));
+		priv.table[i] = crc;
+	}
+
+	priv.crc32c = ipc_crc32c_sw;
+#if defined(__aarch64__)
+	if (getauxval(AT_HWCAP) & HWCAP_CRC32)
+		priv.crc32c = ipc_crc32c_armv8;
+#elif defined(__x86_64__)
+	if (__builtin_cpu_supports("sse4.2"))
+		priv.crc32c = ipc_crc32c_sse42;
+#endif
+}
+
+/*
+ * Copy from shared memory, to a bounce buffer if dst is NULL, summing each
+ * chunk from the cached copy right after it is read.
+ */
+static uint32_t ipc_crc32c_fromio(uint32_t crc, void *dst, const void *src,
+		size_t len)
+{
+	uint64_t bounce[IPC_CRC_CHUNK / 8u];
+	const char *s = src;
+	char *d = dst;
+	size_t w;
+
+	for (; len; s += w, len -= w) {
+		w = len < IPC_CRC_CHUNK ? len : IPC_CRC_CHUNK;
+		ipc_copy_fromio(d ? d : (char *)bounce, s, w);
+		crc = priv.crc32c(crc, d ? d : (char *)bounce, w);
+		if (d)
+			d += w;
+	}
+
+	return crc;
+}
+
+/* copy to shared memory, summing each chunk of the source before writing */
+static uint32_t ipc_crc32c_toio(uint32_t crc, void *dst, const void *src,
+		size_t len)
+{
+	const char *s = src;
+	char *d = dst;
+	size_t w;
+
+	for (; len; d += w, s += w, len -= w) {
+		w = len < IPC_CRC_CHUNK ? len : IPC_CRC_CHUNK;
+		crc = priv.crc32c(crc, s, w);
+		ipc_copy_toio(d, s, w);
+	}
+
+	return crc;
+}
+
+/* write the final CRC little endian after the payload */
+static void ipc_integrity_put(void *buf, size_t size, uint32_t crc)
+{
+	uint8_t trailer[IPC_SHM_CRC_SIZE];
+	uint32_t i;
+
+	crc = ~crc;
+	for (i = 0; i < IPC_SHM_CRC_SIZE; i++)
+		trailer[i] = (uint8_t)(crc >> (8u * i));
+
+	ipc_copy_toio((char *)buf + size, trailer, sizeof(trailer));
+}
+
+int ipc_shm_integrity_enable(const uint8_t instance, int chan_id, bool enable)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+
+	if (!chan || !chan->managed)
+		return -EINVAL;
+
+	pthread_once(&priv.once, ipc_integrity_init);
+
+	if (enable)
+		__atomic_fetch_or(&priv.enabled[instance], 1u << chan_id,
+				  __ATOMIC_RELAXED);
+	else
+		__atomic_fetch_and(&priv.enabled[instance], ~(1u << chan_id),
+				   __ATOMIC_RELAXED);
+	ipc_ext_update_trailer(instance, chan_id);
+
+	return 0;
+}
+
+void ipc_shm_integrity_set_err_cb(ipc_shm_crc_err_cb cb, void *arg)
+{
+	priv.err_arg = arg;
+	__atomic_store_n(&priv.err_cb, cb, __ATOMIC_RELEASE);
+}
+
+uint64_t ipc_shm_integrity_errors(const uint8_t instance, int chan_id)
+{
+	if (!ipc_ext_get_chan(instance, chan_id))
+		return 0;
+
+	return __atomic_load_n(&priv.errors[instance][chan_id],
+			       __ATOMIC_RELAXED);
+}
+
+/**
+ * ipc_integrity_trailer() - get trailer size of a channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ *
+ * Return: IPC_SHM_CRC_SIZE for protected channels, 0 otherwise
+ */
+size_t ipc_integrity_trailer(const uint8_t instance, int chan_id)
+{
+	if (instance >= IPC_SHM_MAX_INSTANCES || chan_id < 0
+	    || chan_id >= (int)IPC_SHM_MAX_CHANNELS)
+		return 0;
+
+	if (__atomic_load_n(&priv.enabled[instance], __ATOMIC_RELAXED)
+	    & (1u << chan_id))
+		return IPC_SHM_CRC_SIZE;
+
+	return 0;
+}
+
+/**
+ * ipc_integrity_seal() - append trailer to a payload filled in place
+ * @buf:	buffer in shared memory, with room for the trailer
+ * @size:	payload size
+ */
+void ipc_integrity_seal(void *buf, size_t size)
+{
+	ipc_integrity_put(buf, size, ipc_crc32c_fromio(~0u, NULL, buf, size));
+}
+
+/**
+ * ipc_integrity_copy_seal() - fill a buffer with a payload and its trailer
+ * @buf:	buffer in shared memory, with room for the trailer
+ * @iov:	payload segments, in order
+ * @iovcnt:	number of segments
+ */
+void ipc_integrity_copy_seal(void *buf, const struct iovec *iov, int iovcnt)
+{
+	uint32_t crc = ~0u;
+	size_t off = 0;
+	int i;
+
+	for (i = 0; i < iovcnt; i++) {
+		crc = ipc_crc32c_toio(crc, (char *)buf + off, iov[i].iov_base,
+				      iov[i].iov_len);
+		off += iov[i].iov_len;
+	}
+
+	ipc_integrity_put(buf, off, crc);
+}
+
+/**
+ * ipc_integrity_check() - check a received message of a protected channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	received buffer
+ * @size:	received size, trailer included
+ * @copy:	cached buffer to copy the payload to while checking, or NULL
+ *
+ * Failures are counted and passed to the error callback.
+ *
+ * Return: true if the payload matches its trailer
+ */
+bool ipc_integrity_check(const uint8_t instance, int chan_id, const void *buf,
+		size_t size, void *copy)
+{
+	uint8_t trailer[IPC_SHM_CRC_SIZE];
+	ipc_shm_crc_err_cb cb;
+	uint32_t crc, i;
+	size_t payload;
+
+	if (size >= IPC_SHM_CRC_SIZE) {
+		payload = size - IPC_SHM_CRC_SIZE;
+		crc = ~ipc_crc32c_fromio(~0u, copy, buf, payload);
+		ipc_copy_fromio(trailer, (const char *)buf + payload,
+				sizeof(trailer));
+		for (i = 0; i < IPC_SHM_CRC_SIZE; i++)
+			crc ^= (uint32_t)trailer[i] << (8u * i);
+		if (!crc)
+			return true;
+	}
+
+	__atomic_fetch_add(&priv.errors[instance][chan_id], 1u,
+			   __ATOMIC_RELAXED);
+	shm_dbg_ch(instance, chan_id, "Integrity check failed on channel %d\n",
+		   chan_id);
+
+	cb = __atomic_load_n(&priv.err_cb, __ATOMIC_ACQUIRE);
+	if (cb)
+		cb(priv.err_arg, instance, chan_id, buf, size);
+
+	return false;
+}
+
+/* forget protected channels and failures of a previous initialization */
+void ipc_integrity_reset(void)
+{
+	memset(priv.enabled, 0, sizeof(priv.enabled));
+	memset(priv.errors, 0, sizeof(priv.errors));
+}
@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_INTEGRITY_H
+#define IPC_INTEGRITY_H
+
+#include <stdbool.h>
+#include <sys/uio.h>
+
+#include "ipc-shm.h"
+
+/* size of the CRC32C trailer appended to messages of protected channels */
+#define IPC_SHM_CRC_SIZE	4u
+
+/**
+ * typedef ipc_shm_crc_err_cb - called on a received message failing its check
+ * @arg:	callback argument
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	received buffer, released after the callback returns
+ * @size:	received size, trailer included
+ */
+typedef void (*ipc_shm_crc_err_cb)(void *arg, const uint8_t instance,
+		int chan_id, const void *buf, size_t size);
+
+/**
+ * ipc_shm_integrity_enable() - set payload integrity mode of a managed channel
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ * @enable:	true to protect messages with a CRC32C trailer
+ *
+ * Messages sent on a protected channel get a CRC32C of their payload in a
+ * trailer of IPC_SHM_CRC_SIZE bytes, and received messages are checked and
+ * passed to the Rx callback without it. Messages failing their check are
+ * counted, passed to the error callback and released, never reaching the Rx
+ * callback. Both sides must protect the channel.
+ *
+ * The trailer is accounted for by ipc_shm_ext_acquire_buf(), so applications
+ * acquire and send payload sizes as usual. The CRC is computed while copying
+ * with ipc_shm_ext_tx_copy() and while copying out in Rx copy-out mode (see
+ * ipc_shm_ext_set_rx_copy()), reading each byte of shared memory once. Zero
+ * copy senders and receivers pay one extra read of the payload in shared
+ * memory. The CRC32C instructions of ARMv8 and SSE4.2 are used when the core
+ * has them. Forwarded messages keep the trailer of the source channel, so
+ * forwarding rules must connect channels of the same mode.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_integrity_enable(const uint8_t instance, int chan_id, bool enable);
+
+/**
+ * ipc_shm_integrity_set_err_cb() - set callback of integrity check failures
+ * @cb:		callback function, NULL to only count failures
+ * @arg:	callback argument
+ *
+ * The callback is called on the Rx thread of the failing channel.
+ */
+void ipc_shm_integrity_set_err_cb(ipc_shm_crc_err_cb cb, void *arg);
+
+/**
+ * ipc_shm_integrity_errors() - get number of integrity check failures
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ *
+ * Return: received messages dropped because of a bad or missing CRC
+ */
+uint64_t ipc_shm_integrity_errors(const uint8_t instance, int chan_id);
+
+/* hooks called by the extended API */
+size_t ipc_integrity_trailer(const uint8_t instance, int chan_id);
+void ipc_integrity_seal(void *buf, size_t size);
+void ipc_integrity_copy_seal(void *buf, const struct iovec *iov, int iovcnt);
+bool ipc_integrity_check(const uint8_t instance, int chan_id, const void *buf,
+		size_t size, void *copy);
+void ipc_integrity_reset(void);
+
+#endif /* IPC_INTEGRITY_H */
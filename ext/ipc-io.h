@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_IO_H
+#define IPC_IO_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Copies to and from shared memory, which may be mapped as device memory
+ * where unaligned accesses fault: each copy is split into naturally aligned
+ * 8, 4, 2 and 1 byte accesses of the shared memory side, never touching bytes
+ * outside the copied range. Also included by the C++ front end.
+ */
+
+/* bytes copied per iteration of the unrolled 8 byte aligned loops */
+#define IPC_IO_BURST 32u
+/* cached bounce buffer of copies between misaligned shared memory buffers */
+#define IPC_IO_BOUNCE 256u
+
+/* largest naturally aligned access at address addr, not longer than len */
+static inline size_t ipc_io_width(uintptr_t addr, size_t len)
+{
+	if (!(addr & 7u) && len >= 8u)
+		return 8u;
+	if (!(addr & 3u) && len >= 4u)
+		return 4u;
+	if (!(addr & 1u) && len >= 2u)
+		return 2u;
+	return 1u;
+}
+
+static inline void ipc_copy_toio(void *dst, const void *src, size_t len)
+{
+	uint8_t *d = (uint8_t *)dst;
+	const uint8_t *s = (const uint8_t *)src;
+	uint64_t v64, burst[IPC_IO_BURST / 8u];
+	uint32_t v32;
+	uint16_t v16;
+	size_t w;
+
+	/* stream whole bursts with independent wide stores */
+	if (!((uintptr_t)d & 7u)) {
+		for (; len >= IPC_IO_BURST; d += w, s += w, len -= w) {
+			w = IPC_IO_BURST;
+			memcpy(burst, s, w);
+			((volatile uint64_t *)d)[0] = burst[0];
+			((volatile uint64_t *)d)[1] = burst[1];
+			((volatile uint64_t *)d)[2] = burst[2];
+			((volatile uint64_t *)d)[3] = burst[3];
+		}
+	}
+
+	for (; len; d += w, s += w, len -= w) {
+		w = ipc_io_width((uintptr_t)d, len);
+		switch (w) {
+		case 8u:
+			memcpy(&v64, s, w);
+			*(volatile uint64_t *)d = v64;
+			break;
+		case 4u:
+			memcpy(&v32, s, w);
+			*(volatile uint32_t *)d = v32;
+			break;
+		case 2u:
+			memcpy(&v16, s, w);
+			*(volatile uint16_t *)d = v16;
+			break;
+		default:
+			*(volatile uint8_t *)d = *s;
+		}
+	}
+}
+
+static inline void ipc_copy_fromio(void *dst, const void *src, size_t len)
+{
+	uint8_t *d = (uint8_t *)dst;
+	const uint8_t *s = (const uint8_t *)src;
+	uint64_t v64, burst[IPC_IO_BURST / 8u];
+	uint32_t v32;
+	uint16_t v16;
+	size_t w;
+
+	/* issue independent wide loads back to back for uncached memory */
+	if (!((uintptr_t)s & 7u)) {
+		for (; len >= IPC_IO_BURST; d += w, s += w, len -= w) {
+			w = IPC_IO_BURST;
+			burst[0] = ((const volatile uint64_t *)s)[0];
+			burst[1] = ((const volatile uint64_t *)s)[1];
+			burst[2] = ((const volatile uint64_t *)s)[2];
+			burst[3] = ((const volatile uint64_t *)s)[3];
+			memcpy(d, burst, w);
+		}
+	}
+
+	for (; len; d += w, s += w, len -= w) {
+		w = ipc_io_width((uintptr_t)s, len);
+		switch (w) {
+		case 8u:
+			v64 = *(const volatile uint64_t *)s;
+			memcpy(d, &v64, w);
+			break;
+		case 4u:
+			v32 = *(const volatile uint32_t *)s;
+			memcpy(d, &v32, w);
+			break;
+		case 2u:
+			v16 = *(const volatile uint16_t *)s;
+			memcpy(d, &v16, w);
+			break;
+		default:
+			*d = *(const volatile uint8_t *)s;
+		}
+	}
+}
+
+/* copy between shared memory buffers, e.g. from one instance to another */
+static inline void ipc_copy_io(void *dst, const void *src, size_t len)
+{
+	volatile uint64_t *d = (volatile uint64_t *)dst;
+	const volatile uint64_t *s = (const volatile uint64_t *)src;
+	uint64_t v0, v1, v2, v3, bounce[IPC_IO_BOUNCE / 8u];
+	size_t w;
+
+	/* all loads of a burst are issued before its stores */
+	if (!(((uintptr_t)d | (uintptr_t)s) & 7u)) {
+		for (; len >= IPC_IO_BURST; len -= IPC_IO_BURST) {
+			v0 = s[0];
+			v1 = s[1];
+			v2 = s[2];
+			v3 = s[3];
+			d[0] = v0;
+			d[1] = v1;
+			d[2] = v2;
+			d[3] = v3;
+			d += 4;
+			s += 4;
+		}
+	}
+
+	/* tail and misaligned buffers go through cached memory */
+	for (; len; len -= w) {
+		w = len < sizeof(bounce) ? len : sizeof(bounce);
+		ipc_copy_fromio(bounce, (const void *)s, w);
+		ipc_copy_toio((void *)d, bounce, w);
+		d = (volatile uint64_t *)((uintptr_t)d + w);
+		s = (const volatile uint64_t *)((uintptr_t)s + w);
+	}
+}
+
+#endif /* IPC_IO_H */
@@ -0,0 +1,280 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <errno.h>
+#include <string.h>
+
+#include "ipc-shm.h"
+#include "ipc-layout.h"
+
+/**
+ * ipc_layout_fit() - choose buffer counts and sizes of a managed channel
+ * @cfg:	managed channel configuration
+ * @start:	offset of the channel
+ * @align:	alignment
+ * @total:	total buffers of the channel modulo descriptors per alignment,
+ *		which sets where the Tx ring ends relative to an alignment
+ *		boundary
+ * @absorb:	size the buffers of the last pool so that the channel ends
+ *		aligned, instead of aligning them
+ * @num_bufs:	buffers of each pool
+ * @buf_size:	buffer size of each pool
+ *
+ * Offsets are only tracked modulo @align until the total is known.
+ *
+ * Return: true if the buffer counts chosen match @total
+ */
+static bool ipc_layout_fit(const struct ipc_shm_managed_cfg *cfg,
+		uint64_t start, uint32_t align, uint32_t total, bool absorb,
+		uint32_t *num_bufs, uint32_t *buf_size)
+{
+	uint32_t per_align = align / IPC_LAYOUT_BD_SIZE;
+	uint32_t sum = 0, n, size, base;
+	uint64_t off;
+	int i;
+
+	off = start + IPC_LAYOUT_RING_SIZE(total);
+	for (i = 0; i < cfg->num_pools; i++) {
+		n = cfg->pools[i].num_bufs;
+		if (!absorb || i < cfg->num_pools - 1) {
+			/* buffers start where the free buffers ring ends */
+			while ((off + IPC_LAYOUT_RING_SIZE(n)) % align)
+				n++;
+			size = IPC_LAYOUT_ALIGN(cfg->pools[i].buf_size, align);
+		} else {
+			while ((sum + n) % per_align != total)
+				n++;
+			base = IPC_LAYOUT_ALIGN(cfg->pools[i].buf_size,
+						IPC_LAYOUT_BUF_ALIGN);
+			for (size = base; size < base + align;
+			     size += IPC_LAYOUT_BUF_ALIGN) {
+				if ((off + IPC_LAYOUT_RING_SIZE(n)
+				     + (uint64_t)n * size) % align == 0)
+					break;
+			}
+			if (size == base + align)
+				return false;
+		}
+
+		num_bufs[i] = n;
+		buf_size[i] = size;
+		sum += n;
+		off += IPC_LAYOUT_RING_SIZE(n) + (uint64_t)n * size;
+	}
+
+	return sum % per_align == total;
+}
+
+/* shared memory size of a managed channel */
+static uint64_t ipc_layout_managed_size(int num_pools,
+		const uint32_t *num_bufs, const uint32_t *buf_size)
+{
+	uint64_t size = 0, bufs = 0;
+	int i;
+
+	for (i = 0; i < num_pools; i++) {
+		size += IPC_LAYOUT_RING_SIZE((uint64_t)num_bufs[i])
+			+ (uint64_t)num_bufs[i] * buf_size[i];
+		bufs += num_bufs[i];
+	}
+
+	return size + IPC_LAYOUT_MANAGED_SIZE(bufs);
+}
+
+static int ipc_layout_plan_managed(const struct ipc_shm_managed_cfg *cfg,
+		uint64_t start, uint32_t align, struct ipc_layout_chan *chan,
+		uint64_t *end)
+{
+	uint32_t num_bufs[IPC_SHM_MAX_POOLS], buf_size[IPC_SHM_MAX_POOLS];
+	uint32_t best_bufs[IPC_SHM_MAX_POOLS], best_size[IPC_SHM_MAX_POOLS];
+	uint64_t size, best = UINT64_MAX, off, bufs = 0;
+	struct ipc_layout_pool *pool;
+	uint32_t total;
+	int i, absorb, err = 0;
+
+	*end = start;
+	if (cfg->num_pools <= 0 || cfg->num_pools > (int)IPC_SHM_MAX_POOLS
+	    || !cfg->pools)
+		return -EINVAL;
+
+	/*
+	 * Aligning every pool is only possible when the channel starts on a 16
+	 * byte boundary, since each buffer adds a descriptor to both the Tx
+	 * ring and its free buffers ring.
+	 */
+	for (absorb = 0; absorb < 2 && best == UINT64_MAX; absorb++) {
+		for (total = 0; total < align / IPC_LAYOUT_BD_SIZE; total++) {
+			if (!ipc_layout_fit(cfg, start, align, total, absorb,
+					    num_bufs, buf_size))
+				continue;
+			size = ipc_layout_managed_size(cfg->num_pools,
+						       num_bufs, buf_size);
+			if (size < best) {
+				best = size;
+				memcpy(best_bufs, num_bufs, sizeof(best_bufs));
+				memcpy(best_size, buf_size, sizeof(best_size));
+			}
+		}
+	}
+	if (best == UINT64_MAX)
+		return -ENOSPC;
+
+	chan->managed = true;
+	chan->num_pools = cfg->num_pools;
+	for (i = 0; i < cfg->num_pools; i++)
+		bufs += best_bufs[i];
+
+	off = start + IPC_LAYOUT_MANAGED_SIZE(bufs);
+	for (i = 0; i < cfg->num_pools; i++) {
+		pool = &chan->pools[i];
+		if (best_bufs[i] > IPC_SHM_MAX_BUFS_PER_POOL)
+			err = -ENOSPC;
+
+		pool->num_bufs = (uint16_t)best_bufs[i];
+		pool->buf_size = best_size[i];
+		pool->ring = (uint32_t)off;
+		off += IPC_LAYOUT_RING_SIZE((uint64_t)best_bufs[i]);
+		pool->bufs = (uint32_t)off;
+		off += (uint64_t)best_bufs[i] * best_size[i];
+		pool->aligned = pool->bufs % align == 0
+				&& pool->buf_size % align == 0;
+	}
+	*end = off;
+
+	return err;
+}
+
+int ipc_layout_plan(const struct ipc_shm_cfg *cfg, uint32_t align,
+		struct ipc_layout *map)
+{
+	const struct ipc_shm_channel_cfg *chan_cfg;
+	const struct ipc_shm_managed_cfg *managed;
+	struct ipc_layout_chan *chan;
+	uint64_t off, end, packed, waste = 0, bufs;
+	uint32_t size;
+	int c, i, err = 0, ret;
+
+	if (!cfg || !map || align < IPC_LAYOUT_BUF_ALIGN
+	    || align > IPC_LAYOUT_MAX_ALIGN || (align & (align - 1u)))
+		return -EINVAL;
+	if (cfg->num_channels <= 0
+	    || cfg->num_channels > (int)IPC_SHM_MAX_CHANNELS)
+		return -EINVAL;
+
+	memset(map, 0, sizeof(*map));
+	map->align = align;
+	map->num_channels = cfg->num_channels;
+	map->shm_size = cfg->shm_size;
+
+	off = IPC_LAYOUT_GLOBAL_SIZE;
+	packed = IPC_LAYOUT_GLOBAL_SIZE;
+	for (c = 0; c < cfg->num_channels; c++) {
+		chan_cfg = &cfg->channels[c];
+		chan = &map->chan[c];
+		chan->start = (uint32_t)off;
+
+		if (chan_cfg->type != IPC_SHM_MANAGED) {
+			/* grow unmanaged memory up to the next channel */
+			size = chan_cfg->ch.unmanaged.size;
+			end = IPC_LAYOUT_ALIGN(off + size, align);
+			chan->size = (uint32_t)(end - off);
+			packed += size;
+			waste += chan->size - size;
+			chan->end = (uint32_t)end;
+			off = end;
+			continue;
+		}
+
+		managed = &chan_cfg->ch.managed;
+		ret = ipc_layout_plan_managed(managed, off, align, chan, &end);
+		if (ret == -EINVAL)
+			return ret;
+		if (ret)
+			err = ret;
+
+		bufs = 0;
+		for (i = 0; i < managed->num_pools; i++) {
+			packed += IPC_LAYOUT_POOL_SIZE(
+				(uint64_t)managed->pools[i].buf_size,
+				managed->pools[i].num_bufs);
+			bufs += managed->pools[i].num_bufs;
+			/* buffers added are usable, their padding is not */
+			waste += (uint64_t)chan->pools[i].num_bufs
+				 * (chan->pools[i].buf_size
+				    - IPC_LAYOUT_ALIGN(
+					managed->pools[i].buf_size,
+					IPC_LAYOUT_BUF_ALIGN));
+		}
+		packed += IPC_LAYOUT_MANAGED_SIZE(bufs);
+		chan->end = (uint32_t)end;
+		off = end;
+	}
+
+	map->packed = (uint32_t)packed;
+	map->used = (uint32_t)off;
+	map->waste = (uint32_t)waste;
+	if (off > cfg->shm_size)
+		err = -ENOSPC;
+
+	return err;
+}
+
+void ipc_layout_apply(const struct ipc_layout *map, int chan_id,
+		struct ipc_shm_channel_cfg *chan,
+		struct ipc_shm_pool_cfg *pools)
+{
+	const struct ipc_layout_chan *lc = &map->chan[chan_id];
+	int i;
+
+	if (!lc->managed) {
+		chan->ch.unmanaged.size = lc->size;
+		return;
+	}
+
+	for (i = 0; i < lc->num_pools; i++) {
+		pools[i].num_bufs = lc->pools[i].num_bufs;
+		pools[i].buf_size = lc->pools[i].buf_size;
+	}
+	chan->ch.managed.pools = pools;
+}
+
+void ipc_layout_print(const struct ipc_layout *map, FILE *f)
+{
+	const struct ipc_layout_chan *chan;
+	const struct ipc_layout_pool *pool;
+	uint32_t bufs;
+	int c, i;
+
+	fprintf(f, "%-10s %10s  %u byte aligned layout\n", "offset", "size",
+		map->align);
+	fprintf(f, "0x%08x %10u  global state\n", 0u, IPC_LAYOUT_GLOBAL_SIZE);
+	for (c = 0; c < map->num_channels; c++) {
+		chan = &map->chan[c];
+		if (!chan->managed) {
+			fprintf(f, "0x%08x %10u  channel %d unmanaged memory\n",
+				chan->start, chan->size, c);
+			continue;
+		}
+
+		bufs = 0;
+		for (i = 0; i < chan->num_pools; i++)
+			bufs += chan->pools[i].num_bufs;
+		fprintf(f, "0x%08x %10u  channel %d Tx ring\n", chan->start,
+			IPC_LAYOUT_MANAGED_SIZE(bufs), c);
+
+		for (i = 0; i < chan->num_pools; i++) {
+			pool = &chan->pools[i];
+			fprintf(f, "0x%08x %10u  channel %d pool %d ring\n",
+				pool->ring, pool->bufs - pool->ring, c, i);
+			fprintf(f, "0x%08x %10u  channel %d pool %d %ux%u%s\n",
+				pool->bufs, pool->num_bufs * pool->buf_size,
+				c, i, pool->num_bufs, pool->buf_size,
+				pool->aligned ? "" : " unaligned");
+		}
+	}
+	fprintf(f, "0x%08x %10s  end\n", map->used, "");
+	fprintf(f, "%u of %u bytes used, %u more than packed, %u of padding\n",
+		map->used, map->shm_size, map->used - map->packed,
+		map->waste);
+}
@@ -0,0 +1,150 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_LAYOUT_H
+#define IPC_LAYOUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ipc-shm.h"
+
+/*
+ * Shared memory footprint model of the driver: each instance starts with a
+ * global state word, followed by the channels in configuration order. Each
+ * managed channel owns a descriptor queue ring for sent buffers and each of
+ * its pools owns a descriptor queue ring for free buffers, followed by the
+ * buffers. A ring holds the queue indices followed by 8 byte descriptors.
+ *
+ * The macros are usable in C constant expressions and C++ constexpr code.
+ */
+#define IPC_LAYOUT_GLOBAL_SIZE		8u
+#define IPC_LAYOUT_RING_HDR_SIZE	8u
+#define IPC_LAYOUT_BD_SIZE		8u
+#define IPC_LAYOUT_BUF_ALIGN		8u
+
+#define IPC_LAYOUT_ALIGN(x, a)		(((x) + (a) - 1u) / (a) * (a))
+
+/* descriptor queue ring holding up to n descriptors */
+#define IPC_LAYOUT_RING_SIZE(n) \
+	(IPC_LAYOUT_RING_HDR_SIZE + ((n) + 1u) * IPC_LAYOUT_BD_SIZE)
+
+/* pool of n buffers of given size, including its free buffers ring */
+#define IPC_LAYOUT_POOL_SIZE(buf_size, n) \
+	(IPC_LAYOUT_RING_SIZE(n) \
+	 + IPC_LAYOUT_ALIGN(buf_size, IPC_LAYOUT_BUF_ALIGN) * (n))
+
+/* managed channel overhead for a total of n buffers in all its pools */
+#define IPC_LAYOUT_MANAGED_SIZE(n)	IPC_LAYOUT_RING_SIZE(n)
+
+/* largest alignment of an aligned layout */
+#define IPC_LAYOUT_MAX_ALIGN		4096u
+
+/**
+ * struct ipc_layout_pool - placement of a buffer pool
+ * @ring:	offset of the free buffers ring
+ * @bufs:	offset of the first buffer
+ * @buf_size:	buffer size given to the driver, distance between buffers
+ * @num_bufs:	number of buffers given to the driver
+ * @aligned:	all buffers start on an alignment boundary
+ */
+struct ipc_layout_pool {
+	uint32_t ring;
+	uint32_t bufs;
+	uint32_t buf_size;
+	uint16_t num_bufs;
+	bool aligned;
+};
+
+/**
+ * struct ipc_layout_chan - placement of a channel
+ * @start:	offset of the channel, i.e. of the Tx ring of a managed channel
+ *		or of the memory of an unmanaged channel
+ * @end:	offset following the channel
+ * @managed:	managed channel
+ * @size:	memory size given to the driver for an unmanaged channel
+ * @num_pools:	number of pools of a managed channel
+ * @pools:	pools of a managed channel
+ */
+struct ipc_layout_chan {
+	uint32_t start;
+	uint32_t end;
+	bool managed;
+	uint32_t size;
+	int num_pools;
+	struct ipc_layout_pool pools[IPC_SHM_MAX_POOLS];
+};
+
+/**
+ * struct ipc_layout - shared memory layout of an instance
+ * @align:		alignment of buffers and channels
+ * @num_channels:	number of channels
+ * @chan:		placement of each channel
+ * @shm_size:		shared memory size of the instance
+ * @packed:		bytes used by the configuration as is
+ * @used:		bytes used by this layout
+ * @waste:		bytes of padding, not counting additional buffers
+ *
+ * Offsets are relative to the start of the local and of the remote shared
+ * memory of the instance, which have the same layout.
+ */
+struct ipc_layout {
+	uint32_t align;
+	int num_channels;
+	struct ipc_layout_chan chan[IPC_SHM_MAX_CHANNELS];
+	uint32_t shm_size;
+	uint32_t packed;
+	uint32_t used;
+	uint32_t waste;
+};
+
+/**
+ * ipc_layout_plan() - plan an aligned shared memory layout of an instance
+ * @cfg:	instance configuration
+ * @align:	alignment in bytes, a power of two from IPC_LAYOUT_BUF_ALIGN
+ *		to IPC_LAYOUT_MAX_ALIGN
+ * @map:	planned layout
+ *
+ * Channels are placed in configuration order, as the driver does, but with
+ * buffer sizes rounded up to @align, unmanaged channel memory grown and the
+ * buffers of each pool increased to the next count at which its free buffers
+ * ring ends on an @align boundary, so that buffers start on bursts and each
+ * channel starts on its own cache line. Buffers are only added, never
+ * removed. The 8 byte global state shifts the first channel, so if it is a
+ * managed channel its last pool stays unaligned and absorbs the shift with a
+ * larger buffer size. Among the candidate buffer counts, the one using the
+ * least memory is kept. With an alignment of IPC_LAYOUT_BUF_ALIGN, the layout
+ * is the one of the configuration as is, with unmanaged memory rounded up to 8
+ * bytes.
+ *
+ * The result only depends on @cfg and @align, so both sides planning with the
+ * same configuration and alignment agree on the layout.
+ *
+ * Return: 0 on success, -EINVAL for an invalid configuration or alignment,
+ *	   -ENOSPC if the layout exceeds shm_size or the buffers of a pool
+ *	   exceed IPC_SHM_MAX_BUFS_PER_POOL (@map is still filled in)
+ */
+int ipc_layout_plan(const struct ipc_shm_cfg *cfg, uint32_t align,
+		struct ipc_layout *map);
+
+/**
+ * ipc_layout_apply() - adjust a channel configuration to a planned layout
+ * @map:	planned layout
+ * @chan_id:	channel index
+ * @chan:	copy of the channel configuration to adjust
+ * @pools:	pool configurations of a managed channel, pointed to by @chan
+ */
+void ipc_layout_apply(const struct ipc_layout *map, int chan_id,
+		struct ipc_shm_channel_cfg *chan,
+		struct ipc_shm_pool_cfg *pools);
+
+/**
+ * ipc_layout_print() - print offset map of a layout
+ * @map:	layout
+ * @f:		output stream
+ */
+void ipc_layout_print(const struct ipc_layout *map, FILE *f);
+
+#endif /* IPC_LAYOUT_H */
@@ -0,0 +1,726 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-log.h"
+
+#define NSEC_PER_SEC		1000000000ull
+#define NSEC_PER_MSEC		1000000ull
+
+/* records of each thread, power of 2 */
+#define IPC_LOG_RING_LEN	256u
+/* arguments and string argument bytes of a record */
+#define IPC_LOG_MAX_ARGS	10u
+#define IPC_LOG_STR_SIZE	96u
+/* conversion specification, e.g. "%-08llx" */
+#define IPC_LOG_SPEC_LEN	32u
+
+#define IPC_LOG_DEFAULT_INTERVAL_MS	1000u
+#define IPC_LOG_DEFAULT_BURST		10u
+
+#ifdef DEBUG
+#define IPC_LOG_DEFAULT_LEVEL	IPC_SHM_LOG_DBG
+#else
+#define IPC_LOG_DEFAULT_LEVEL	IPC_SHM_LOG_ERR
+#endif
+
+/**
+ * struct ipc_log_rec - binary log record
+ * @site:	call site, holding the format
+ * @ts:		time the message was logged
+ * @suppressed:	messages of the site dropped by the rate limit before it
+ * @nargs:	arguments recorded
+ * @trunc:	format has conversions that were not recorded
+ * @args:	integer, pointer and double arguments, and offsets of strings
+ * @str:	string arguments, truncated
+ */
+struct ipc_log_rec {
+	struct ipc_log_site *site;
+	uint64_t ts;
+	uint32_t suppressed;
+	uint8_t nargs;
+	bool trunc;
+	uint64_t args[IPC_LOG_MAX_ARGS];
+	char str[IPC_LOG_STR_SIZE];
+};
+
+/**
+ * struct ipc_log_ring - records of a thread, single producer single consumer
+ * @head:	next record to format, written by the drain
+ * @tail:	next record to write, written by the thread
+ * @dead:	thread exited, ring freed once drained
+ * @next:	next ring of the drain list
+ * @rec:	records
+ */
+struct ipc_log_ring {
+	uint32_t head __attribute__((aligned(64)));
+	uint32_t tail __attribute__((aligned(64)));
+	bool dead;
+	struct ipc_log_ring *next;
+	struct ipc_log_rec rec[IPC_LOG_RING_LEN];
+};
+
+/**
+ * enum ipc_log_len - length modifier of a conversion
+ */
+enum ipc_log_len {
+	IPC_LOG_LEN_NONE,
+	IPC_LOG_LEN_HH,
+	IPC_LOG_LEN_H,
+	IPC_LOG_LEN_L,
+	IPC_LOG_LEN_LL,
+	IPC_LOG_LEN_Z,
+	IPC_LOG_LEN_J,
+	IPC_LOG_LEN_T,
+	IPC_LOG_LEN_LD,
+};
+
+/**
+ * struct ipc_log_spec - conversion specification of a format
+ * @start:	'%' starting the specification
+ * @mod:	length modifier, or conversion if none
+ * @len:	length modifier
+ * @conv:	conversion, 0 if not supported
+ */
+struct ipc_log_spec {
+	const char *start;
+	const char *mod;
+	enum ipc_log_len len;
+	char conv;
+};
+
+/**
+ * struct ipc_log_priv - logger private data
+ * @level:		level per instance and channel
+ * @inst_level:		level of messages of an instance and no channel
+ * @global_level:	level of messages of no instance
+ * @interval_ns:	rate limit interval
+ * @burst:		messages per call site and interval, 0 for no limit
+ * @lost:		messages lost to full rings
+ * @lost_shown:		lost messages reported
+ * @once:		one-time start of the drain thread
+ * @lock:		lock serializing drains and the output
+ * @rings:		rings of all threads, pushed without locking
+ * @key:		frees the ring of exiting threads
+ * @efd:		eventfd the drain thread sleeps on
+ * @drain:		drain thread started
+ */
+static struct ipc_log_priv {
+	uint8_t level[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+	uint8_t inst_level[IPC_SHM_MAX_INSTANCES];
+	uint8_t global_level;
+	uint64_t interval_ns;
+	uint32_t burst;
+	uint64_t lost;
+	uint64_t lost_shown;
+	pthread_once_t once;
+	pthread_mutex_t lock;
+	struct ipc_log_ring *rings;
+	pthread_key_t key;
+	int efd;
+	bool drain;
+} priv = {
+	.level = {
+		[0 ... IPC_SHM_MAX_INSTANCES - 1] = {
+			[0 ... IPC_SHM_MAX_CHANNELS - 1] =
+				IPC_LOG_DEFAULT_LEVEL,
+		},
+	},
+	.inst_level = {
+		[0 ... IPC_SHM_MAX_INSTANCES - 1] = IPC_LOG_DEFAULT_LEVEL,
+	},
+	.global_level = IPC_LOG_DEFAULT_LEVEL,
+	.interval_ns = IPC_LOG_DEFAULT_INTERVAL_MS * NSEC_PER_MSEC,
+	.burst = IPC_LOG_DEFAULT_BURST,
+	.once = PTHREAD_ONCE_INIT,
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static __thread struct ipc_log_ring *ring;
+
+static uint64_t ipc_log_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+/* parse the conversion starting at p, return the character following it */
+static const char *ipc_log_parse(const char *p, struct ipc_log_spec *spec)
+{
+	spec->start = p++;
+	while (*p && strchr("-+ #0'", *p))
+		p++;
+	while (*p >= '0' && *p <= '9')
+		p++;
+	if (*p == '.')
+		for (p++; *p >= '0' && *p <= '9'; p++)
+			;
+
+	spec->mod = p;
+	spec->len = IPC_LOG_LEN_NONE;
+	switch (*p) {
+	case 'h':
+		spec->len = p[1] == 'h' ? IPC_LOG_LEN_HH : IPC_LOG_LEN_H;
+		p += p[1] == 'h' ? 2 : 1;
+		break;
+	case 'l':
+		spec->len = p[1] == 'l' ? IPC_LOG_LEN_LL : IPC_LOG_LEN_L;
+		p += p[1] == 'l' ? 2 : 1;
+		break;
+	case 'z':
+		spec->len = IPC_LOG_LEN_Z;
+		p++;
+		break;
+	case 'j':
+		spec->len = IPC_LOG_LEN_J;
+		p++;
+		break;
+	case 't':
+		spec->len = IPC_LOG_LEN_T;
+		p++;
+		break;
+	case 'L':
+		spec->len = IPC_LOG_LEN_LD;
+		p++;
+		break;
+	}
+
+	/* '*' widths, %n and unknown conversions are not recorded */
+	spec->conv = *p && strchr("diouxXcspfFeEgGaA%", *p) ? *p : 0;
+
+	return *p ? p + 1 : p;
+}
+
+static uint64_t ipc_log_get_int(va_list *ap, enum ipc_log_len len,
+		bool is_signed)
+{
+	switch (len) {
+	case IPC_LOG_LEN_HH:
+		return is_signed ? (uint64_t)(signed char)va_arg(*ap, int)
+				 : (unsigned char)va_arg(*ap, int);
+	case IPC_LOG_LEN_H:
+		return is_signed ? (uint64_t)(short)va_arg(*ap, int)
+				 : (unsigned short)va_arg(*ap, int);
+	case IPC_LOG_LEN_L:
+		return is_signed ? (uint64_t)va_arg(*ap, long)
+				 : va_arg(*ap, unsigned long);
+	case IPC_LOG_LEN_LL:
+		return va_arg(*ap, unsigned long long);
+	case IPC_LOG_LEN_Z:
+		return is_signed ? (uint64_t)va_arg(*ap, ssize_t)
+				 : va_arg(*ap, size_t);
+	case IPC_LOG_LEN_J:
+		return va_arg(*ap, uintmax_t);
+	case IPC_LOG_LEN_T:
+		return (uint64_t)va_arg(*ap, ptrdiff_t);
+	default:
+		return is_signed ? (uint64_t)va_arg(*ap, int)
+				 : va_arg(*ap, unsigned int);
+	}
+}
+
+/* record the arguments of the format, without formatting them */
+static void ipc_log_capture(struct ipc_log_rec *rec, const char *fmt,
+		va_list *ap)
+{
+	struct ipc_log_spec spec;
+	size_t used = 0, n;
+	const char *s;
+	double d;
+
+	rec->nargs = 0;
+	rec->trunc = false;
+	rec->str[IPC_LOG_STR_SIZE - 1u] = '\0';
+
+	while ((fmt = strchr(fmt, '%'))) {
+		fmt = ipc_log_parse(fmt, &spec);
+		if (spec.conv == '%')
+			continue;
+		if (!spec.conv || rec->nargs == IPC_LOG_MAX_ARGS) {
+			rec->trunc = true;
+			return;
+		}
+
+		switch (spec.conv) {
+		case 'd':
+		case 'i':
+			rec->args[rec->nargs] = ipc_log_get_int(ap, spec.len,
+								true);
+			break;
+		case 'c':
+			rec->args[rec->nargs] = va_arg(*ap, int);
+			break;
+		case 'p':
+			rec->args[rec->nargs] = (uintptr_t)va_arg(*ap, void *);
+			break;
+		case 's':
+			s = va_arg(*ap, const char *);
+			if (!s)
+				s = "(null)";
+			if (used >= IPC_LOG_STR_SIZE - 1u) {
+				rec->args[rec->nargs] = IPC_LOG_STR_SIZE - 1u;
+				break;
+			}
+			n = strnlen(s, IPC_LOG_STR_SIZE - 1u - used);
+			memcpy(rec->str + used, s, n);
+			rec->str[used + n] = '\0';
+			rec->args[rec->nargs] = used;
+			used += n + 1u;
+			break;
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			rec->args[rec->nargs] = ipc_log_get_int(ap, spec.len,
+								false);
+			break;
+		default:
+			d = spec.len == IPC_LOG_LEN_LD
+			    ? (double)va_arg(*ap, long double)
+			    : va_arg(*ap, double);
+			memcpy(&rec->args[rec->nargs], &d, sizeof(d));
+			break;
+		}
+		rec->nargs++;
+	}
+}
+
+/* write one conversion of a record, with a length modifier for its width */
+static void ipc_log_put_arg(FILE *out, const struct ipc_log_rec *rec,
+		const struct ipc_log_spec *spec, uint64_t arg)
+{
+	char fmt[IPC_LOG_SPEC_LEN];
+	size_t n = spec->mod - spec->start;
+	double d;
+
+	if (n > IPC_LOG_SPEC_LEN - 4u)
+		n = 1u;
+	memcpy(fmt, spec->start, n);
+
+	switch (spec->conv) {
+	case 'd':
+	case 'i':
+		snprintf(fmt + n, sizeof(fmt) - n, "ll%c", spec->conv);
+		fprintf(out, fmt, (long long)arg);
+		break;
+	case 'o':
+	case 'u':
+	case 'x':
+	case 'X':
+		snprintf(fmt + n, sizeof(fmt) - n, "ll%c", spec->conv);
+		fprintf(out, fmt, (unsigned long long)arg);
+		break;
+	case 'c':
+		snprintf(fmt + n, sizeof(fmt) - n, "c");
+		fprintf(out, fmt, (int)arg);
+		break;
+	case 'p':
+		snprintf(fmt + n, sizeof(fmt) - n, "p");
+		fprintf(out, fmt, (void *)(uintptr_t)arg);
+		break;
+	case 's':
+		snprintf(fmt + n, sizeof(fmt) - n, "s");
+		fprintf(out, fmt, rec->str + arg);
+		break;
+	default:
+		snprintf(fmt + n, sizeof(fmt) - n, "%c", spec->conv);
+		memcpy(&d, &arg, sizeof(d));
+		fprintf(out, fmt, d);
+		break;
+	}
+}
+
+/* format a record the way printf() formats the message */
+static void ipc_log_print(FILE *out, const struct ipc_log_rec *rec)
+{
+	struct ipc_log_site *site = rec->site;
+	const char *fmt = site->fmt, *next;
+	struct ipc_log_spec spec;
+	uint8_t i = 0;
+
+	if (rec->suppressed)
+		fprintf(out, pr_fmt("%u messages suppressed\n"), site->func,
+			rec->suppressed);
+
+	fprintf(out, pr_fmt(""), site->func);
+	while ((next = strchr(fmt, '%'))) {
+		fwrite(fmt, 1, next - fmt, out);
+		fmt = ipc_log_parse(next, &spec);
+		if (spec.conv == '%') {
+			fputc('%', out);
+			continue;
+		}
+		if (i == rec->nargs) {
+			/* conversions not recorded are written as is */
+			fmt = next;
+			break;
+		}
+		ipc_log_put_arg(out, rec, &spec, rec->args[i++]);
+	}
+	fputs(fmt, out);
+}
+
+/* format the records of all threads in time order, return their number */
+static uint32_t ipc_log_drain(FILE *out)
+{
+	struct ipc_log_ring **prev, *r, *first;
+	const struct ipc_log_rec *rec;
+	uint64_t lost, ts = 0;
+	uint32_t n = 0;
+
+	pthread_mutex_lock(&priv.lock);
+	for (;;) {
+		/* order head updates before tail reads, pairs with ipc_log() */
+		smp_mb();
+		first = NULL;
+		for (r = smp_load_acquire(&priv.rings); r; r = r->next) {
+			if (r->head == smp_load_acquire(&r->tail))
+				continue;
+			rec = &r->rec[r->head % IPC_LOG_RING_LEN];
+			if (!first || rec->ts < ts) {
+				first = r;
+				ts = rec->ts;
+			}
+		}
+		if (!first)
+			break;
+
+		ipc_log_print(out, &first->rec[first->head % IPC_LOG_RING_LEN]);
+		smp_store_release(&first->head, first->head + 1u);
+		n++;
+	}
+
+	/*
+	 * free the drained rings of exited threads; threads only push rings
+	 * on the list head, unlinked with a compare and swap, and retried
+	 * further down the list if a ring was pushed meanwhile
+	 */
+	prev = &priv.rings;
+	while ((r = smp_load_acquire(prev))) {
+		if (!smp_load_acquire(&r->dead)
+		    || r->head != smp_load_acquire(&r->tail)) {
+			prev = &r->next;
+			continue;
+		}
+		if (prev != &priv.rings)
+			*prev = r->next;
+		else if (!__atomic_compare_exchange_n(prev, &r, r->next, false,
+						      __ATOMIC_ACQ_REL,
+						      __ATOMIC_ACQUIRE))
+			continue;
+		free(r);
+	}
+
+	lost = __atomic_load_n(&priv.lost, __ATOMIC_RELAXED);
+	if (lost != priv.lost_shown) {
+		fprintf(out, pr_fmt("%llu messages lost\n"), __func__,
+			(unsigned long long)(lost - priv.lost_shown));
+		priv.lost_shown = lost;
+	}
+
+	if (n)
+		fflush(out);
+	pthread_mutex_unlock(&priv.lock);
+
+	return n;
+}
+
+/* wake up the drain thread, without blocking */
+static int ipc_log_wake(void)
+{
+	uint64_t one = 1;
+
+	return write(priv.efd, &one, sizeof(one)) < 0 ? -errno : 0;
+}
+
+static void *ipc_log_drain_thread(void *arg)
+{
+	uint64_t count;
+
+	for (;;) {
+		/* sleep until a thread logs to an empty ring */
+		if (!ipc_log_drain(stdout)
+		    && read(priv.efd, &count, sizeof(count)) < 0
+		    && errno != EINTR)
+			break;
+	}
+
+	return NULL;
+}
+
+static void ipc_log_ring_free(void *arg)
+{
+	ipc_log_ring_put(arg);
+}
+
+static void ipc_log_exit(void)
+{
+	ipc_log_drain(stdout);
+}
+
+/*
+ * Start the drain thread with default scheduling, not inheriting the policy
+ * of the first logging thread, which may be the real-time Rx thread.
+ */
+static void ipc_log_start(void)
+{
+	pthread_attr_t attr;
+	pthread_t thread;
+
+	if (pthread_key_create(&priv.key, ipc_log_ring_free))
+		return;
+
+	priv.efd = eventfd(0, EFD_CLOEXEC);
+	if (priv.efd < 0)
+		return;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	if (!pthread_create(&thread, &attr, ipc_log_drain_thread, NULL)) {
+		atexit(ipc_log_exit);
+		priv.drain = true;
+	} else {
+		close(priv.efd);
+	}
+	pthread_attr_destroy(&attr);
+}
+
+/**
+ * ipc_log_ring_alloc() - allocate a ring for a thread not started yet
+ *
+ * Lets a thread that must not allocate memory or start the drain thread when
+ * it first logs, such as the real-time Rx thread, get its ring from the thread
+ * starting it. The ring is given with ipc_log_ring_attach(), or freed with
+ * ipc_log_ring_put() if the thread doesn't start.
+ *
+ * Return: ring, NULL if records can't be deferred
+ */
+struct ipc_log_ring *ipc_log_ring_alloc(void)
+{
+	struct ipc_log_ring *r;
+
+	pthread_once(&priv.once, ipc_log_start);
+	if (!priv.drain)
+		return NULL;
+
+	r = calloc(1, sizeof(*r));
+	if (!r)
+		return NULL;
+
+	/* never wait for the drain, which holds its lock while writing */
+	r->next = __atomic_load_n(&priv.rings, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&priv.rings, &r->next, r, true,
+					    __ATOMIC_RELEASE,
+					    __ATOMIC_RELAXED))
+		;
+
+	return r;
+}
+
+/**
+ * ipc_log_ring_attach() - make a ring the ring of the calling thread
+ * @r:	ring from ipc_log_ring_alloc(), NULL to log synchronously
+ *
+ * Must be called before the thread logs. The ring is freed once drained
+ * after the thread exits.
+ */
+void ipc_log_ring_attach(struct ipc_log_ring *r)
+{
+	if (!r)
+		return;
+
+	pthread_setspecific(priv.key, r);
+	ring = r;
+}
+
+/**
+ * ipc_log_ring_put() - free a ring once drained
+ * @r:	ring from ipc_log_ring_alloc(), NULL if none
+ */
+void ipc_log_ring_put(struct ipc_log_ring *r)
+{
+	if (!r)
+		return;
+
+	smp_store_release(&r->dead, true);
+	ipc_log_wake();
+}
+
+/* get the ring of the calling thread, NULL if records can't be deferred */
+static struct ipc_log_ring *ipc_log_ring(void)
+{
+	if (!ring)
+		ipc_log_ring_attach(ipc_log_ring_alloc());
+
+	return ring;
+}
+
+static bool ipc_log_enabled(enum ipc_shm_log_level level, int instance,
+		int chan_id)
+{
+	uint8_t max;
+
+	if (instance < 0 || instance >= (int)IPC_SHM_MAX_INSTANCES)
+		max = __atomic_load_n(&priv.global_level, __ATOMIC_RELAXED);
+	else if (chan_id < 0 || chan_id >= (int)IPC_SHM_MAX_CHANNELS)
+		max = __atomic_load_n(&priv.inst_level[instance],
+				      __ATOMIC_RELAXED);
+	else
+		max = __atomic_load_n(&priv.level[instance][chan_id],
+				      __ATOMIC_RELAXED);
+
+	return level <= max;
+}
+
+/* allow a burst of messages per call site and interval */
+static bool ipc_log_ratelimit(struct ipc_log_site *site, uint64_t now)
+{
+	uint32_t burst = __atomic_load_n(&priv.burst, __ATOMIC_RELAXED);
+	uint64_t interval = __atomic_load_n(&priv.interval_ns,
+					    __ATOMIC_RELAXED);
+	uint64_t start;
+
+	if (!burst)
+		return true;
+
+	start = __atomic_load_n(&site->start, __ATOMIC_RELAXED);
+	if (now - start >= interval
+	    && __atomic_compare_exchange_n(&site->start, &start, now, false,
+					   __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		__atomic_store_n(&site->count, 0u, __ATOMIC_RELAXED);
+
+	if (__atomic_fetch_add(&site->count, 1u, __ATOMIC_RELAXED) < burst)
+		return true;
+
+	__atomic_fetch_add(&site->suppressed, 1u, __ATOMIC_RELAXED);
+
+	return false;
+}
+
+int ipc_shm_log_set_level(int instance, int chan_id,
+		enum ipc_shm_log_level level)
+{
+	int i, c;
+
+	if (level > IPC_SHM_LOG_DBG
+	    || instance < IPC_SHM_LOG_ALL
+	    || instance >= (int)IPC_SHM_MAX_INSTANCES
+	    || chan_id < IPC_SHM_LOG_ALL
+	    || chan_id >= (int)IPC_SHM_MAX_CHANNELS
+	    || (instance == IPC_SHM_LOG_ALL && chan_id != IPC_SHM_LOG_ALL))
+		return -EINVAL;
+
+	if (instance == IPC_SHM_LOG_ALL)
+		__atomic_store_n(&priv.global_level, level, __ATOMIC_RELAXED);
+
+	for (i = 0; i < (int)IPC_SHM_MAX_INSTANCES; i++) {
+		if (instance != IPC_SHM_LOG_ALL && i != instance)
+			continue;
+		if (chan_id == IPC_SHM_LOG_ALL)
+			__atomic_store_n(&priv.inst_level[i], level,
+					 __ATOMIC_RELAXED);
+		for (c = 0; c < (int)IPC_SHM_MAX_CHANNELS; c++)
+			if (chan_id == IPC_SHM_LOG_ALL || c == chan_id)
+				__atomic_store_n(&priv.level[i][c], level,
+						 __ATOMIC_RELAXED);
+	}
+
+	return 0;
+}
+
+void ipc_shm_log_set_ratelimit(uint32_t interval_ms, uint32_t burst)
+{
+	__atomic_store_n(&priv.interval_ns, interval_ms * NSEC_PER_MSEC,
+			 __ATOMIC_RELAXED);
+	__atomic_store_n(&priv.burst, burst, __ATOMIC_RELAXED);
+}
+
+void ipc_shm_log_flush(void)
+{
+	ipc_log_drain(stdout);
+}
+
+uint64_t ipc_shm_log_lost(void)
+{
+	return __atomic_load_n(&priv.lost, __ATOMIC_RELAXED);
+}
+
+/**
+ * ipc_log() - record a log message
+ * @site:	call site
+ * @instance:	instance id, IPC_SHM_LOG_ALL if none
+ * @chan_id:	channel index, IPC_SHM_LOG_ALL if none
+ *
+ * The message is printed synchronously if the thread has no ring.
+ */
+void ipc_log(struct ipc_log_site *site, int instance, int chan_id, ...)
+{
+	struct ipc_log_ring *r;
+	struct ipc_log_rec *rec;
+	uint32_t tail, suppressed;
+	uint64_t now;
+	va_list ap;
+
+	if (!ipc_log_enabled(site->level, instance, chan_id))
+		return;
+
+	now = ipc_log_now();
+	if (!ipc_log_ratelimit(site, now))
+		return;
+
+	va_start(ap, chan_id);
+	r = ipc_log_ring();
+	if (!r) {
+		suppressed = __atomic_exchange_n(&site->suppressed, 0u,
+						 __ATOMIC_RELAXED);
+		if (suppressed)
+			printf(pr_fmt("%u messages suppressed\n"), site->func,
+			       suppressed);
+		printf(pr_fmt(""), site->func);
+		vprintf(site->fmt, ap);
+		va_end(ap);
+		return;
+	}
+
+	tail = r->tail;
+	if (tail - smp_load_acquire(&r->head) >= IPC_LOG_RING_LEN) {
+		__atomic_fetch_add(&priv.lost, 1u, __ATOMIC_RELAXED);
+		va_end(ap);
+		return;
+	}
+
+	rec = &r->rec[tail % IPC_LOG_RING_LEN];
+	rec->site = site;
+	rec->ts = now;
+	rec->suppressed = __atomic_exchange_n(&site->suppressed, 0u,
+					      __ATOMIC_RELAXED);
+	ipc_log_capture(rec, site->fmt, &ap);
+	va_end(ap);
+
+	smp_store_release(&r->tail, tail + 1u);
+
+	/*
+	 * wake up the drain if the ring was empty, as it may have found it so
+	 * and gone to sleep; pairs with the barrier in ipc_log_drain()
+	 */
+	smp_mb();
+	if (READ_ONCE(r->head) == tail)
+		ipc_log_wake();
+}
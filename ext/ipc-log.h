@@ -0,0 +1,117 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_LOG_H
+#define IPC_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* instance or channel selecting all instances or channels */
+#define IPC_SHM_LOG_ALL		(-1)
+
+/**
+ * enum ipc_shm_log_level - library log levels
+ * @IPC_SHM_LOG_NONE:	no message
+ * @IPC_SHM_LOG_ERR:	errors only
+ * @IPC_SHM_LOG_DBG:	errors and debug messages
+ */
+enum ipc_shm_log_level {
+	IPC_SHM_LOG_NONE,
+	IPC_SHM_LOG_ERR,
+	IPC_SHM_LOG_DBG,
+};
+
+/**
+ * ipc_shm_log_set_level() - set log level of an instance or channel
+ * @instance:	instance id, IPC_SHM_LOG_ALL for all instances
+ * @chan_id:	channel index, IPC_SHM_LOG_ALL for all channels of @instance
+ * @level:	most verbose level logged
+ *
+ * Library messages are recorded in binary form, format and arguments, to a
+ * lock-free ring of the calling thread and formatted to stdout by a background
+ * thread, so the Rx thread and Tx paths never wait on the output. Messages of
+ * a channel follow the level of that channel, messages of an instance the
+ * level set for all its channels and other messages the level set for all
+ * instances. The default level is IPC_SHM_LOG_ERR, or IPC_SHM_LOG_DBG
+ * when the library is built with DEBUG defined. Levels can be changed at any
+ * time, from any thread.
+ *
+ * Return: 0 on success, -EINVAL for an invalid instance, channel or level
+ */
+int ipc_shm_log_set_level(int instance, int chan_id,
+		enum ipc_shm_log_level level);
+
+/**
+ * ipc_shm_log_set_ratelimit() - set rate limit of each log message
+ * @interval_ms:	rate limit interval
+ * @burst:		messages of each call site logged per interval, 0 for
+ *			no limit
+ *
+ * Messages of a call site beyond the burst are dropped until the interval
+ * ends and counted in the next message logged from that site. The default is
+ * 10 messages per second.
+ */
+void ipc_shm_log_set_ratelimit(uint32_t interval_ms, uint32_t burst);
+
+/**
+ * ipc_shm_log_flush() - write all recorded messages
+ *
+ * Also called at process exit.
+ */
+void ipc_shm_log_flush(void);
+
+/**
+ * ipc_shm_log_lost() - get number of messages lost
+ *
+ * Return: messages dropped because the ring of their thread was full
+ */
+uint64_t ipc_shm_log_lost(void);
+
+/**
+ * struct ipc_log_site - call site of a log message, identifying its format
+ * @fmt:	format string
+ * @func:	calling function
+ * @level:	message level
+ * @start:	start of the current rate limit interval
+ * @count:	messages of the current rate limit interval
+ * @suppressed:	messages dropped by the rate limit since the last one logged
+ */
+struct ipc_log_site {
+	const char *fmt;
+	const char *func;
+	enum ipc_shm_log_level level;
+	uint64_t start;
+	uint32_t count;
+	uint32_t suppressed;
+};
+
+/*
+ * Log a message of a channel, IPC_SHM_LOG_ALL instance and channel for other
+ * messages. Arguments are checked against the format but not formatted by the
+ * caller.
+ */
+#define shm_log(lvl, instance, chan_id, format, ...)			\
+	do {								\
+		static struct ipc_log_site ipc_log_site_ = {		\
+			.fmt = format,					\
+			.func = __func__,				\
+			.level = lvl,					\
+		};							\
+		if (0)							\
+			printf(format, ##__VA_ARGS__);			\
+		ipc_log(&ipc_log_site_, instance, chan_id,		\
+			##__VA_ARGS__);					\
+	} while (0)
+
+/* hooks called by the log macros */
+void ipc_log(struct ipc_log_site *site, int instance, int chan_id, ...);
+
+/* rings of threads that must not allocate them when they first log */
+struct ipc_log_ring;
+struct ipc_log_ring *ipc_log_ring_alloc(void);
+void ipc_log_ring_attach(struct ipc_log_ring *r);
+void ipc_log_ring_put(struct ipc_log_ring *r);
+
+#endif /* IPC_LOG_H */
@@ -0,0 +1,248 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_MSG_H
+#define IPC_MSG_H
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ipc-io.h"
+
+/*
+ * Messages serialized in place in shared memory buffers.
+ *
+ * A message type is described by a schema macro listing its fields in order,
+ * F(msg, type, name) for scalars and V(msg, type, name) for variable length
+ * arrays of type elements:
+ *
+ *	#define SENSOR_MSG(F, V, msg) \
+ *		F(msg, uint32_t, seq) \
+ *		F(msg, uint16_t, kind) \
+ *		V(msg, char, label) \
+ *		V(msg, int32_t, samples)
+ *
+ *	IPC_MSG_DEFINE(sensor_msg, SENSOR_MSG)
+ *
+ * The message starts with a fixed part laid out as the C structure of the
+ * fields, so each field is naturally aligned. Arrays are stored after the
+ * fixed part, each at an 8 byte aligned offset, and the fixed part holds a
+ * struct ipc_msg_ref with their offset and length. IPC_MSG_DEFINE() generates
+ * for each message type:
+ *
+ *	<msg>_build(m, buf, size)	start building in an acquired buffer
+ *	<msg>_open(m, buf, size)	start reading a received buffer
+ *	<msg>_set_<name>(m, v)		store a scalar
+ *	<msg>_get_<name>(m)		load a scalar
+ *	<msg>_add_<name>(m, src, n)	append an array of n elements
+ *	<msg>_len_<name>(m)		number of elements of an array
+ *	<msg>_read_<name>(m, dst, n)	copy out up to n elements of an array
+ *	<msg>_ptr_<name>(m)		array in place, NULL if invalid
+ *
+ * and ipc_msg_size() gives the size to send. All shared memory accesses are
+ * naturally aligned loads and stores, so buffers must be 8 byte aligned, as
+ * pool buffers are. Arrays read in place must only be accessed by element.
+ */
+
+/* alignment of the message and of each array */
+#define IPC_MSG_ALIGN 8u
+
+/**
+ * struct ipc_msg_ref - location of an array in the message
+ * @off:	offset from message start, 0 if the array is not set
+ * @len:	array length in bytes
+ */
+struct ipc_msg_ref {
+	uint32_t off;
+	uint32_t len;
+};
+
+/**
+ * struct ipc_msg - message being built or read
+ * @buf:	shared memory buffer
+ * @size:	buffer size when building, received size when reading
+ * @used:	bytes used by the fixed part and the arrays added so far
+ */
+struct ipc_msg {
+	char *buf;
+	size_t size;
+	size_t used;
+};
+
+static inline size_t ipc_msg_align(size_t n)
+{
+	return (n + IPC_MSG_ALIGN - 1u) & ~(size_t)(IPC_MSG_ALIGN - 1u);
+}
+
+/* size to send after building */
+static inline size_t ipc_msg_size(const struct ipc_msg *m)
+{
+	return m->used;
+}
+
+static inline int ipc_msg_build(struct ipc_msg *m, void *buf, size_t size,
+		size_t fixed_size)
+{
+	size_t off;
+
+	if (!buf || ((uintptr_t)buf & (IPC_MSG_ALIGN - 1u)))
+		return -EINVAL;
+	if (size < ipc_msg_align(fixed_size))
+		return -EMSGSIZE;
+
+	m->buf = buf;
+	m->size = size;
+	m->used = ipc_msg_align(fixed_size);
+
+	/* unset scalars read as 0 and unset arrays as empty */
+	for (off = 0; off < m->used; off += 8u)
+		*(volatile uint64_t *)(m->buf + off) = 0;
+
+	return 0;
+}
+
+static inline int ipc_msg_open(struct ipc_msg *m, const void *buf,
+		size_t size, size_t fixed_size)
+{
+	if (!buf || ((uintptr_t)buf & (IPC_MSG_ALIGN - 1u)))
+		return -EINVAL;
+	if (size < fixed_size)
+		return -EBADMSG;
+
+	m->buf = (char *)buf;
+	m->size = size;
+	m->used = size;
+
+	return 0;
+}
+
+static inline struct ipc_msg_ref ipc_msg_get_ref(const struct ipc_msg *m,
+		size_t ref_off)
+{
+	struct ipc_msg_ref ref;
+
+	ipc_copy_fromio(&ref, m->buf + ref_off, sizeof(ref));
+
+	return ref;
+}
+
+/* append len bytes at the next aligned offset and record them at ref_off */
+static inline int ipc_msg_add(struct ipc_msg *m, size_t ref_off,
+		const void *src, size_t len)
+{
+	struct ipc_msg_ref ref;
+
+	if (len > m->size - m->used || m->used > UINT32_MAX
+	    || len > UINT32_MAX)
+		return -EMSGSIZE;
+
+	ref.off = (uint32_t)m->used;
+	ref.len = (uint32_t)len;
+	ipc_copy_toio(m->buf + ref.off, src, len);
+	ipc_copy_toio(m->buf + ref_off, &ref, sizeof(ref));
+
+	/* the last array may end the buffer unaligned */
+	m->used = ipc_msg_align(m->used + len);
+	if (m->used > m->size)
+		m->used = m->size;
+
+	return 0;
+}
+
+/* array recorded at ref_off, NULL if it is out of the received bytes */
+static inline const void *ipc_msg_ptr(const struct ipc_msg *m, size_t ref_off,
+		uint32_t *len)
+{
+	struct ipc_msg_ref ref = ipc_msg_get_ref(m, ref_off);
+
+	if (ref.off > m->size || ref.len > m->size - ref.off
+	    || (ref.off & (IPC_MSG_ALIGN - 1u)))
+		return NULL;
+
+	*len = ref.len;
+	return m->buf + ref.off;
+}
+
+/* copy out at most size bytes, return array length or -EBADMSG */
+static inline int ipc_msg_read(const struct ipc_msg *m, size_t ref_off,
+		void *dst, size_t size)
+{
+	const void *src;
+	uint32_t len;
+
+	src = ipc_msg_ptr(m, ref_off, &len);
+	if (!src || len > INT32_MAX)
+		return -EBADMSG;
+
+	ipc_copy_fromio(dst, src, len < size ? len : size);
+
+	return (int)len;
+}
+
+#define IPC_MSG_MEMBER(msg, type, name) type name;
+#define IPC_MSG_VMEMBER(msg, type, name) struct ipc_msg_ref name;
+
+#define IPC_MSG_SCALAR(msg, type, name) \
+static inline void msg##_set_##name(struct ipc_msg *m, type v) \
+{ \
+	ipc_copy_toio(m->buf + offsetof(struct msg, name), &v, sizeof(v)); \
+} \
+static inline type msg##_get_##name(const struct ipc_msg *m) \
+{ \
+	type v; \
+	ipc_copy_fromio(&v, m->buf + offsetof(struct msg, name), sizeof(v)); \
+	return v; \
+}
+
+#define IPC_MSG_VECTOR(msg, type, name) \
+static inline int msg##_add_##name(struct ipc_msg *m, const type *src, \
+		size_t n) \
+{ \
+	if (n > SIZE_MAX / sizeof(type)) \
+		return -EMSGSIZE; \
+	return ipc_msg_add(m, offsetof(struct msg, name), src, \
+			   n * sizeof(type)); \
+} \
+static inline size_t msg##_len_##name(const struct ipc_msg *m) \
+{ \
+	return ipc_msg_get_ref(m, offsetof(struct msg, name)).len \
+	       / sizeof(type); \
+} \
+static inline int msg##_read_##name(const struct ipc_msg *m, type *dst, \
+		size_t n) \
+{ \
+	int len = ipc_msg_read(m, offsetof(struct msg, name), dst, \
+			       n * sizeof(type)); \
+	return len < 0 ? len : len / (int)sizeof(type); \
+} \
+static inline const type *msg##_ptr_##name(const struct ipc_msg *m) \
+{ \
+	uint32_t len; \
+	return ipc_msg_ptr(m, offsetof(struct msg, name), &len); \
+}
+
+/**
+ * IPC_MSG_DEFINE() - define a message type and its accessors
+ * @msg:	message type name
+ * @schema:	schema macro of the message fields
+ */
+#define IPC_MSG_DEFINE(msg, schema) \
+struct msg { \
+	schema(IPC_MSG_MEMBER, IPC_MSG_VMEMBER, msg) \
+}; \
+_Static_assert(_Alignof(struct msg) <= IPC_MSG_ALIGN, \
+	       #msg " fields need more than 8 byte alignment"); \
+static inline int msg##_build(struct ipc_msg *m, void *buf, size_t size) \
+{ \
+	return ipc_msg_build(m, buf, size, sizeof(struct msg)); \
+} \
+static inline int msg##_open(struct ipc_msg *m, const void *buf, \
+		size_t size) \
+{ \
+	return ipc_msg_open(m, buf, size, sizeof(struct msg)); \
+} \
+schema(IPC_MSG_SCALAR, IPC_MSG_VECTOR, msg)
+
+#endif /* IPC_MSG_H */
@@ -0,0 +1,387 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-ext.h"
+#include "ipc-prof.h"
+
+#define IPC_PROF_FORMAT_VERSION 1
+
+/**
+ * struct ipc_prof_track - received buffer tracked until released
+ * @buf:	buffer address, 0 for free slots
+ * @pool_id:	pool that fits the received message size
+ */
+struct ipc_prof_track {
+	uintptr_t buf;
+	int pool_id;
+};
+
+/**
+ * struct ipc_prof_chan - profiling data per channel
+ * @tx_size:		histogram of requested Tx message sizes
+ * @rx_size:		histogram of received message sizes
+ * @tx_fail:		number of failed acquire requests
+ * @tx_held:		acquired buffers not yet transmitted
+ * @tx_held_peak:	peak of @tx_held
+ * @rx_in_flight:	received buffers not yet released, per pool
+ * @rx_deferred:	releases applied at the end of current Rx pass, per pool
+ * @rx_peak:		peak of @rx_in_flight, per pool
+ * @rx_occupancy:	histogram of @rx_in_flight seen by each received buffer
+ * @untracked:		received buffers not tracked due to full table
+ * @track_lock:		lock protecting @track
+ * @track:		open addressing table of received buffers
+ *
+ * Each side of a channel allocates from its own pools, so the received
+ * buffers in flight reflect the pool usage of the remote. Configurations are
+ * usually mirrored on both sides, hence they size the local pools as well.
+ */
+struct ipc_prof_chan {
+	uint32_t tx_size[IPC_PROF_SIZE_BUCKETS];
+	uint32_t rx_size[IPC_PROF_SIZE_BUCKETS];
+	uint32_t tx_fail;
+	uint32_t tx_held;
+	uint32_t tx_held_peak;
+	uint32_t rx_in_flight[IPC_SHM_MAX_POOLS];
+	uint32_t rx_deferred[IPC_SHM_MAX_POOLS];
+	uint32_t rx_peak[IPC_SHM_MAX_POOLS];
+	uint32_t rx_occupancy[IPC_SHM_MAX_POOLS][IPC_PROF_MAX_OCCUPANCY + 1u];
+	uint32_t untracked;
+	pthread_mutex_t track_lock;
+	struct ipc_prof_track track[IPC_PROF_TRACK_SLOTS];
+} __attribute__((aligned(IPC_EXT_CACHE_LINE)));
+
+/**
+ * struct ipc_prof_priv - profiling private data
+ * @enabled:	true while profiling
+ * @chan:	profiling data per instance and channel
+ */
+static struct ipc_prof_priv {
+	bool enabled;
+	struct ipc_prof_chan *chan[IPC_SHM_MAX_INSTANCES];
+} priv;
+
+/* set while the Rx thread dispatches buffers, until the end of the pass */
+static __thread bool in_rx_pass;
+
+static struct ipc_prof_chan *ipc_prof_get_chan(const uint8_t instance,
+		int chan_id)
+{
+	if (!__atomic_load_n(&priv.enabled, __ATOMIC_ACQUIRE))
+		return NULL;
+	if (!ipc_ext_get_chan(instance, chan_id))
+		return NULL;
+
+	return &priv.chan[instance][chan_id];
+}
+
+static void ipc_prof_max(uint32_t *peak, uint32_t val)
+{
+	uint32_t old = __atomic_load_n(peak, __ATOMIC_RELAXED);
+
+	while (val > old
+	       && !__atomic_compare_exchange_n(peak, &old, val, true,
+					       __ATOMIC_RELAXED,
+					       __ATOMIC_RELAXED))
+		;
+}
+
+static void ipc_prof_inc(uint32_t *counter)
+{
+	__atomic_fetch_add(counter, 1u, __ATOMIC_RELAXED);
+}
+
+static uint32_t ipc_prof_slot(uintptr_t buf)
+{
+	/* buffers are at least 8 byte aligned */
+	return (uint32_t)((buf >> 3) * 2654435761u) % IPC_PROF_TRACK_SLOTS;
+}
+
+static void ipc_prof_track_add(struct ipc_prof_chan *chan, uintptr_t buf,
+		int pool_id)
+{
+	uint32_t slot = ipc_prof_slot(buf);
+	uint32_t i;
+
+	pthread_mutex_lock(&chan->track_lock);
+	for (i = 0; i < IPC_PROF_TRACK_SLOTS; i++) {
+		if (!chan->track[slot].buf) {
+			chan->track[slot].buf = buf;
+			chan->track[slot].pool_id = pool_id;
+			break;
+		}
+		slot = (slot + 1u) % IPC_PROF_TRACK_SLOTS;
+	}
+	pthread_mutex_unlock(&chan->track_lock);
+
+	if (i == IPC_PROF_TRACK_SLOTS)
+		ipc_prof_inc(&chan->untracked);
+}
+
+static int ipc_prof_track_del(struct ipc_prof_chan *chan, uintptr_t buf)
+{
+	uint32_t slot = ipc_prof_slot(buf);
+	uint32_t next, home;
+	int pool_id = -1;
+	uint32_t i;
+
+	pthread_mutex_lock(&chan->track_lock);
+	for (i = 0; i < IPC_PROF_TRACK_SLOTS && chan->track[slot].buf; i++) {
+		if (chan->track[slot].buf == buf) {
+			pool_id = chan->track[slot].pool_id;
+			break;
+		}
+		slot = (slot + 1u) % IPC_PROF_TRACK_SLOTS;
+	}
+
+	/* backward shift deletion keeps probe sequences unbroken */
+	while (pool_id >= 0) {
+		chan->track[slot].buf = 0;
+		next = slot;
+		do {
+			next = (next + 1u) % IPC_PROF_TRACK_SLOTS;
+			if (!chan->track[next].buf)
+				goto out;
+			home = ipc_prof_slot(chan->track[next].buf);
+		} while ((next > slot) ? (home > slot && home <= next)
+				       : (home > slot || home <= next));
+		chan->track[slot] = chan->track[next];
+		slot = next;
+	}
+out:
+	pthread_mutex_unlock(&chan->track_lock);
+
+	return pool_id;
+}
+
+int ipc_shm_prof_start(void)
+{
+	int num_instances = ipc_ext_num_instances();
+	int i, j;
+
+	if (!num_instances)
+		return -EINVAL;
+
+	__atomic_store_n(&priv.enabled, false, __ATOMIC_RELEASE);
+
+	for (i = 0; i < num_instances; i++) {
+		if (!priv.chan[i]) {
+			/* keep channels in separate cache lines */
+			if (posix_memalign((void **)&priv.chan[i],
+					   IPC_EXT_CACHE_LINE,
+					   IPC_SHM_MAX_CHANNELS
+					   * sizeof(*priv.chan[i]))) {
+				priv.chan[i] = NULL;
+				return -ENOMEM;
+			}
+			memset(priv.chan[i], 0,
+			       IPC_SHM_MAX_CHANNELS * sizeof(*priv.chan[i]));
+			for (j = 0; j < (int)IPC_SHM_MAX_CHANNELS; j++)
+				pthread_mutex_init(&priv.chan[i][j].track_lock,
+						   NULL);
+			continue;
+		}
+
+		for (j = 0; j < (int)IPC_SHM_MAX_CHANNELS; j++) {
+			memset(&priv.chan[i][j], 0,
+			       offsetof(struct ipc_prof_chan, track_lock));
+			memset(priv.chan[i][j].track, 0,
+			       sizeof(priv.chan[i][j].track));
+		}
+	}
+
+	__atomic_store_n(&priv.enabled, true, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+void ipc_shm_prof_stop(void)
+{
+	__atomic_store_n(&priv.enabled, false, __ATOMIC_RELEASE);
+}
+
+void ipc_prof_acquire(const uint8_t instance, int chan_id, size_t size,
+		const void *buf)
+{
+	struct ipc_prof_chan *chan = ipc_prof_get_chan(instance, chan_id);
+
+	if (!chan)
+		return;
+
+	ipc_prof_inc(&chan->tx_size[ipc_prof_size_bucket(size)]);
+	if (!buf) {
+		ipc_prof_inc(&chan->tx_fail);
+		return;
+	}
+
+	ipc_prof_max(&chan->tx_held_peak,
+		     __atomic_add_fetch(&chan->tx_held, 1u, __ATOMIC_RELAXED));
+}
+
+void ipc_prof_tx(const uint8_t instance, int chan_id)
+{
+	struct ipc_prof_chan *chan = ipc_prof_get_chan(instance, chan_id);
+
+	if (chan && __atomic_load_n(&chan->tx_held, __ATOMIC_RELAXED))
+		__atomic_fetch_sub(&chan->tx_held, 1u, __ATOMIC_RELAXED);
+}
+
+void ipc_prof_rx(const uint8_t instance, int chan_id, const void *buf,
+		size_t size)
+{
+	struct ipc_prof_chan *chan = ipc_prof_get_chan(instance, chan_id);
+	struct ipc_ext_chan *ext = ipc_ext_get_chan(instance, chan_id);
+	uint32_t in_flight;
+	int pool_id;
+
+	if (!chan)
+		return;
+
+	pool_id = ipc_sizeclass_lookup(&ext->sc, size);
+	if (pool_id < 0)
+		pool_id = ext->sc.num_pools - 1;
+
+	ipc_prof_inc(&chan->rx_size[ipc_prof_size_bucket(size)]);
+
+	in_flight = __atomic_add_fetch(&chan->rx_in_flight[pool_id], 1u,
+				       __ATOMIC_RELAXED);
+	ipc_prof_max(&chan->rx_peak[pool_id], in_flight);
+	if (in_flight > IPC_PROF_MAX_OCCUPANCY)
+		in_flight = IPC_PROF_MAX_OCCUPANCY;
+	ipc_prof_inc(&chan->rx_occupancy[pool_id][in_flight]);
+
+	ipc_prof_track_add(chan, (uintptr_t)buf, pool_id);
+	in_rx_pass = true;
+}
+
+void ipc_prof_release(const uint8_t instance, int chan_id, const void *buf)
+{
+	struct ipc_prof_chan *chan = ipc_prof_get_chan(instance, chan_id);
+	int pool_id;
+
+	if (!chan)
+		return;
+
+	pool_id = ipc_prof_track_del(chan, (uintptr_t)buf);
+	if (pool_id < 0)
+		return;
+
+	/*
+	 * Buffers dispatched in the same Rx pass were all queued at once, so
+	 * releases from Rx callbacks only count at the end of the pass.
+	 */
+	if (in_rx_pass)
+		ipc_prof_inc(&chan->rx_deferred[pool_id]);
+	else
+		__atomic_fetch_sub(&chan->rx_in_flight[pool_id], 1u,
+				   __ATOMIC_RELAXED);
+}
+
+void ipc_prof_rx_event(const uint8_t instance)
+{
+	struct ipc_prof_chan *chan;
+	uint32_t deferred;
+	int i, j;
+
+	in_rx_pass = false;
+
+	if (!__atomic_load_n(&priv.enabled, __ATOMIC_ACQUIRE))
+		return;
+
+	for (i = 0; i < (int)IPC_SHM_MAX_CHANNELS; i++) {
+		chan = &priv.chan[instance][i];
+		for (j = 0; j < (int)IPC_SHM_MAX_POOLS; j++) {
+			deferred = __atomic_exchange_n(&chan->rx_deferred[j],
+						       0u, __ATOMIC_RELAXED);
+			if (deferred)
+				__atomic_fetch_sub(&chan->rx_in_flight[j],
+						   deferred, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+static void ipc_prof_dump_hist(FILE *file, const char *dir, int instance,
+		int chan_id, const uint32_t *hist)
+{
+	uint32_t i;
+
+	for (i = 0; i < IPC_PROF_SIZE_BUCKETS; i++)
+		if (hist[i])
+			fprintf(file, "size %d %d %s %u %u\n", instance, chan_id,
+				dir, ipc_prof_size_bucket_max(i), hist[i]);
+}
+
+static void ipc_prof_dump_chan(FILE *file, int instance, int chan_id,
+		const struct ipc_shm_channel_cfg *cfg)
+{
+	const struct ipc_prof_chan *chan = &priv.chan[instance][chan_id];
+	const struct ipc_shm_managed_cfg *managed = &cfg->ch.managed;
+	int i, j;
+
+	if (cfg->type != IPC_SHM_MANAGED) {
+		fprintf(file, "chan %d %d unmanaged %u\n", instance, chan_id,
+			cfg->ch.unmanaged.size);
+		return;
+	}
+
+	fprintf(file, "chan %d %d managed %d\n", instance, chan_id,
+		managed->num_pools);
+	for (i = 0; i < managed->num_pools; i++)
+		fprintf(file, "pool %d %d %d %u %u\n", instance, chan_id, i,
+			managed->pools[i].buf_size, managed->pools[i].num_bufs);
+
+	ipc_prof_dump_hist(file, "tx", instance, chan_id, chan->tx_size);
+	ipc_prof_dump_hist(file, "rx", instance, chan_id, chan->rx_size);
+	fprintf(file, "tx %d %d fail %u held_peak %u\n", instance, chan_id,
+		chan->tx_fail, chan->tx_held_peak);
+
+	for (i = 0; i < managed->num_pools; i++) {
+		fprintf(file, "rx %d %d %d peak %u\n", instance, chan_id, i,
+			chan->rx_peak[i]);
+		for (j = 0; j <= (int)IPC_PROF_MAX_OCCUPANCY; j++)
+			if (chan->rx_occupancy[i][j])
+				fprintf(file, "inflight %d %d %d %d %u\n",
+					instance, chan_id, i, j,
+					chan->rx_occupancy[i][j]);
+	}
+
+	if (chan->untracked)
+		shm_err("instance %d channel %d: %u buffers not tracked\n",
+			instance, chan_id, chan->untracked);
+}
+
+int ipc_shm_prof_dump(const char *path)
+{
+	const struct ipc_shm_cfg *cfg;
+	FILE *file;
+	int i, j;
+
+	if (!priv.chan[0] || !ipc_ext_num_instances())
+		return -EINVAL;
+
+	file = fopen(path, "w");
+	if (!file) {
+		shm_err("Can't open %s\n", path);
+		return -EIO;
+	}
+
+	fprintf(file, "ipc-shm-prof %d\n", IPC_PROF_FORMAT_VERSION);
+	for (i = 0; i < ipc_ext_num_instances() && priv.chan[i]; i++) {
+		cfg = ipc_ext_get_cfg(i);
+		fprintf(file, "inst %d shm_size %u channels %d\n", i,
+			cfg->shm_size, cfg->num_channels);
+		for (j = 0; j < cfg->num_channels; j++)
+			ipc_prof_dump_chan(file, i, j, &cfg->channels[j]);
+	}
+
+	if (fclose(file))
+		return -EIO;
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_PROF_H
+#define IPC_PROF_H
+
+#include "ipc-shm.h"
+
+/* number of log-linear message size histogram buckets */
+#define IPC_PROF_SIZE_BUCKETS 128u
+/* largest buffers in flight count recorded individually per pool */
+#define IPC_PROF_MAX_OCCUPANCY 64u
+/* received buffers tracked per channel until released */
+#define IPC_PROF_TRACK_SLOTS 1024u
+
+/**
+ * ipc_shm_prof_start() - reset statistics and start traffic profiling
+ *
+ * Profiling records the message sizes requested and received on each managed
+ * channel and the number of received buffers in flight per pool. Only traffic
+ * going through the extended API (see ipc-shm-ext.h) is recorded.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_prof_start(void);
+
+/**
+ * ipc_shm_prof_stop() - stop traffic profiling
+ */
+void ipc_shm_prof_stop(void);
+
+/**
+ * ipc_shm_prof_dump() - write recorded profile to file
+ * @path:	output file path
+ *
+ * The profile is read by the ipc-shm-advisor tool to recommend a pool
+ * configuration.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_prof_dump(const char *path);
+
+/**
+ * ipc_prof_size_bucket() - get size histogram bucket of a message size
+ * @size:	message size
+ *
+ * Buckets are 8 bytes wide up to 64 bytes and split each power of two in 8
+ * buckets above.
+ */
+static inline uint32_t ipc_prof_size_bucket(size_t size)
+{
+	uint32_t msb, bucket;
+
+	if (size <= 64u)
+		return (uint32_t)(size + 7u) / 8u;
+
+	msb = 31u - (uint32_t)__builtin_clz((uint32_t)(size - 1u));
+	bucket = 9u + (msb - 6u) * 8u
+		 + ((uint32_t)((size - 1u) >> (msb - 3u)) & 7u);
+
+	return bucket < IPC_PROF_SIZE_BUCKETS ?
+		bucket : IPC_PROF_SIZE_BUCKETS - 1u;
+}
+
+/**
+ * ipc_prof_size_bucket_max() - get largest message size of a bucket
+ * @bucket:	size histogram bucket
+ */
+static inline uint32_t ipc_prof_size_bucket_max(uint32_t bucket)
+{
+	if (bucket <= 8u)
+		return bucket * 8u;
+
+	return (9u + (bucket - 9u) % 8u) << (3u + (bucket - 9u) / 8u);
+}
+
+/* hooks called by the extended API */
+void ipc_prof_acquire(const uint8_t instance, int chan_id, size_t size,
+		const void *buf);
+void ipc_prof_tx(const uint8_t instance, int chan_id);
+void ipc_prof_rx(const uint8_t instance, int chan_id, const void *buf,
+		size_t size);
+void ipc_prof_release(const uint8_t instance, int chan_id, const void *buf);
+void ipc_prof_rx_event(const uint8_t instance);
+
+#endif /* IPC_PROF_H */
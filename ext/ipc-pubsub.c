@@ -0,0 +1,374 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-ext.h"
+#include "ipc-pubsub.h"
+
+#define NSEC_PER_SEC		1000000000L
+#define NSEC_PER_MSEC		1000000L
+
+/**
+ * struct ipc_shm_sub - subscriber
+ * @chan:	subscribed channel
+ * @cfg:	subscriber configuration
+ * @lock:	lock protecting the queue and @users
+ * @cond:	signaled when a message is queued or dequeued, on close and
+ *		when the last dispatch ends
+ * @closing:	set when unsubscribing, stops waits on the queue
+ * @users:	messages being dispatched to the subscriber
+ * @head:	index of the oldest queued message
+ * @count:	number of queued messages
+ * @dropped:	messages dropped because the queue was full
+ * @queue:	queued messages, @cfg.depth entries
+ */
+struct ipc_shm_sub {
+	struct ipc_pubsub_chan *chan;
+	struct ipc_shm_sub_cfg cfg;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool closing;
+	uint32_t users;
+	uint32_t head;
+	uint32_t count;
+	uint64_t dropped;
+	struct ipc_shm_msg *queue[];
+};
+
+/**
+ * struct ipc_pubsub_chan - publish/subscribe private data per channel
+ * @sub_lock:	lock protecting subscribers
+ * @num_subs:	number of subscribers
+ * @subs:	subscribers
+ * @saved_rx:	Rx callback of the channel before the first subscriber
+ * @msg_lock:	lock protecting free messages and serializing buffer releases
+ * @free_len:	number of free messages
+ * @free_idx:	free messages
+ * @msg:	messages
+ */
+struct ipc_pubsub_chan {
+	pthread_mutex_t sub_lock;
+	uint32_t num_subs;
+	struct ipc_shm_sub *subs[IPC_PUBSUB_MAX_SUBS];
+	struct ipc_ext_rx saved_rx;
+	pthread_mutex_t msg_lock;
+	uint32_t free_len;
+	uint16_t free_idx[IPC_PUBSUB_MAX_MSGS];
+	struct ipc_shm_msg msg[IPC_PUBSUB_MAX_MSGS];
+} __attribute__((aligned(IPC_EXT_CACHE_LINE)));
+
+/**
+ * struct ipc_pubsub_priv - publish/subscribe private data
+ * @once:	one-time initialization control
+ * @chan:	private data per instance and channel
+ */
+static struct ipc_pubsub_priv {
+	pthread_once_t once;
+	struct ipc_pubsub_chan
+		chan[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+} priv = {
+	.once = PTHREAD_ONCE_INIT,
+};
+
+/* locks taken by the Rx thread and subscriber threads */
+static void ipc_pubsub_mutex_init(pthread_mutex_t *lock)
+{
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	pthread_mutex_init(lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+static void ipc_pubsub_init(void)
+{
+	struct ipc_pubsub_chan *chan;
+	uint32_t i, j, k;
+
+	for (i = 0; i < IPC_SHM_MAX_INSTANCES; i++) {
+		for (j = 0; j < IPC_SHM_MAX_CHANNELS; j++) {
+			chan = &priv.chan[i][j];
+			ipc_pubsub_mutex_init(&chan->sub_lock);
+			ipc_pubsub_mutex_init(&chan->msg_lock);
+			chan->free_len = IPC_PUBSUB_MAX_MSGS;
+			for (k = 0; k < IPC_PUBSUB_MAX_MSGS; k++)
+				chan->free_idx[k] = k;
+		}
+	}
+}
+
+void ipc_shm_msg_get(struct ipc_shm_msg *msg)
+{
+	__atomic_fetch_add(&msg->refs, 1u, __ATOMIC_RELAXED);
+}
+
+void ipc_shm_msg_put(struct ipc_shm_msg *msg)
+{
+	struct ipc_pubsub_chan *chan;
+
+	if (__atomic_sub_fetch(&msg->refs, 1u, __ATOMIC_ACQ_REL))
+		return;
+
+	/* the last reference may be dropped by any subscriber thread */
+	chan = &priv.chan[msg->instance][msg->chan_id];
+	pthread_mutex_lock(&chan->msg_lock);
+	ipc_shm_ext_release_buf(msg->instance, msg->chan_id, msg->buf);
+	chan->free_idx[chan->free_len++] = msg - chan->msg;
+	pthread_mutex_unlock(&chan->msg_lock);
+}
+
+/* give a reference to a subscriber, applying its policy if it is full */
+static void ipc_pubsub_deliver(struct ipc_shm_sub *sub,
+		struct ipc_shm_msg *msg)
+{
+	struct ipc_shm_msg *old = NULL, *refused = NULL;
+
+	ipc_shm_msg_get(msg);
+	if (sub->cfg.cb) {
+		sub->cfg.cb(sub->cfg.cb_arg, msg);
+		return;
+	}
+
+	pthread_mutex_lock(&sub->lock);
+	if (sub->count == sub->cfg.depth) {
+		if (sub->cfg.policy == IPC_SHM_SUB_DROP_OLDEST) {
+			old = sub->queue[sub->head];
+			sub->head = (sub->head + 1u) % sub->cfg.depth;
+			sub->count--;
+			sub->dropped++;
+		}
+		while (sub->count == sub->cfg.depth && !sub->closing)
+			pthread_cond_wait(&sub->cond, &sub->lock);
+	}
+
+	if (sub->closing) {
+		refused = msg;
+	} else {
+		sub->queue[(sub->head + sub->count) % sub->cfg.depth] = msg;
+		sub->count++;
+		pthread_cond_broadcast(&sub->cond);
+	}
+	pthread_mutex_unlock(&sub->lock);
+
+	if (old)
+		ipc_shm_msg_put(old);
+	if (refused)
+		ipc_shm_msg_put(refused);
+}
+
+/* end a dispatch, letting an unsubscribe waiting for it free the subscriber */
+static void ipc_pubsub_sub_done(struct ipc_shm_sub *sub)
+{
+	pthread_mutex_lock(&sub->lock);
+	if (!--sub->users)
+		pthread_cond_broadcast(&sub->cond);
+	pthread_mutex_unlock(&sub->lock);
+}
+
+/* subscribed channels Rx callback: pass the buffer to all subscribers */
+static void ipc_pubsub_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size)
+{
+	struct ipc_shm_sub *subs[IPC_PUBSUB_MAX_SUBS];
+	struct ipc_pubsub_chan *chan = arg;
+	struct ipc_shm_msg *msg;
+	uint32_t i, n;
+
+	pthread_mutex_lock(&chan->msg_lock);
+	if (!chan->free_len) {
+		shm_dbg_ch(instance, chan_id,
+			   "All messages of channel %d referenced\n", chan_id);
+		ipc_shm_ext_release_buf(instance, chan_id, buf);
+		pthread_mutex_unlock(&chan->msg_lock);
+		return;
+	}
+	msg = &chan->msg[chan->free_idx[--chan->free_len]];
+	pthread_mutex_unlock(&chan->msg_lock);
+
+	msg->buf = buf;
+	msg->size = size;
+	msg->instance = instance;
+	msg->chan_id = chan_id;
+	msg->refs = 1u;
+
+	pthread_mutex_lock(&chan->sub_lock);
+	n = chan->num_subs;
+	for (i = 0; i < n; i++) {
+		subs[i] = chan->subs[i];
+		pthread_mutex_lock(&subs[i]->lock);
+		subs[i]->users++;
+		pthread_mutex_unlock(&subs[i]->lock);
+	}
+	pthread_mutex_unlock(&chan->sub_lock);
+
+	/* waits on backpressure don't hold back (un)subscribing */
+	for (i = 0; i < n; i++) {
+		ipc_pubsub_deliver(subs[i], msg);
+		ipc_pubsub_sub_done(subs[i]);
+	}
+
+	/* drop the reference held while dispatching */
+	ipc_shm_msg_put(msg);
+}
+
+struct ipc_shm_sub *ipc_shm_subscribe(const uint8_t instance, int chan_id,
+		const struct ipc_shm_sub_cfg *cfg)
+{
+	struct ipc_ext_chan *ext_chan = ipc_ext_get_chan(instance, chan_id);
+	struct ipc_pubsub_chan *chan;
+	pthread_condattr_t attr;
+	struct ipc_shm_sub *sub;
+	uint32_t depth;
+
+	if (!ext_chan || !ext_chan->managed || !cfg)
+		return NULL;
+	if (!cfg->cb && !cfg->depth)
+		return NULL;
+
+	pthread_once(&priv.once, ipc_pubsub_init);
+	chan = &priv.chan[instance][chan_id];
+
+	depth = cfg->cb ? 0u : cfg->depth;
+	sub = calloc(1, sizeof(*sub) + depth * sizeof(sub->queue[0]));
+	if (!sub)
+		return NULL;
+
+	sub->chan = chan;
+	sub->cfg = *cfg;
+	sub->cfg.depth = depth;
+	ipc_pubsub_mutex_init(&sub->lock);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&sub->cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	pthread_mutex_lock(&chan->sub_lock);
+	if (chan->num_subs == IPC_PUBSUB_MAX_SUBS) {
+		pthread_mutex_unlock(&chan->sub_lock);
+		shm_err("Too many subscribers on channel %d\n", chan_id);
+		goto err_free;
+	}
+
+	/* subscribers keep buffers, not copies reused by the next message */
+	if (!chan->num_subs
+	    && ipc_shm_ext_hold_rx(instance, chan_id, ipc_pubsub_rx_cb, chan,
+				   &chan->saved_rx.cb, &chan->saved_rx.arg)) {
+		pthread_mutex_unlock(&chan->sub_lock);
+		shm_err("Can't subscribe to channel %d, held or copied out\n",
+			chan_id);
+		goto err_free;
+	}
+	chan->subs[chan->num_subs++] = sub;
+	pthread_mutex_unlock(&chan->sub_lock);
+
+	return sub;
+
+err_free:
+	pthread_cond_destroy(&sub->cond);
+	pthread_mutex_destroy(&sub->lock);
+	free(sub);
+	return NULL;
+}
+
+void ipc_shm_unsubscribe(struct ipc_shm_sub *sub)
+{
+	struct ipc_pubsub_chan *chan;
+	uint8_t instance;
+	int chan_id;
+	uint32_t i;
+
+	if (!sub)
+		return;
+	chan = sub->chan;
+
+	pthread_mutex_lock(&chan->sub_lock);
+	for (i = 0; i < chan->num_subs; i++) {
+		if (chan->subs[i] == sub) {
+			chan->subs[i] = chan->subs[--chan->num_subs];
+			break;
+		}
+	}
+	if (!chan->num_subs) {
+		instance = (chan - &priv.chan[0][0]) / IPC_SHM_MAX_CHANNELS;
+		chan_id = (chan - &priv.chan[0][0]) % IPC_SHM_MAX_CHANNELS;
+		ipc_shm_ext_unhold_rx(instance, chan_id, chan->saved_rx.cb,
+				      chan->saved_rx.arg);
+	}
+	pthread_mutex_unlock(&chan->sub_lock);
+
+	/* release an Rx thread waiting for room and wait for its dispatch */
+	pthread_mutex_lock(&sub->lock);
+	sub->closing = true;
+	pthread_cond_broadcast(&sub->cond);
+	while (sub->users)
+		pthread_cond_wait(&sub->cond, &sub->lock);
+	pthread_mutex_unlock(&sub->lock);
+
+	for (; sub->count; sub->count--) {
+		ipc_shm_msg_put(sub->queue[sub->head]);
+		sub->head = (sub->head + 1u) % sub->cfg.depth;
+	}
+
+	pthread_cond_destroy(&sub->cond);
+	pthread_mutex_destroy(&sub->lock);
+	free(sub);
+}
+
+struct ipc_shm_msg *ipc_shm_sub_recv(struct ipc_shm_sub *sub, int timeout_ms)
+{
+	struct ipc_shm_msg *msg = NULL;
+	struct timespec deadline;
+	int err = 0;
+
+	if (!sub || sub->cfg.cb)
+		return NULL;
+
+	if (timeout_ms > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += timeout_ms / 1000;
+		deadline.tv_nsec += (long)(timeout_ms % 1000) * NSEC_PER_MSEC;
+		if (deadline.tv_nsec >= NSEC_PER_SEC) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= NSEC_PER_SEC;
+		}
+	}
+
+	pthread_mutex_lock(&sub->lock);
+	while (!sub->count && timeout_ms && !sub->closing && !err) {
+		if (timeout_ms < 0)
+			pthread_cond_wait(&sub->cond, &sub->lock);
+		else
+			err = pthread_cond_timedwait(&sub->cond, &sub->lock,
+						     &deadline);
+	}
+
+	if (sub->count) {
+		msg = sub->queue[sub->head];
+		sub->head = (sub->head + 1u) % sub->cfg.depth;
+		sub->count--;
+		/* make room for a message waiting on backpressure */
+		pthread_cond_broadcast(&sub->cond);
+	}
+	pthread_mutex_unlock(&sub->lock);
+
+	return msg;
+}
+
+uint64_t ipc_shm_sub_dropped(struct ipc_shm_sub *sub)
+{
+	uint64_t dropped;
+
+	pthread_mutex_lock(&sub->lock);
+	dropped = sub->dropped;
+	pthread_mutex_unlock(&sub->lock);
+
+	return dropped;
+}
@@ -0,0 +1,126 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_PUBSUB_H
+#define IPC_PUBSUB_H
+
+#include "ipc-shm.h"
+
+/* subscribers per channel */
+#define IPC_PUBSUB_MAX_SUBS	8u
+/* received messages referenced by subscribers per channel */
+#define IPC_PUBSUB_MAX_MSGS	128u
+
+/**
+ * struct ipc_shm_msg - received message shared by subscribers
+ * @buf:	buffer in shared memory, read-only for subscribers
+ * @size:	message size
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @refs:	reference count, private to the library
+ *
+ * The buffer goes back to the remote when the last reference is dropped with
+ * ipc_shm_msg_put().
+ */
+struct ipc_shm_msg {
+	const void *buf;
+	size_t size;
+	uint8_t instance;
+	int chan_id;
+	uint32_t refs;
+};
+
+/* policy applied to a full subscriber queue */
+enum ipc_shm_sub_policy {
+	IPC_SHM_SUB_DROP_OLDEST,	/* drop the oldest queued message */
+	IPC_SHM_SUB_BACKPRESSURE,	/* stall reception until room is made */
+};
+
+/* subscriber callback, called on the Rx thread with a reference to put */
+typedef void (*ipc_shm_sub_cb)(void *arg, struct ipc_shm_msg *msg);
+
+/**
+ * struct ipc_shm_sub_cfg - subscriber configuration
+ * @cb:		callback subscriber function, NULL for a queue subscriber
+ * @cb_arg:	callback argument
+ * @depth:	queue subscriber capacity, in messages
+ * @policy:	queue subscriber policy when full
+ */
+struct ipc_shm_sub_cfg {
+	ipc_shm_sub_cb cb;
+	void *cb_arg;
+	uint32_t depth;
+	enum ipc_shm_sub_policy policy;
+};
+
+struct ipc_shm_sub;
+
+/**
+ * ipc_shm_subscribe() - receive messages of a managed channel
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ * @cfg:	subscriber configuration
+ *
+ * Each message received on the channel is passed to all its subscribers
+ * without copy, each getting its own reference to the same buffer. Callback
+ * subscribers are called on the Rx thread and must put their reference, not
+ * necessarily before returning. Queue subscribers are served by their own
+ * threads with ipc_shm_sub_recv(); when the queue is full, the oldest message
+ * is dropped or, with backpressure, the Rx thread waits for room, stalling
+ * reception on the whole instance.
+ *
+ * The first subscriber holds the channel Rx callback (see
+ * ipc_shm_ext_hold_rx()), which the application gets back when the last one
+ * unsubscribes. Channels already held, e.g. claimed by a broker client, in Rx
+ * copy-out mode or compressed (see ipc_shm_compress_enable()) can't be
+ * subscribed, and both modes are refused while the channel is subscribed.
+ *
+ * Return: subscriber handle, NULL on error
+ */
+struct ipc_shm_sub *ipc_shm_subscribe(const uint8_t instance, int chan_id,
+		const struct ipc_shm_sub_cfg *cfg);
+
+/**
+ * ipc_shm_unsubscribe() - stop receiving messages and free the subscriber
+ * @sub:	subscriber handle
+ *
+ * Messages still queued are put. A thread waiting in ipc_shm_sub_recv()
+ * must have returned before the subscriber is freed. Waits for a message
+ * being passed to the subscriber, so it must not be called from a subscriber
+ * callback.
+ */
+void ipc_shm_unsubscribe(struct ipc_shm_sub *sub);
+
+/**
+ * ipc_shm_sub_recv() - get next message of a queue subscriber
+ * @sub:	subscriber handle
+ * @timeout_ms:	maximum wait time in ms, 0 to not wait, negative to wait forever
+ *
+ * Return: message reference to put, NULL on timeout
+ */
+struct ipc_shm_msg *ipc_shm_sub_recv(struct ipc_shm_sub *sub, int timeout_ms);
+
+/**
+ * ipc_shm_sub_dropped() - get number of messages dropped for a subscriber
+ * @sub:	subscriber handle
+ *
+ * Return: messages dropped because the subscriber queue was full
+ */
+uint64_t ipc_shm_sub_dropped(struct ipc_shm_sub *sub);
+
+/**
+ * ipc_shm_msg_get() - take an additional reference to a message
+ * @msg:	message
+ */
+void ipc_shm_msg_get(struct ipc_shm_msg *msg);
+
+/**
+ * ipc_shm_msg_put() - drop a reference to a message
+ * @msg:	message
+ *
+ * Can be called from any thread; the last reference releases the buffer.
+ */
+void ipc_shm_msg_put(struct ipc_shm_msg *msg);
+
+#endif /* IPC_PUBSUB_H */
@@ -0,0 +1,466 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <pthread.h>
+#include <time.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-io.h"
+#include "ipc-rpc.h"
+
+#define IPC_RPC_SLOT_MASK	(IPC_RPC_MAX_CALLS - 1u)
+/* generation in upper bits of correlation ids, never 0 */
+#define IPC_RPC_MAX_GEN		(UINT32_MAX / IPC_RPC_MAX_CALLS)
+
+/* call slot states, correlation ids of issued calls are above these */
+#define IPC_RPC_FREE		0u
+#define IPC_RPC_BUSY		1u
+
+/* synchronous calls check for timeouts at least this often */
+#define IPC_RPC_POLL_NS		1000000L
+
+#define NSEC_PER_SEC		1000000000L
+#define NSEC_PER_MSEC		1000000L
+
+/**
+ * struct ipc_rpc_call - outstanding call slot
+ * @tag:	correlation id of the call or slot state
+ * @gen:	generation of the last call issued in this slot
+ * @deadline:	reply deadline in ns of CLOCK_MONOTONIC, 0 if none
+ * @cb:		completion callback
+ * @arg:	completion callback argument
+ *
+ * A slot is owned by whoever moves @tag to IPC_RPC_BUSY: the caller while
+ * setting up the call, then either the Rx callback for the reply or the
+ * thread detecting the timeout, so a call completes exactly once.
+ */
+struct ipc_rpc_call {
+	uint32_t tag;
+	uint32_t gen;
+	uint64_t deadline;
+	ipc_shm_rpc_cb cb;
+	void *arg;
+};
+
+/**
+ * struct ipc_rpc_inst - RPC private data per instance
+ * @ready:	true while serving calls
+ * @num_chans:	number of channels carrying calls
+ * @chan_ids:	channels carrying calls
+ * @saved_rx:	Rx callbacks of the channels before serving calls
+ * @next_chan:	channel selection counter
+ * @next_call:	call slot allocation hint
+ * @pending:	number of outstanding calls
+ * @call:	outstanding call slots
+ */
+struct ipc_rpc_inst {
+	bool ready;
+	int num_chans;
+	int chan_ids[IPC_SHM_MAX_CHANNELS];
+	struct {
+		ipc_shm_rx_cb cb;
+		void *arg;
+	} saved_rx[IPC_SHM_MAX_CHANNELS];
+	uint32_t next_chan;
+	uint32_t next_call;
+	uint32_t pending;
+	struct ipc_rpc_call call[IPC_RPC_MAX_CALLS];
+};
+
+/**
+ * struct ipc_rpc_sync - synchronous call completion
+ * @reply:	reply payload destination
+ * @cap:	reply destination size
+ * @size:	reply payload size copied
+ * @err:	call result
+ * @done:	set once the call completed
+ */
+struct ipc_rpc_sync {
+	void *reply;
+	size_t cap;
+	size_t size;
+	int err;
+	uint32_t done;
+};
+
+/**
+ * struct ipc_rpc_priv - RPC private data
+ * @once:	one-time initialization control
+ * @inst:	private data per instance
+ */
+static struct ipc_rpc_priv {
+	pthread_once_t once;
+	struct ipc_rpc_inst inst[IPC_SHM_MAX_INSTANCES];
+} priv = {
+	.once = PTHREAD_ONCE_INIT,
+};
+
+static uint64_t ipc_rpc_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/* reserve a free call slot, -1 if all calls are outstanding */
+static int ipc_rpc_alloc(struct ipc_rpc_inst *rpc)
+{
+	uint32_t hint, idx, i, tag;
+
+	hint = __atomic_fetch_add(&rpc->next_call, 1u, __ATOMIC_RELAXED);
+	for (i = 0; i < IPC_RPC_MAX_CALLS; i++) {
+		idx = (hint + i) & IPC_RPC_SLOT_MASK;
+		tag = IPC_RPC_FREE;
+		if (__atomic_load_n(&rpc->call[idx].tag, __ATOMIC_RELAXED)
+		    != IPC_RPC_FREE)
+			continue;
+		if (__atomic_compare_exchange_n(&rpc->call[idx].tag, &tag,
+						IPC_RPC_BUSY, false,
+						__ATOMIC_ACQUIRE,
+						__ATOMIC_RELAXED)) {
+			__atomic_fetch_add(&rpc->pending, 1u,
+					   __ATOMIC_RELAXED);
+			return idx;
+		}
+	}
+
+	return -1;
+}
+
+static void ipc_rpc_put(struct ipc_rpc_inst *rpc, struct ipc_rpc_call *call)
+{
+	__atomic_fetch_sub(&rpc->pending, 1u, __ATOMIC_RELAXED);
+	__atomic_store_n(&call->tag, IPC_RPC_FREE, __ATOMIC_RELEASE);
+}
+
+/* take ownership of an issued call */
+static bool ipc_rpc_claim(struct ipc_rpc_call *call, uint32_t tag)
+{
+	return __atomic_compare_exchange_n(&call->tag, &tag, IPC_RPC_BUSY,
+					   false, __ATOMIC_ACQUIRE,
+					   __ATOMIC_RELAXED);
+}
+
+/* complete an issued call, false if it was already completed */
+static bool ipc_rpc_complete(struct ipc_rpc_inst *rpc,
+		struct ipc_rpc_call *call, uint32_t tag, int err,
+		const void *reply, size_t size)
+{
+	ipc_shm_rpc_cb cb;
+	void *arg;
+
+	if (!ipc_rpc_claim(call, tag))
+		return false;
+
+	cb = call->cb;
+	arg = call->arg;
+	ipc_rpc_put(rpc, call);
+
+	if (err)
+		cb(arg, err, NULL, 0);
+	else
+		cb(arg, 0, reply, size);
+
+	return true;
+}
+
+static void ipc_rpc_expire(struct ipc_rpc_inst *rpc)
+{
+	struct ipc_rpc_call *call;
+	uint64_t now, deadline;
+	uint32_t idx, tag;
+
+	if (!__atomic_load_n(&rpc->pending, __ATOMIC_RELAXED))
+		return;
+
+	now = ipc_rpc_now_ns();
+	for (idx = 0; idx < IPC_RPC_MAX_CALLS; idx++) {
+		call = &rpc->call[idx];
+		tag = __atomic_load_n(&call->tag, __ATOMIC_ACQUIRE);
+		if (tag < IPC_RPC_MAX_CALLS)
+			continue;
+
+		/* a newer call's deadline is harmless, the claim fails */
+		deadline = __atomic_load_n(&call->deadline, __ATOMIC_RELAXED);
+		if (deadline && now >= deadline)
+			ipc_rpc_complete(rpc, call, tag, -ETIMEDOUT, NULL, 0);
+	}
+}
+
+/* managed channels Rx callback: match reply with outstanding call */
+static void ipc_rpc_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size)
+{
+	struct ipc_rpc_inst *rpc = &priv.inst[instance];
+	struct ipc_rpc_hdr hdr;
+	struct ipc_rpc_call *call;
+	int err;
+
+	if (size < sizeof(hdr)) {
+		shm_err_ch(instance, chan_id,
+			   "short RPC message on channel %d\n", chan_id);
+		goto out;
+	}
+
+	ipc_copy_fromio(&hdr, buf, sizeof(hdr));
+	call = &rpc->call[hdr.corr_id & IPC_RPC_SLOT_MASK];
+	if (hdr.corr_id < IPC_RPC_MAX_CALLS
+	    || !ipc_rpc_complete(rpc, call, hdr.corr_id, hdr.status,
+				 (char *)buf + sizeof(hdr),
+				 size - sizeof(hdr))) {
+		/* late reply of a timed out or cancelled call */
+		shm_dbg_ch(instance, chan_id,
+			   "dropping stale reply %u on channel %d\n",
+			   hdr.corr_id, chan_id);
+	}
+
+out:
+	err = ipc_shm_ext_release_buf(instance, chan_id, buf);
+	if (err)
+		shm_err_ch(instance, chan_id,
+			   "failed to release buffer of channel %d\n", chan_id);
+}
+
+/* Rx event hook: complete timed out calls */
+static void ipc_rpc_rx_event(const uint8_t instance)
+{
+	struct ipc_rpc_inst *rpc = &priv.inst[instance];
+
+	if (__atomic_load_n(&rpc->ready, __ATOMIC_ACQUIRE))
+		ipc_rpc_expire(rpc);
+}
+
+static void ipc_rpc_init_once(void)
+{
+	if (ipc_os_add_rx_event_hook(ipc_rpc_rx_event))
+		shm_err("can't register Rx event hook\n");
+}
+
+int ipc_shm_rpc_init(const uint8_t instance, const int *chan_ids,
+		int num_chans)
+{
+	struct ipc_rpc_inst *rpc;
+	int i, err;
+
+	if (instance >= IPC_SHM_MAX_INSTANCES || !chan_ids)
+		return -EINVAL;
+	if (num_chans <= 0 || num_chans > (int)IPC_SHM_MAX_CHANNELS)
+		return -EINVAL;
+
+	rpc = &priv.inst[instance];
+	if (rpc->ready)
+		return -EINVAL;
+
+	pthread_once(&priv.once, ipc_rpc_init_once);
+
+	for (i = 0; i < num_chans; i++) {
+		err = ipc_shm_ext_get_rx_cb(instance, chan_ids[i],
+					    &rpc->saved_rx[i].cb,
+					    &rpc->saved_rx[i].arg);
+		if (!err)
+			err = ipc_shm_ext_set_rx_cb(instance, chan_ids[i],
+						    ipc_rpc_rx_cb, NULL);
+		if (err) {
+			shm_err("can't serve RPC on channel %d\n",
+				chan_ids[i]);
+			goto err_restore;
+		}
+		rpc->chan_ids[i] = chan_ids[i];
+	}
+	rpc->num_chans = num_chans;
+
+	__atomic_store_n(&rpc->ready, true, __ATOMIC_RELEASE);
+
+	return 0;
+
+err_restore:
+	while (i--)
+		ipc_shm_ext_set_rx_cb(instance, rpc->chan_ids[i],
+				      rpc->saved_rx[i].cb,
+				      rpc->saved_rx[i].arg);
+	return err;
+}
+
+void ipc_shm_rpc_free(const uint8_t instance)
+{
+	struct ipc_rpc_inst *rpc;
+	uint32_t idx, tag;
+	int i;
+
+	if (instance >= IPC_SHM_MAX_INSTANCES)
+		return;
+
+	rpc = &priv.inst[instance];
+	if (!__atomic_exchange_n(&rpc->ready, false, __ATOMIC_ACQ_REL))
+		return;
+
+	/* replies arriving from now on go to the previous callbacks */
+	for (i = 0; i < rpc->num_chans; i++)
+		if (ipc_shm_ext_set_rx_cb(instance, rpc->chan_ids[i],
+					  rpc->saved_rx[i].cb,
+					  rpc->saved_rx[i].arg))
+			shm_err("can't restore Rx callback of channel %d\n",
+				rpc->chan_ids[i]);
+	rpc->num_chans = 0;
+
+	for (idx = 0; idx < IPC_RPC_MAX_CALLS; idx++) {
+		tag = __atomic_load_n(&rpc->call[idx].tag, __ATOMIC_ACQUIRE);
+		if (tag >= IPC_RPC_MAX_CALLS)
+			ipc_rpc_complete(rpc, &rpc->call[idx], tag,
+					 -ECANCELED, NULL, 0);
+	}
+}
+
+/* acquire a buffer on the first channel with one free, round robin */
+static void *ipc_rpc_acquire_buf(const uint8_t instance,
+		struct ipc_rpc_inst *rpc, size_t size, int *chan_id)
+{
+	uint32_t first;
+	void *buf;
+	int i;
+
+	first = __atomic_fetch_add(&rpc->next_chan, 1u, __ATOMIC_RELAXED);
+	for (i = 0; i < rpc->num_chans; i++) {
+		*chan_id = rpc->chan_ids[(first + i) % rpc->num_chans];
+		buf = ipc_shm_ext_acquire_buf(instance, *chan_id, size);
+		if (buf)
+			return buf;
+	}
+
+	return NULL;
+}
+
+int ipc_shm_rpc_call_async(const uint8_t instance, uint16_t method,
+		const void *req, size_t size, int timeout_ms,
+		ipc_shm_rpc_cb cb, void *arg)
+{
+	struct ipc_rpc_inst *rpc;
+	struct ipc_rpc_call *call;
+	struct ipc_rpc_hdr hdr;
+	size_t msg_size = sizeof(hdr) + size;
+	uint64_t deadline;
+	int idx, chan_id, err;
+	void *buf;
+
+	if (instance >= IPC_SHM_MAX_INSTANCES || !cb || (size && !req))
+		return -EINVAL;
+
+	rpc = &priv.inst[instance];
+	if (!__atomic_load_n(&rpc->ready, __ATOMIC_ACQUIRE))
+		return -EINVAL;
+
+	idx = ipc_rpc_alloc(rpc);
+	if (idx < 0)
+		return -EBUSY;
+	call = &rpc->call[idx];
+
+	buf = ipc_rpc_acquire_buf(instance, rpc, msg_size, &chan_id);
+	if (!buf) {
+		ipc_rpc_put(rpc, call);
+		return -ENOMEM;
+	}
+
+	call->gen = call->gen % IPC_RPC_MAX_GEN + 1u;
+	call->cb = cb;
+	call->arg = arg;
+	deadline = 0;
+	if (timeout_ms >= 0)
+		deadline = ipc_rpc_now_ns()
+			   + (uint64_t)timeout_ms * NSEC_PER_MSEC;
+	__atomic_store_n(&call->deadline, deadline, __ATOMIC_RELAXED);
+
+	hdr.corr_id = call->gen * IPC_RPC_MAX_CALLS + idx;
+	hdr.method = method;
+	hdr.status = 0;
+	ipc_copy_toio(buf, &hdr, sizeof(hdr));
+	ipc_copy_toio((char *)buf + sizeof(hdr), req, size);
+
+	/* publish before sending, the reply may arrive right away */
+	__atomic_store_n(&call->tag, hdr.corr_id, __ATOMIC_RELEASE);
+
+	err = ipc_shm_ext_tx(instance, chan_id, buf, msg_size);
+	if (err) {
+		ipc_shm_ext_discard_buf(instance, chan_id, buf, msg_size);
+		/* unless it already timed out, the call was never issued */
+		if (!ipc_rpc_claim(call, hdr.corr_id))
+			return 0;
+		ipc_rpc_put(rpc, call);
+		return err;
+	}
+
+	return 0;
+}
+
+static void ipc_rpc_sync_cb(void *arg, int err, const void *reply,
+		size_t size)
+{
+	struct ipc_rpc_sync *sync = arg;
+
+	if (!err && size > sync->cap) {
+		err = -EMSGSIZE;
+		size = sync->cap;
+	}
+	if (reply)
+		ipc_copy_fromio(sync->reply, reply, size);
+
+	sync->size = reply ? size : 0;
+	sync->err = err;
+	__atomic_store_n(&sync->done, 1u, __ATOMIC_RELEASE);
+}
+
+int ipc_shm_rpc_call(const uint8_t instance, uint16_t method,
+		const void *req, size_t size, void *reply, size_t *reply_size,
+		int timeout_ms)
+{
+	struct ipc_rpc_sync sync = {0};
+	struct timespec wake;
+	uint32_t seq;
+	int err;
+
+	if (!reply_size || (*reply_size && !reply))
+		return -EINVAL;
+
+	sync.reply = reply;
+	sync.cap = *reply_size;
+
+	err = ipc_shm_rpc_call_async(instance, method, req, size, timeout_ms,
+				     ipc_rpc_sync_cb, &sync);
+	if (err)
+		return err;
+
+	while (1) {
+		/* sample event sequence before checking to not miss a wakeup */
+		seq = ipc_os_rx_event_seq(instance);
+		if (__atomic_load_n(&sync.done, __ATOMIC_ACQUIRE))
+			break;
+
+		ipc_rpc_expire(&priv.inst[instance]);
+		if (__atomic_load_n(&sync.done, __ATOMIC_ACQUIRE))
+			break;
+
+		clock_gettime(CLOCK_MONOTONIC, &wake);
+		wake.tv_nsec += IPC_RPC_POLL_NS;
+		if (wake.tv_nsec >= NSEC_PER_SEC) {
+			wake.tv_sec++;
+			wake.tv_nsec -= NSEC_PER_SEC;
+		}
+		ipc_os_rx_event_wait(instance, seq, &wake);
+	}
+
+	*reply_size = sync.size;
+
+	return sync.err;
+}
+
+void ipc_shm_rpc_poll(const uint8_t instance)
+{
+	if (instance >= IPC_SHM_MAX_INSTANCES)
+		return;
+
+	ipc_rpc_expire(&priv.inst[instance]);
+}
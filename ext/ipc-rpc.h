@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_RPC_H
+#define IPC_RPC_H
+
+#include "ipc-shm.h"
+
+/* maximum number of outstanding calls per instance (power of 2) */
+#define IPC_RPC_MAX_CALLS	256u
+
+/**
+ * struct ipc_rpc_hdr - header of RPC requests and replies
+ * @corr_id:	correlation id, copied by the remote from request to reply
+ * @method:	method id, copied by the remote from request to reply
+ * @status:	0 for requests and successful replies, negative error code
+ *		of a failed call otherwise
+ *
+ * The header is at the start of the buffer, followed by the payload.
+ */
+struct ipc_rpc_hdr {
+	uint32_t corr_id;
+	uint16_t method;
+	int16_t status;
+};
+
+/**
+ * typedef ipc_shm_rpc_cb - RPC completion callback
+ * @arg:	callback argument
+ * @err:	0 on success, -ETIMEDOUT, -ECANCELED or the reply status
+ * @reply:	reply payload in shared memory, NULL on error
+ * @size:	reply payload size
+ *
+ * Called exactly once for each issued call, from the Rx thread or from the
+ * thread detecting the timeout. The reply buffer is released after return.
+ */
+typedef void (*ipc_shm_rpc_cb)(void *arg, int err, const void *reply,
+		size_t size);
+
+/**
+ * ipc_shm_rpc_init() - serve RPC calls of an instance over managed channels
+ * @instance:	instance id
+ * @chan_ids:	managed channels carrying requests and replies
+ * @num_chans:	number of channels
+ *
+ * Takes over the Rx callback of the given channels (see
+ * ipc_shm_ext_set_rx_cb()) until ipc_shm_rpc_free(). Calls are spread over the
+ * channels and replies are matched by correlation id, so they may arrive in
+ * any order on any of them. Must be called after ipc_shm_ext_init(). On
+ * failure the channels keep their Rx callbacks.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_rpc_init(const uint8_t instance, const int *chan_ids,
+		int num_chans);
+
+/**
+ * ipc_shm_rpc_free() - cancel outstanding calls and stop serving RPC calls
+ * @instance:	instance id
+ *
+ * Gives the channels back the Rx callbacks they had before ipc_shm_rpc_init(),
+ * then outstanding calls complete with -ECANCELED.
+ */
+void ipc_shm_rpc_free(const uint8_t instance);
+
+/**
+ * ipc_shm_rpc_call_async() - issue a call without waiting for the reply
+ * @instance:	instance id
+ * @method:	method id
+ * @req:	request payload
+ * @size:	request payload size
+ * @timeout_ms:	reply timeout in ms, negative to wait forever
+ * @cb:		completion callback
+ * @arg:	completion callback argument
+ *
+ * Timeouts are detected after each Rx softirq pass, by synchronous calls and
+ * by ipc_shm_rpc_poll().
+ *
+ * Return: 0 if the call was issued, -EBUSY if IPC_RPC_MAX_CALLS calls are
+ *	   outstanding, -ENOMEM if no buffer is free, error code otherwise
+ */
+int ipc_shm_rpc_call_async(const uint8_t instance, uint16_t method,
+		const void *req, size_t size, int timeout_ms,
+		ipc_shm_rpc_cb cb, void *arg);
+
+/**
+ * ipc_shm_rpc_call() - issue a call and wait for the reply
+ * @instance:	instance id
+ * @method:	method id
+ * @req:	request payload
+ * @size:	request payload size
+ * @reply:	reply payload destination
+ * @reply_size:	reply destination size as input, reply payload size as output
+ * @timeout_ms:	reply timeout in ms, negative to wait forever
+ *
+ * Return: 0 on success, -EMSGSIZE if the reply was truncated, -ETIMEDOUT,
+ *	   the reply status or error code otherwise
+ */
+int ipc_shm_rpc_call(const uint8_t instance, uint16_t method,
+		const void *req, size_t size, void *reply, size_t *reply_size,
+		int timeout_ms);
+
+/**
+ * ipc_shm_rpc_poll() - complete timed out calls
+ * @instance:	instance id
+ */
+void ipc_shm_rpc_poll(const uint8_t instance);
+
+#endif /* IPC_RPC_H */
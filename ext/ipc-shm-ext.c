@@ -0,0 +1,883 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <stdlib.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-sizeclass.h"
+#include "ipc-ext.h"
+#include "ipc-io.h"
+#include "ipc-prof.h"
+#include "ipc-capture.h"
+#include "ipc-fwd.h"
+#include "ipc-integrity.h"
+#include "ipc-compress.h"
+#include "ipc-watchdog.h"
+
+/**
+ * struct ipc_ext_priv - user-space extensions private data
+ * @ready:		true after successful initialization
+ * @num_instances:	number of initialized instances
+ * @cfg:		application configuration of each instance
+ * @shm_cfg:		configuration passed to the driver for each instance
+ * @channels:		channels configuration passed to the driver
+ * @pools:		pools configuration passed to the driver with an aligned
+ *			layout
+ * @layout:		aligned layout of each instance
+ * @chan:		private data per instance and channel
+ *
+ * The driver is given a copy of the application configuration where managed
+ * channels Rx callbacks are replaced with ipc_ext_rx_cb(), so that received
+ * buffers go through the extensions before reaching the application, and pools
+ * and unmanaged memory are adjusted to the aligned layout if one is set.
+ */
+static struct ipc_ext_priv {
+	bool ready;
+	uint8_t num_instances;
+	const struct ipc_shm_cfg *cfg[IPC_SHM_MAX_INSTANCES];
+	struct ipc_shm_cfg shm_cfg[IPC_SHM_MAX_INSTANCES];
+	struct ipc_shm_channel_cfg
+		channels[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+	struct ipc_shm_pool_cfg pools[IPC_SHM_MAX_INSTANCES]
+		[IPC_SHM_MAX_CHANNELS][IPC_SHM_MAX_POOLS];
+	struct ipc_layout layout[IPC_SHM_MAX_INSTANCES];
+	struct ipc_ext_chan chan[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+} priv;
+
+/* alignment of the layout of the next initialization, 0 for none */
+static uint32_t layout_align;
+
+struct ipc_ext_chan *ipc_ext_get_chan(const uint8_t instance, int chan_id)
+{
+	if (!priv.ready || instance >= priv.num_instances)
+		return NULL;
+	if (chan_id < 0 || chan_id >= priv.cfg[instance]->num_channels)
+		return NULL;
+
+	return &priv.chan[instance][chan_id];
+}
+
+const struct ipc_shm_cfg *ipc_ext_get_cfg(const uint8_t instance)
+{
+	if (!priv.ready || instance >= priv.num_instances)
+		return NULL;
+
+	return priv.cfg[instance];
+}
+
+int ipc_ext_num_instances(void)
+{
+	return priv.ready ? priv.num_instances : 0;
+}
+
+/**
+ * struct ipc_ext_arena - cached copy of received buffers of an Rx thread
+ * @buf:	copy destination, aligned to the cache line
+ * @size:	copy destination size
+ *
+ * Grown to the largest pool of the channels received in copy-out mode and
+ * freed when the thread exits. Messages of compressed channels are staged in
+ * a second arena and decompressed to the first one. The copy delivered by the
+ * watchdog deferred thread is tracked as a third one, owned by the watchdog.
+ */
+static __thread struct ipc_ext_arena {
+	void *buf;
+	size_t size;
+} arena, stage, deferred;
+
+static pthread_key_t arena_key;
+static pthread_once_t arena_once = PTHREAD_ONCE_INIT;
+
+/* called on thread exit, while the thread arenas are still reachable */
+static void ipc_ext_arena_free(void *unused)
+{
+	free(arena.buf);
+	free(stage.buf);
+}
+
+static void ipc_ext_arena_key_init(void)
+{
+	if (pthread_key_create(&arena_key, ipc_ext_arena_free))
+		shm_err("can't free Rx copy buffers on thread exit\n");
+}
+
+/* get an arena to copy a received buffer to, NULL if it can't grow */
+static void *ipc_ext_rx_arena(struct ipc_ext_arena *a,
+		struct ipc_ext_chan *chan, size_t size)
+{
+	size_t arena_size;
+	void *copy;
+
+	if (size > a->size) {
+		arena_size = chan->sc.max_size;
+		if (arena_size < size)
+			arena_size = size;
+		arena_size = (arena_size + IPC_EXT_CACHE_LINE - 1u)
+			     & ~(size_t)(IPC_EXT_CACHE_LINE - 1u);
+		if (posix_memalign(&copy, IPC_EXT_CACHE_LINE, arena_size))
+			return NULL;
+
+		pthread_once(&arena_once, ipc_ext_arena_key_init);
+		pthread_setspecific(arena_key, &arena);
+		free(a->buf);
+		a->buf = copy;
+		a->size = arena_size;
+	}
+
+	return a->buf;
+}
+
+static bool ipc_ext_in_arena(const struct ipc_ext_arena *a, const void *buf)
+{
+	const char *p = buf;
+
+	return a->buf && p >= (const char *)a->buf
+	       && p < (const char *)a->buf + a->size;
+}
+
+static bool ipc_ext_is_rx_copy(const void *buf)
+{
+	return ipc_ext_in_arena(&arena, buf) || ipc_ext_in_arena(&stage, buf)
+	       || ipc_ext_in_arena(&deferred, buf);
+}
+
+/* decompress a staged message if needed, NULL if malformed */
+static void *ipc_ext_rx_unzip(struct ipc_ext_chan *chan,
+		const uint8_t instance, int chan_id, void *msg, size_t *size)
+{
+	size_t orig;
+	void *out;
+	int ret;
+
+	ret = ipc_compress_parse(instance, chan_id, msg, size, &orig);
+	if (ret <= 0)
+		return ret ? NULL : msg;
+
+	out = ipc_ext_rx_arena(&arena, chan, orig);
+	if (!out) {
+		shm_err_ch(instance, chan_id,
+			   "can't decompress message of channel %d\n", chan_id);
+		return NULL;
+	}
+
+	if (ipc_compress_rx(instance, chan_id, msg, *size, out, orig))
+		return NULL;
+	*size = orig;
+
+	return out;
+}
+
+/* call the application Rx callback, timed by the watchdog */
+static void ipc_ext_rx_call(struct ipc_ext_chan *chan, const uint8_t instance,
+		int chan_id, void *buf, size_t size)
+{
+	struct ipc_ext_rx *rx;
+	uint64_t start;
+
+	rx = &chan->rx[__atomic_load_n(&chan->rx_sel, __ATOMIC_ACQUIRE)];
+	start = ipc_watchdog_start(instance, chan_id);
+	rx->cb(rx->arg, instance, chan_id, buf, size);
+	ipc_watchdog_end(instance, chan_id, start);
+}
+
+void ipc_ext_rx_deliver(const uint8_t instance, int chan_id, void *buf,
+		size_t size, bool copy)
+{
+	if (copy) {
+		deferred.buf = buf;
+		deferred.size = size;
+	}
+
+	ipc_ext_rx_call(&priv.chan[instance][chan_id], instance, chan_id, buf,
+			size);
+
+	deferred.buf = NULL;
+	deferred.size = 0;
+}
+
+/* managed channels Rx callback: run extensions and call application */
+static void ipc_ext_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size)
+{
+	struct ipc_ext_chan *chan = &priv.chan[instance][chan_id];
+	void *copy = NULL;
+	bool zip;
+
+	ipc_prof_rx(instance, chan_id, buf, size);
+	ipc_capture_commit(ipc_capture_rec(IPC_CAPTURE_RX, instance, chan_id,
+					   buf, size), true);
+
+	if (ipc_fwd_rx(instance, chan_id, buf, size))
+		return;
+
+	/* on allocation failure the shared memory buffer is passed instead */
+	zip = ipc_compress_trailer(instance, chan_id);
+	if (zip) {
+		copy = ipc_ext_rx_arena(&stage, chan, size);
+		if (!copy) {
+			shm_err_ch(instance, chan_id,
+				   "can't stage message of channel %d\n",
+				   chan_id);
+			ipc_shm_ext_release_buf(instance, chan_id, buf);
+			return;
+		}
+	} else if (__atomic_load_n(&chan->rx_copy, __ATOMIC_RELAXED)) {
+		copy = ipc_ext_rx_arena(&arena, chan, size);
+	}
+
+	/* the payload is checked while copied out, if it is */
+	if (ipc_integrity_trailer(instance, chan_id)) {
+		if (!ipc_integrity_check(instance, chan_id, buf, size, copy)) {
+			ipc_shm_ext_release_buf(instance, chan_id, buf);
+			return;
+		}
+		size -= IPC_SHM_CRC_SIZE;
+	} else if (copy) {
+		ipc_copy_fromio(copy, buf, size);
+	}
+
+	if (copy) {
+		ipc_shm_ext_release_buf(instance, chan_id, buf);
+		buf = copy;
+	}
+
+	if (zip) {
+		buf = ipc_ext_rx_unzip(chan, instance, chan_id, buf, &size);
+		if (!buf)
+			return;
+	}
+
+	/* channels demoted by the watchdog are delivered by its thread */
+	if (ipc_watchdog_defer(instance, chan_id, buf, size, copy != NULL))
+		return;
+
+	ipc_ext_rx_call(chan, instance, chan_id, buf, size);
+}
+
+/* called after each Rx softirq pass */
+static void ipc_ext_rx_event(const uint8_t instance)
+{
+	if (instance < priv.num_instances)
+		ipc_prof_rx_event(instance);
+
+	ipc_fwd_rx_event(instance);
+}
+
+static int ipc_ext_init_instance(const uint8_t instance,
+		const struct ipc_shm_cfg *cfg)
+{
+	struct ipc_shm_channel_cfg *chan_cfg;
+	struct ipc_ext_chan *chan;
+	struct ipc_layout *layout;
+	int i, err;
+
+	if (cfg->num_channels <= 0
+	    || cfg->num_channels > (int)IPC_SHM_MAX_CHANNELS)
+		return -EINVAL;
+
+	priv.cfg[instance] = cfg;
+	priv.shm_cfg[instance] = *cfg;
+	priv.shm_cfg[instance].channels = priv.channels[instance];
+
+	if (layout_align) {
+		layout = &priv.layout[instance];
+		err = ipc_layout_plan(cfg, layout_align, layout);
+		if (err) {
+			shm_err("instance %d: no %u byte layout fits\n",
+				instance, layout_align);
+			return err;
+		}
+		shm_dbg("instance %d layout: %u/%u bytes, %u padding\n",
+			instance, layout->used, layout->shm_size,
+			layout->waste);
+	}
+
+	for (i = 0; i < cfg->num_channels; i++) {
+		chan_cfg = &priv.channels[instance][i];
+		*chan_cfg = cfg->channels[i];
+		chan = &priv.chan[instance][i];
+		if (layout_align)
+			ipc_layout_apply(&priv.layout[instance], i, chan_cfg,
+					 priv.pools[instance][i]);
+
+		chan->instance = instance;
+		chan->chan_id = i;
+		chan->managed = (chan_cfg->type == IPC_SHM_MANAGED);
+		if (!chan->managed)
+			continue;
+
+		err = ipc_sizeclass_init(&chan->sc, &chan_cfg->ch.managed);
+		if (err) {
+			shm_err("invalid pools for instance %d channel %d\n",
+				instance, i);
+			return err;
+		}
+
+		pthread_mutex_init(&chan->hold_lock, NULL);
+		pthread_mutex_init(&chan->stash_lock, NULL);
+
+		chan->rx[0].cb = chan_cfg->ch.managed.rx_cb;
+		chan->rx[0].arg = chan_cfg->ch.managed.cb_arg;
+		if (!chan->rx[0].cb)
+			return -EINVAL;
+		chan_cfg->ch.managed.rx_cb = ipc_ext_rx_cb;
+	}
+
+	return 0;
+}
+
+int ipc_shm_ext_init(const struct ipc_shm_instances_cfg *cfg)
+{
+	struct ipc_shm_instances_cfg ext_cfg;
+	int i, err;
+
+	if (!cfg || cfg->num_instances == 0
+	    || cfg->num_instances > IPC_SHM_MAX_INSTANCES)
+		return -EINVAL;
+
+	memset(&priv, 0, sizeof(priv));
+	ipc_fwd_reset();
+	ipc_integrity_reset();
+	ipc_compress_reset();
+	ipc_watchdog_reset();
+
+	/* validate configuration before touching shared memory */
+	for (i = 0; i < cfg->num_instances; i++) {
+		err = ipc_ext_init_instance(i, &cfg->shm_cfg[i]);
+		if (err)
+			return err;
+	}
+	priv.num_instances = cfg->num_instances;
+
+	err = ipc_os_add_rx_event_hook(ipc_ext_rx_event);
+	if (err)
+		return err;
+
+	/* extensions must be ready before the first Rx callback */
+	priv.ready = true;
+
+	ext_cfg.num_instances = cfg->num_instances;
+	ext_cfg.shm_cfg = priv.shm_cfg;
+	err = ipc_shm_init(&ext_cfg);
+	if (err) {
+		priv.ready = false;
+		ipc_os_del_rx_event_hook(ipc_ext_rx_event);
+		return err;
+	}
+
+	return 0;
+}
+
+void ipc_shm_ext_free(void)
+{
+	/* release buffers still queued while the driver is up */
+	ipc_watchdog_stop();
+	ipc_shm_free();
+	ipc_os_del_rx_event_hook(ipc_ext_rx_event);
+	priv.ready = false;
+}
+
+int ipc_shm_ext_set_layout(uint32_t align)
+{
+	if (align && (align < IPC_LAYOUT_BUF_ALIGN
+		      || align > IPC_LAYOUT_MAX_ALIGN
+		      || (align & (align - 1u))))
+		return -EINVAL;
+
+	layout_align = align;
+
+	return 0;
+}
+
+int ipc_shm_ext_get_layout(const uint8_t instance, struct ipc_layout *map)
+{
+	if (!priv.ready || instance >= priv.num_instances || !map)
+		return -EINVAL;
+	if (!priv.layout[instance].align)
+		return -EINVAL;
+
+	*map = priv.layout[instance];
+
+	return 0;
+}
+
+/* reuse a discarded buffer from the first pool that fits */
+static void *ipc_ext_stash_get(struct ipc_ext_chan *chan, int pool_id)
+{
+	void *buf = NULL;
+
+	pthread_mutex_lock(&chan->stash_lock);
+	for (; pool_id < chan->sc.num_pools; pool_id++) {
+		if (chan->stash_len[pool_id]) {
+			buf = chan->stash[pool_id][--chan->stash_len[pool_id]];
+			__atomic_store_n(&chan->stash_count,
+					 chan->stash_count - 1u,
+					 __ATOMIC_RELAXED);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&chan->stash_lock);
+
+	return buf;
+}
+
+/* acquire a buffer from pool_id or the next pools, NULL if none is free */
+static void *ipc_ext_acquire_pool(struct ipc_ext_chan *chan, int pool_id,
+		size_t size, bool probe)
+{
+	uint8_t instance = chan->instance;
+	int chan_id = chan->chan_id;
+	uint32_t seq;
+	void *buf;
+
+	if (__atomic_load_n(&chan->stash_count, __ATOMIC_RELAXED)) {
+		buf = ipc_ext_stash_get(chan, pool_id);
+		if (buf)
+			goto out;
+	}
+
+	seq = ipc_os_rx_event_seq(instance);
+	if (!probe)
+		pool_id = ipc_sizeclass_next_pool(&chan->sc, pool_id, seq);
+	if (pool_id < 0) {
+		buf = NULL;
+		goto out;
+	}
+
+	/*
+	 * Requesting the pool buffer size makes the driver skip the smaller
+	 * pools without probing their free buffer queues in shared memory.
+	 */
+	buf = ipc_shm_acquire_buf(instance, chan_id,
+				  chan->sc.buf_size[pool_id]);
+	if (!buf)
+		ipc_sizeclass_set_empty(&chan->sc, pool_id, seq);
+
+out:
+	ipc_prof_acquire(instance, chan_id, size, buf);
+
+	return buf;
+}
+
+/**
+ * ipc_ext_acquire_buf() - acquire a buffer of exactly size bytes or more
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @size:	required size, integrity trailer included
+ * @probe:	probe all fitting pools, ignoring the exhaustion hints, for
+ *		retries that don't wait for an Rx event
+ *
+ * Return: buffer pointer, NULL if no buffer is free
+ */
+void *ipc_ext_acquire_buf(const uint8_t instance, int chan_id, size_t size,
+		bool probe)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+	int pool_id;
+
+	if (!chan || !chan->managed)
+		return ipc_shm_acquire_buf(instance, chan_id, size);
+
+	pool_id = ipc_sizeclass_lookup(&chan->sc, size);
+	if (pool_id < 0) {
+		ipc_prof_acquire(instance, chan_id, size, NULL);
+		return NULL;
+	}
+
+	return ipc_ext_acquire_pool(chan, pool_id, size, probe);
+}
+
+/**
+ * ipc_ext_trailer() - get size of the trailers appended to payloads
+ * @instance:	instance id
+ * @chan_id:	channel index
+ *
+ * Return: trailers size, 0 if the channel has none
+ */
+size_t ipc_ext_trailer(const uint8_t instance, int chan_id)
+{
+	return ipc_compress_trailer(instance, chan_id)
+	       + ipc_integrity_trailer(instance, chan_id);
+}
+
+/**
+ * ipc_ext_update_trailer() - cache the trailers size of a channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ *
+ * Called when enabling or disabling a trailer, for the calls of resolved
+ * channels.
+ */
+void ipc_ext_update_trailer(const uint8_t instance, int chan_id)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+
+	if (!chan)
+		return;
+
+	/* computed after the last update of either trailer */
+	pthread_mutex_lock(&chan->hold_lock);
+	__atomic_store_n(&chan->trailer, ipc_ext_trailer(instance, chan_id),
+			 __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&chan->hold_lock);
+}
+
+struct ipc_ext_chan *ipc_shm_ext_get_chan(const uint8_t instance,
+		int chan_id)
+{
+	if (instance >= IPC_SHM_MAX_INSTANCES || chan_id < 0
+	    || chan_id >= (int)IPC_SHM_MAX_CHANNELS)
+		return NULL;
+
+	return &priv.chan[instance][chan_id];
+}
+
+void *ipc_shm_ext_chan_acquire_buf(struct ipc_ext_chan *chan, int pool_id,
+		size_t size)
+{
+	uint32_t trailer = __atomic_load_n(&chan->trailer, __ATOMIC_RELAXED);
+
+	/* trailers may need a larger pool than the one resolved */
+	if (trailer) {
+		size += trailer;
+		pool_id = ipc_sizeclass_lookup(&chan->sc, size);
+		if (pool_id < 0) {
+			ipc_prof_acquire(chan->instance, chan->chan_id, size,
+					 NULL);
+			return NULL;
+		}
+	}
+
+	return ipc_ext_acquire_pool(chan, pool_id, size, false);
+}
+
+int ipc_shm_ext_chan_tx(struct ipc_ext_chan *chan, void *buf, size_t size)
+{
+	struct ipc_capture_rec *rec;
+	int err;
+
+	/* payloads to seal take the checked path */
+	if (__atomic_load_n(&chan->trailer, __ATOMIC_RELAXED))
+		return ipc_shm_ext_tx(chan->instance, chan->chan_id, buf,
+				      size);
+
+	rec = ipc_capture_rec(IPC_CAPTURE_TX, chan->instance, chan->chan_id,
+			      buf, size);
+	err = ipc_ext_tx(chan->instance, chan->chan_id, buf, size);
+	ipc_capture_commit(rec, !err);
+
+	return err;
+}
+
+void *ipc_shm_ext_acquire_buf(const uint8_t instance, int chan_id,
+		size_t size)
+{
+	size += ipc_ext_trailer(instance, chan_id);
+
+	return ipc_ext_acquire_buf(instance, chan_id, size, false);
+}
+
+int ipc_shm_ext_release_buf(const uint8_t instance, int chan_id,
+		const void *buf)
+{
+	int err;
+
+	if (ipc_ext_is_rx_copy(buf))
+		return 0;
+
+	err = ipc_shm_release_buf(instance, chan_id, buf);
+	if (!err)
+		ipc_prof_release(instance, chan_id, buf);
+
+	return err;
+}
+
+/**
+ * ipc_ext_tx() - send a buffer as is
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	buffer pointer
+ * @size:	size of data written in buffer, trailers included
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_ext_tx(const uint8_t instance, int chan_id, void *buf, size_t size)
+{
+	int err;
+
+	err = ipc_shm_tx(instance, chan_id, buf, size);
+	if (!err)
+		ipc_prof_tx(instance, chan_id);
+
+	return err;
+}
+
+int ipc_shm_ext_tx(const uint8_t instance, int chan_id, void *buf,
+		size_t size)
+{
+	struct ipc_capture_rec *rec;
+	size_t trailer;
+	int err;
+
+	/* recorded before sealing, the payload can't be read back once sent */
+	rec = ipc_capture_rec(IPC_CAPTURE_TX, instance, chan_id, buf, size);
+
+	/* zero copy payloads are sent raw on compressed channels */
+	size += ipc_compress_seal(instance, chan_id, buf, size);
+
+	/* and read back from shared memory once on protected channels */
+	trailer = ipc_integrity_trailer(instance, chan_id);
+	if (trailer)
+		ipc_integrity_seal(buf, size);
+
+	err = ipc_ext_tx(instance, chan_id, buf, size + trailer);
+	ipc_capture_commit(rec, !err);
+
+	return err;
+}
+
+int ipc_shm_ext_tx_copy(const uint8_t instance, int chan_id, const void *src,
+		size_t size)
+{
+	struct iovec iov = {
+		.iov_base = (void *)src,
+		.iov_len = size,
+	};
+
+	return ipc_shm_ext_tx_copyv(instance, chan_id, &iov, 1);
+}
+
+int ipc_shm_ext_tx_copyv(const uint8_t instance, int chan_id,
+		const struct iovec *iov, int iovcnt)
+{
+	struct ipc_capture_rec *rec;
+	int err;
+
+	if (!iov || iovcnt < 0)
+		return -EINVAL;
+
+	rec = ipc_capture_recv(IPC_CAPTURE_TX, instance, chan_id, iov, iovcnt);
+
+	if (ipc_compress_trailer(instance, chan_id))
+		err = ipc_compress_tx(instance, chan_id, iov, iovcnt);
+	else
+		err = ipc_ext_tx_copyv(instance, chan_id, iov, iovcnt);
+
+	ipc_capture_commit(rec, !err);
+
+	return err;
+}
+
+/**
+ * ipc_ext_tx_copyv() - send data gathered from cached memory uncompressed
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @iov:	data segments to send, in order
+ * @iovcnt:	number of segments
+ *
+ * Return: 0 on success, -ENOMEM if no buffer is free, error code otherwise
+ */
+int ipc_ext_tx_copyv(const uint8_t instance, int chan_id,
+		const struct iovec *iov, int iovcnt)
+{
+	size_t size = 0, off = 0, trailer;
+	void *buf;
+	int i, err;
+
+	for (i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+
+	trailer = ipc_integrity_trailer(instance, chan_id);
+	buf = ipc_ext_acquire_buf(instance, chan_id, size + trailer,
+				  false);
+	if (!buf)
+		return -ENOMEM;
+
+	if (trailer) {
+		/* checksum computed from cached memory while copying */
+		ipc_integrity_copy_seal(buf, iov, iovcnt);
+	} else {
+		for (i = 0; i < iovcnt; i++) {
+			ipc_copy_toio((char *)buf + off, iov[i].iov_base,
+				      iov[i].iov_len);
+			off += iov[i].iov_len;
+		}
+	}
+
+	err = ipc_ext_tx(instance, chan_id, buf, size + trailer);
+	if (err)
+		ipc_ext_discard_buf(instance, chan_id, buf, size + trailer);
+
+	return err;
+}
+
+int ipc_shm_ext_tx_copy_burst(const uint8_t instance, int chan_id,
+		const struct iovec *msgs, int count)
+{
+	int i, err = 0;
+
+	if (!msgs || count < 0)
+		return -EINVAL;
+
+	ipc_os_notify_batch_begin();
+	for (i = 0; i < count; i++) {
+		err = ipc_shm_ext_tx_copy(instance, chan_id, msgs[i].iov_base,
+					  msgs[i].iov_len);
+		if (err)
+			break;
+	}
+	ipc_os_notify_batch_end();
+
+	return i ? i : err;
+}
+
+/**
+ * ipc_ext_discard_buf() - keep an acquired buffer for reuse
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	buffer pointer
+ * @size:	size requested when the buffer was acquired, trailer included
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_ext_discard_buf(const uint8_t instance, int chan_id, void *buf,
+		size_t size)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+	int pool_id;
+
+	if (!chan || !chan->managed || !buf)
+		return -EINVAL;
+
+	/* the buffer is at least as large as the first pool that fits size */
+	pool_id = ipc_sizeclass_lookup(&chan->sc, size);
+	if (pool_id < 0)
+		return -EINVAL;
+
+	pthread_mutex_lock(&chan->stash_lock);
+	if (chan->stash_len[pool_id] == IPC_EXT_STASH_BUFS) {
+		pthread_mutex_unlock(&chan->stash_lock);
+		shm_err_ch(instance, chan_id,
+			   "can't keep discarded buffer of channel %d\n",
+			   chan_id);
+		return -ENOSPC;
+	}
+	chan->stash[pool_id][chan->stash_len[pool_id]++] = buf;
+	__atomic_store_n(&chan->stash_count, chan->stash_count + 1u,
+			 __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&chan->stash_lock);
+
+	ipc_prof_tx(instance, chan_id);
+
+	return 0;
+}
+
+int ipc_shm_ext_discard_buf(const uint8_t instance, int chan_id, void *buf,
+		size_t size)
+{
+	size += ipc_ext_trailer(instance, chan_id);
+
+	return ipc_ext_discard_buf(instance, chan_id, buf, size);
+}
+
+int ipc_shm_ext_set_rx_cb(const uint8_t instance, int chan_id,
+		ipc_shm_rx_cb rx_cb, void *cb_arg)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+	uint32_t sel;
+
+	if (!chan || !chan->managed || !rx_cb)
+		return -EINVAL;
+
+	/* fill in the inactive slot, then publish it */
+	sel = chan->rx_sel ^ 1u;
+	chan->rx[sel].cb = rx_cb;
+	chan->rx[sel].arg = cb_arg;
+	__atomic_store_n(&chan->rx_sel, sel, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+int ipc_shm_ext_get_rx_cb(const uint8_t instance, int chan_id,
+		ipc_shm_rx_cb *rx_cb, void **cb_arg)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+	uint32_t sel;
+
+	if (!chan || !chan->managed || !rx_cb || !cb_arg)
+		return -EINVAL;
+
+	sel = __atomic_load_n(&chan->rx_sel, __ATOMIC_ACQUIRE);
+	*rx_cb = chan->rx[sel].cb;
+	*cb_arg = chan->rx[sel].arg;
+
+	return 0;
+}
+
+int ipc_shm_ext_hold_rx(const uint8_t instance, int chan_id,
+		ipc_shm_rx_cb rx_cb, void *cb_arg, ipc_shm_rx_cb *prev_cb,
+		void **prev_arg)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+	bool held = false;
+	int err = 0;
+
+	if (!chan || !chan->managed || !rx_cb || !prev_cb || !prev_arg)
+		return -EINVAL;
+
+	/* a single layer keeps the received buffers of a channel */
+	if (!__atomic_compare_exchange_n(&chan->rx_hold, &held, true, false,
+					 __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		return -EBUSY;
+
+	/* copy-out and compression are enabled under the same lock */
+	pthread_mutex_lock(&chan->hold_lock);
+	if (__atomic_load_n(&chan->rx_copy, __ATOMIC_RELAXED)
+	    || ipc_compress_trailer(instance, chan_id)) {
+		__atomic_store_n(&chan->rx_hold, false, __ATOMIC_RELEASE);
+		err = -EINVAL;
+	} else {
+		ipc_shm_ext_get_rx_cb(instance, chan_id, prev_cb, prev_arg);
+		ipc_shm_ext_set_rx_cb(instance, chan_id, rx_cb, cb_arg);
+	}
+	pthread_mutex_unlock(&chan->hold_lock);
+
+	return err;
+}
+
+int ipc_shm_ext_unhold_rx(const uint8_t instance, int chan_id,
+		ipc_shm_rx_cb prev_cb, void *prev_arg)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+	int err;
+
+	if (!chan || !chan->managed
+	    || !__atomic_load_n(&chan->rx_hold, __ATOMIC_RELAXED))
+		return -EINVAL;
+
+	err = ipc_shm_ext_set_rx_cb(instance, chan_id, prev_cb, prev_arg);
+	__atomic_store_n(&chan->rx_hold, false, __ATOMIC_RELEASE);
+
+	return err;
+}
+
+int ipc_shm_ext_set_rx_copy(const uint8_t instance, int chan_id, bool enable)
+{
+	struct ipc_ext_chan *chan = ipc_ext_get_chan(instance, chan_id);
+	int err = 0;
+
+	if (!chan || !chan->managed)
+		return -EINVAL;
+
+	pthread_mutex_lock(&chan->hold_lock);
+	if (enable && __atomic_load_n(&chan->rx_hold, __ATOMIC_ACQUIRE))
+		err = -EBUSY;
+	else
+		__atomic_store_n(&chan->rx_copy, enable, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&chan->hold_lock);
+
+	return err;
+}
@@ -0,0 +1,297 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_SHM_EXT_H
+#define IPC_SHM_EXT_H
+
+#include <stdbool.h>
+#include <sys/uio.h>
+
+#include "ipc-shm.h"
+#include "ipc-layout.h"
+
+/* managed channel Rx callback */
+typedef void (*ipc_shm_rx_cb)(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size);
+
+/**
+ * ipc_shm_ext_init() - initialize driver and user-space extensions
+ * @cfg:	configuration parameters for all instances
+ *
+ * Same as ipc_shm_init(), additionally building the per channel lookup
+ * tables used by the extended API. Received buffers of managed channels are
+ * passed through the extensions before reaching the application callback.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_ext_init(const struct ipc_shm_instances_cfg *cfg);
+
+/**
+ * ipc_shm_ext_free() - release driver and user-space extensions resources
+ */
+void ipc_shm_ext_free(void);
+
+/**
+ * ipc_shm_ext_set_layout() - align the shared memory layout
+ * @align:	alignment in bytes, a power of two from IPC_LAYOUT_BUF_ALIGN to
+ *		IPC_LAYOUT_MAX_ALIGN, usually the cache line or bus burst size,
+ *		or 0 to use the configuration as is (default)
+ *
+ * Applies to the next ipc_shm_ext_init(), which then passes the driver a
+ * configuration adjusted with ipc_layout_plan(): larger buffers, additional
+ * buffers and larger unmanaged memory, so that buffers start on @align
+ * boundaries and channels don't share cache lines. The application keeps its
+ * configuration, so acquired buffers may be larger than requested. The remote
+ * must use the same layout, either with the same call before initialization or
+ * with the configuration printed by the ipc-shm-layout tool.
+ *
+ * Return: 0 on success, -EINVAL for an invalid alignment
+ */
+int ipc_shm_ext_set_layout(uint32_t align);
+
+/**
+ * ipc_shm_ext_get_layout() - get the aligned layout of an instance
+ * @instance:	instance id
+ * @map:	layout planned at initialization
+ *
+ * Return: 0 on success, -EINVAL if the instance doesn't use an aligned layout
+ */
+int ipc_shm_ext_get_layout(const uint8_t instance, struct ipc_layout *map);
+
+/**
+ * ipc_shm_ext_acquire_buf() - request a buffer for the given channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @size:	required size
+ *
+ * Same as ipc_shm_acquire_buf(), but selects the first pool that fits @size
+ * with a constant time lookup and fails fast without accessing shared memory
+ * when all fitting pools were recently found exhausted.
+ *
+ * Return: pointer to the buffer base address or NULL if buffer not found
+ */
+void *ipc_shm_ext_acquire_buf(const uint8_t instance, int chan_id,
+		size_t size);
+
+/**
+ * ipc_shm_ext_release_buf() - release a received buffer
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	buffer pointer
+ *
+ * Same as ipc_shm_release_buf(), accounting the buffer in extensions. Cached
+ * copies passed to the Rx callback of channels in copy-out mode are not
+ * released and are ignored.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_ext_release_buf(const uint8_t instance, int chan_id,
+		const void *buf);
+
+/**
+ * ipc_shm_ext_tx() - send data on given channel and notify remote
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	buffer pointer
+ * @size:	size of data written in buffer
+ *
+ * Same as ipc_shm_tx(), accounting the buffer in extensions.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_ext_tx(const uint8_t instance, int chan_id, void *buf,
+		size_t size);
+
+/**
+ * ipc_shm_ext_tx_copy() - send data from cached memory on given channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @src:	data to send
+ * @size:	size of data
+ *
+ * Acquires a buffer of the first pool that fits @size, fills it with a single
+ * copy made of wide aligned stores and sends it. Messages built field by field
+ * in cached memory this way avoid many small uncached stores.
+ *
+ * Return: 0 on success, -ENOMEM if no buffer is free, error code otherwise
+ */
+int ipc_shm_ext_tx_copy(const uint8_t instance, int chan_id, const void *src,
+		size_t size);
+
+/**
+ * ipc_shm_ext_tx_copyv() - send data gathered from cached memory
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @iov:	data segments to send, in order
+ * @iovcnt:	number of segments
+ *
+ * Same as ipc_shm_ext_tx_copy(), sending the concatenation of the segments,
+ * e.g. a header and a payload kept apart.
+ *
+ * Return: 0 on success, -ENOMEM if no buffer is free, error code otherwise
+ */
+int ipc_shm_ext_tx_copyv(const uint8_t instance, int chan_id,
+		const struct iovec *iov, int iovcnt);
+
+/**
+ * ipc_shm_ext_tx_copy_burst() - send a burst of messages from cached memory
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @msgs:	messages to send, one per segment
+ * @count:	number of messages
+ *
+ * Same as ipc_shm_ext_tx_copy() for each message in order, ringing the
+ * doorbell of the remote once for the whole burst. Stops at the first
+ * message that can't be sent.
+ *
+ * Return: number of messages sent if any, error code of the first message
+ *	   otherwise
+ */
+int ipc_shm_ext_tx_copy_burst(const uint8_t instance, int chan_id,
+		const struct iovec *msgs, int count);
+
+/**
+ * ipc_shm_ext_discard_buf() - give back an acquired buffer without sending it
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	buffer pointer
+ * @size:	size requested when the buffer was acquired
+ *
+ * The driver has no way to return an acquired buffer to the local pool other
+ * than sending it, so the buffer is kept and handed out by the next
+ * ipc_shm_ext_acquire_buf() of at most @size bytes.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_ext_discard_buf(const uint8_t instance, int chan_id, void *buf,
+		size_t size);
+
+struct ipc_ext_chan;
+
+/**
+ * ipc_shm_ext_get_chan() - resolve a managed channel once for the hot path
+ * @instance:	instance id
+ * @chan_id:	channel index
+ *
+ * The handle only depends on @instance and @chan_id, so it can be resolved
+ * before ipc_shm_ext_init() and stays valid across initializations, e.g. in a
+ * static variable.
+ *
+ * Return: channel handle, NULL for invalid ids
+ */
+struct ipc_ext_chan *ipc_shm_ext_get_chan(const uint8_t instance,
+		int chan_id);
+
+/**
+ * ipc_shm_ext_chan_acquire_buf() - acquire a buffer with a resolved pool
+ * @chan:	handle of a managed channel of an initialized instance
+ * @pool_id:	first pool of the channel fitting @size
+ * @size:	required size
+ *
+ * Same as ipc_shm_ext_acquire_buf() without argument checks, channel lookup
+ * nor size lookup, for callers resolving the channel and pool ahead, such as
+ * the C++ Channel<> handles. Channels with payload trailers look the pool up
+ * again, as the trailers may need a larger one.
+ *
+ * Return: buffer pointer, NULL if no buffer is free
+ */
+void *ipc_shm_ext_chan_acquire_buf(struct ipc_ext_chan *chan, int pool_id,
+		size_t size);
+
+/**
+ * ipc_shm_ext_chan_tx() - send a buffer of a resolved channel
+ * @chan:	handle of a managed channel of an initialized instance
+ * @buf:	buffer pointer
+ * @size:	size of data written in buffer
+ *
+ * Same as ipc_shm_ext_tx() without argument checks on channels without
+ * payload trailers.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_ext_chan_tx(struct ipc_ext_chan *chan, void *buf, size_t size);
+
+/**
+ * ipc_shm_ext_set_rx_cb() - replace the Rx callback of a managed channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @rx_cb:	new Rx callback
+ * @cb_arg:	new Rx callback argument
+ *
+ * The callback and its argument are switched together, so each received
+ * buffer is passed to either the old or the new callback. Callers must not
+ * replace the callback of the same channel concurrently.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_ext_set_rx_cb(const uint8_t instance, int chan_id,
+		ipc_shm_rx_cb rx_cb, void *cb_arg);
+
+/**
+ * ipc_shm_ext_get_rx_cb() - get the Rx callback of a managed channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @rx_cb:	current Rx callback
+ * @cb_arg:	current Rx callback argument
+ *
+ * Lets a layer taking over the Rx callback restore the previous one.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_ext_get_rx_cb(const uint8_t instance, int chan_id,
+		ipc_shm_rx_cb *rx_cb, void **cb_arg);
+
+/**
+ * ipc_shm_ext_hold_rx() - take the Rx callback to keep received buffers
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @rx_cb:	Rx callback keeping the buffers after it returns
+ * @cb_arg:	Rx callback argument
+ * @prev_cb:	previous Rx callback, to pass to ipc_shm_ext_unhold_rx()
+ * @prev_arg:	previous Rx callback argument
+ *
+ * For layers keeping received buffers after their callback returns, such as
+ * publish/subscribe, the broker and the C++ coroutine channels. Only one of
+ * them can hold a channel, and not one with copy-out mode or compression
+ * enabled, which pass the callback copies reused by the next message; both
+ * modes are then refused until ipc_shm_ext_unhold_rx().
+ *
+ * Return: 0 on success, -EBUSY if the channel is already held, -EINVAL for a
+ *	   channel in copy-out mode or compressed, error code otherwise
+ */
+int ipc_shm_ext_hold_rx(const uint8_t instance, int chan_id,
+		ipc_shm_rx_cb rx_cb, void *cb_arg, ipc_shm_rx_cb *prev_cb,
+		void **prev_arg);
+
+/**
+ * ipc_shm_ext_unhold_rx() - give back the Rx callback of a held channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @prev_cb:	Rx callback returned by ipc_shm_ext_hold_rx()
+ * @prev_arg:	Rx callback argument returned by ipc_shm_ext_hold_rx()
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_ext_unhold_rx(const uint8_t instance, int chan_id,
+		ipc_shm_rx_cb prev_cb, void *prev_arg);
+
+/**
+ * ipc_shm_ext_set_rx_copy() - set Rx copy-out mode of a managed channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @enable:	true to pass cached copies of received buffers to the callback
+ *
+ * In copy-out mode each received payload is copied with wide aligned loads to
+ * a cached buffer of the Rx thread, the shared memory buffer is released right
+ * away and the Rx callback gets the copy. The callback then reads cached
+ * memory and the remote gets its buffer back without waiting for it. The copy
+ * is only valid until the callback returns, so the mode doesn't suit callbacks
+ * keeping received buffers, such as the ones of the C++ coroutine channels.
+ * It is refused on channels held with ipc_shm_ext_hold_rx().
+ *
+ * Return: 0 on success, -EBUSY if the channel is held, error code otherwise
+ */
+int ipc_shm_ext_set_rx_copy(const uint8_t instance, int chan_id, bool enable);
+
+#endif /* IPC_SHM_EXT_H */
@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include "ipc-os.h"
+#include "ipc-sizeclass.h"
+
+/**
+ * ipc_sizeclass_init() - build size class table of a managed channel
+ * @sc:		size class table
+ * @cfg:	managed channel configuration
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_sizeclass_init(struct ipc_sizeclass *sc,
+		const struct ipc_shm_managed_cfg *cfg)
+{
+	uint32_t bucket, min_size;
+	int i, pool_id;
+
+	if (cfg->num_pools <= 0 || cfg->num_pools > (int)IPC_SHM_MAX_POOLS)
+		return -EINVAL;
+
+	memset(sc, 0, sizeof(*sc));
+	sc->num_pools = cfg->num_pools;
+	for (i = 0; i < cfg->num_pools; i++) {
+		sc->buf_size[i] = cfg->pools[i].buf_size;
+		if (i > 0 && sc->buf_size[i] < sc->buf_size[i - 1]) {
+			shm_err("pools must be sorted by buffer size\n");
+			return -EINVAL;
+		}
+	}
+	sc->max_size = sc->buf_size[sc->num_pools - 1];
+
+	/* use the finest granularity that keeps the table bounded */
+	sc->shift = IPC_SIZECLASS_MIN_SHIFT;
+	while ((sc->max_size >> sc->shift) >= IPC_SIZECLASS_MAX_BUCKETS)
+		sc->shift++;
+
+	/* bucket b holds sizes in ((b - 1) << shift, b << shift] */
+	pool_id = 0;
+	for (bucket = 0; bucket <= IPC_SIZECLASS_MAX_BUCKETS; bucket++) {
+		min_size = bucket ? ((bucket - 1u) << sc->shift) + 1u : 0u;
+		while (pool_id < sc->num_pools - 1
+		       && sc->buf_size[pool_id] < min_size)
+			pool_id++;
+		sc->first_pool[bucket] = (uint8_t)pool_id;
+	}
+
+	return 0;
+}
+
+/**
+ * ipc_sizeclass_next_pool() - skip pools known to be exhausted
+ * @sc:		size class table
+ * @pool_id:	first pool that fits the requested size
+ * @seq:	current Rx event sequence
+ *
+ * Return: first pool from @pool_id not known to be empty, -1 if none
+ */
+int ipc_sizeclass_next_pool(struct ipc_sizeclass *sc, int pool_id,
+		uint32_t seq)
+{
+	uint32_t skips;
+
+	for (; pool_id < sc->num_pools; pool_id++) {
+		skips = __atomic_load_n(&sc->empty_skips[pool_id],
+					__ATOMIC_RELAXED);
+		if (!skips
+		    || __atomic_load_n(&sc->empty_seq[pool_id],
+				       __ATOMIC_RELAXED) != seq)
+			return pool_id;
+
+		/* racy decrement is fine, the hint only bounds retries */
+		__atomic_store_n(&sc->empty_skips[pool_id], skips - 1u,
+				 __ATOMIC_RELAXED);
+	}
+
+	return -1;
+}
+
+/**
+ * ipc_sizeclass_set_empty() - record that pools from @pool_id are exhausted
+ * @sc:		size class table
+ * @pool_id:	first pool tried by a failed acquire
+ * @seq:	Rx event sequence sampled before the acquire
+ */
+void ipc_sizeclass_set_empty(struct ipc_sizeclass *sc, int pool_id,
+		uint32_t seq)
+{
+	for (; pool_id < sc->num_pools; pool_id++) {
+		__atomic_store_n(&sc->empty_seq[pool_id], seq,
+				 __ATOMIC_RELAXED);
+		__atomic_store_n(&sc->empty_skips[pool_id],
+				 IPC_SIZECLASS_HINT_SKIPS, __ATOMIC_RELAXED);
+	}
+}
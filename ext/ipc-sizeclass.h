@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_SIZECLASS_H
+#define IPC_SIZECLASS_H
+
+#include "ipc-shm.h"
+
+/* maximum number of size buckets per channel */
+#define IPC_SIZECLASS_MAX_BUCKETS 256u
+/* smallest bucket granularity (log2) */
+#define IPC_SIZECLASS_MIN_SHIFT 3u
+/* acquires that may skip a pool found empty before it is tried again */
+#define IPC_SIZECLASS_HINT_SKIPS 32u
+
+/**
+ * struct ipc_sizeclass - size to pool lookup table of a managed channel
+ * @shift:		log2 of bucket granularity
+ * @num_pools:		number of buffer pools
+ * @max_size:		buffer size of the largest pool
+ * @buf_size:		buffer size of each pool
+ * @empty_seq:		Rx event sequence at which each pool was found empty
+ * @empty_skips:	remaining acquires that may skip each empty pool
+ * @first_pool:		first pool that may fit the sizes of each bucket
+ *
+ * Pool exhaustion hints are only valid until the next Rx event (the remote
+ * usually notifies when releasing buffers) and for a bounded number of
+ * acquires, since buffer releases are not signaled.
+ */
+struct ipc_sizeclass {
+	uint32_t shift;
+	int num_pools;
+	uint32_t max_size;
+	uint32_t buf_size[IPC_SHM_MAX_POOLS];
+	uint32_t empty_seq[IPC_SHM_MAX_POOLS];
+	uint32_t empty_skips[IPC_SHM_MAX_POOLS];
+	uint8_t first_pool[IPC_SIZECLASS_MAX_BUCKETS + 1u];
+};
+
+int ipc_sizeclass_init(struct ipc_sizeclass *sc,
+		const struct ipc_shm_managed_cfg *cfg);
+
+/**
+ * ipc_sizeclass_lookup() - find first pool that fits the requested size
+ * @sc:		size class table
+ * @size:	requested size
+ *
+ * Return: pool index or -1 if no pool is large enough
+ */
+static inline int ipc_sizeclass_lookup(const struct ipc_sizeclass *sc,
+		size_t size)
+{
+	int pool_id;
+
+	if (size > sc->max_size)
+		return -1;
+
+	pool_id = sc->first_pool[(size + (1u << sc->shift) - 1u) >> sc->shift];
+	/* pools smaller than the bucket granularity share a bucket */
+	while (sc->buf_size[pool_id] < size)
+		pool_id++;
+
+	return pool_id;
+}
+
+int ipc_sizeclass_next_pool(struct ipc_sizeclass *sc, int pool_id,
+		uint32_t seq);
+void ipc_sizeclass_set_empty(struct ipc_sizeclass *sc, int pool_id,
+		uint32_t seq);
+
+#endif /* IPC_SIZECLASS_H */
@@ -0,0 +1,551 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ipc-os.h"
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-ext.h"
+#include "ipc-watchdog.h"
+
+#define NSEC_PER_SEC		1000000000ull
+
+#define IPC_WATCHDOG_CHANNELS \
+	(IPC_SHM_MAX_INSTANCES * IPC_SHM_MAX_CHANNELS)
+
+/**
+ * struct ipc_watchdog_msg - message queued to the deferred thread
+ * @buf:	received buffer, or copy of a cached copy in the channel slab
+ * @size:	payload size
+ * @copy:	@buf is a slab slot, not released to the driver
+ */
+struct ipc_watchdog_msg {
+	void *buf;
+	size_t size;
+	bool copy;
+};
+
+/**
+ * struct ipc_watchdog_chan - Rx watchdog private data per channel
+ * @cfg:	watchdog settings, read by the Rx thread without lock
+ * @stats:	statistics, updated with relaxed atomics
+ * @strikes:	overruns since enabled or promoted
+ * @busy:	the deferred thread is delivering a message of the channel
+ * @promote:	promote the channel once its queue is drained
+ * @head:	index of the oldest queued message
+ * @count:	number of queued messages
+ * @queue:	messages queued to the deferred thread
+ * @slab:	copies of cached copies, one slot per queue entry, allocated
+ *		when demotion is enabled so the Rx thread never allocates
+ * @slot_size:	size of a slab slot, the largest pool of the channel
+ *
+ * The slot of the message being delivered stays in use until @busy is
+ * cleared, so at most IPC_SHM_WATCHDOG_DEPTH messages are queued or being
+ * delivered.
+ */
+struct ipc_watchdog_chan {
+	struct ipc_shm_watchdog_cfg cfg;
+	struct ipc_shm_watchdog_stats stats;
+	uint32_t strikes;
+	bool busy;
+	bool promote;
+	uint32_t head;
+	uint32_t count;
+	struct ipc_watchdog_msg queue[IPC_SHM_WATCHDOG_DEPTH];
+	char *slab;
+	size_t slot_size;
+} __attribute__((aligned(IPC_EXT_CACHE_LINE)));
+
+/**
+ * struct ipc_watchdog_priv - Rx watchdog private data
+ * @once:	one-time initialization control
+ * @lock:	lock protecting the queues and the deferred thread, with
+ *		priority inheritance since the Rx thread takes it
+ * @cond:	signaled when a message is queued and on stop
+ * @thread:	deferred thread
+ * @running:	deferred thread started
+ * @stopping:	deferred thread asked to exit
+ * @next:	channel the deferred thread serves next
+ * @enabled:	timed channels of each instance, one bit per channel
+ * @demoted:	channels of each instance delivered by the deferred thread
+ * @chan:	private data per instance and channel
+ */
+static struct ipc_watchdog_priv {
+	pthread_once_t once;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t thread;
+	bool running;
+	bool stopping;
+	uint32_t next;
+	uint32_t enabled[IPC_SHM_MAX_INSTANCES];
+	uint32_t demoted[IPC_SHM_MAX_INSTANCES];
+	struct ipc_watchdog_chan
+		chan[IPC_SHM_MAX_INSTANCES][IPC_SHM_MAX_CHANNELS];
+} priv = {
+	.once = PTHREAD_ONCE_INIT,
+};
+
+static void ipc_watchdog_init(void)
+{
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	pthread_mutex_init(&priv.lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+	pthread_cond_init(&priv.cond, NULL);
+}
+
+static uint64_t ipc_watchdog_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+static uint32_t ipc_watchdog_bucket(uint64_t ns)
+{
+	uint32_t bucket;
+
+	if (ns < 2u)
+		return 0;
+
+	bucket = 63u - (uint32_t)__builtin_clzll(ns);
+
+	return bucket < IPC_SHM_WATCHDOG_BUCKETS ?
+		bucket : IPC_SHM_WATCHDOG_BUCKETS - 1u;
+}
+
+static void ipc_watchdog_max(uint64_t *peak, uint64_t val)
+{
+	uint64_t old = __atomic_load_n(peak, __ATOMIC_RELAXED);
+
+	while (val > old
+	       && !__atomic_compare_exchange_n(peak, &old, val, true,
+					       __ATOMIC_RELAXED,
+					       __ATOMIC_RELAXED))
+		;
+}
+
+/* give back a message that won't be delivered */
+static void ipc_watchdog_drop(const uint8_t instance, int chan_id,
+		const struct ipc_watchdog_msg *msg)
+{
+	if (!msg->copy)
+		ipc_shm_ext_release_buf(instance, chan_id, msg->buf);
+}
+
+/* free the slabs, called with the deferred thread stopped */
+static void ipc_watchdog_free_slabs(void)
+{
+	uint32_t i, j;
+
+	for (i = 0; i < IPC_SHM_MAX_INSTANCES; i++) {
+		for (j = 0; j < IPC_SHM_MAX_CHANNELS; j++) {
+			free(priv.chan[i][j].slab);
+			priv.chan[i][j].slab = NULL;
+			priv.chan[i][j].slot_size = 0;
+		}
+	}
+}
+
+/* allocate the slab of a channel, if not yet, before it can be demoted */
+static int ipc_watchdog_alloc_slab(struct ipc_watchdog_chan *chan,
+		const struct ipc_ext_chan *ext_chan)
+{
+	size_t slot_size;
+	void *slab;
+
+	if (__atomic_load_n(&chan->slab, __ATOMIC_ACQUIRE))
+		return 0;
+
+	slot_size = (ext_chan->sc.max_size + IPC_EXT_CACHE_LINE - 1u)
+		    & ~(size_t)(IPC_EXT_CACHE_LINE - 1u);
+	if (posix_memalign(&slab, IPC_EXT_CACHE_LINE,
+			   slot_size * IPC_SHM_WATCHDOG_DEPTH))
+		return -ENOMEM;
+
+	pthread_mutex_lock(&priv.lock);
+	if (!chan->slab) {
+		chan->slot_size = slot_size;
+		__atomic_store_n(&chan->slab, slab, __ATOMIC_RELEASE);
+		slab = NULL;
+	}
+	pthread_mutex_unlock(&priv.lock);
+	free(slab);
+
+	return 0;
+}
+
+/* deliver queued messages of demoted channels, one per channel in turn */
+static void *ipc_watchdog_thread(void *arg)
+{
+	struct ipc_watchdog_chan *chan = NULL;
+	struct ipc_watchdog_msg msg;
+	int chan_id = 0;
+	uint8_t instance = 0;
+	uint32_t i, idx;
+
+	pthread_mutex_lock(&priv.lock);
+	while (!priv.stopping) {
+		for (i = 0; i < IPC_WATCHDOG_CHANNELS; i++) {
+			idx = (priv.next + i) % IPC_WATCHDOG_CHANNELS;
+			instance = (uint8_t)(idx / IPC_SHM_MAX_CHANNELS);
+			chan_id = (int)(idx % IPC_SHM_MAX_CHANNELS);
+			chan = &priv.chan[instance][chan_id];
+			if (chan->count)
+				break;
+		}
+		if (i == IPC_WATCHDOG_CHANNELS) {
+			pthread_cond_wait(&priv.cond, &priv.lock);
+			continue;
+		}
+
+		priv.next = idx + 1u;
+		msg = chan->queue[chan->head];
+		chan->head = (chan->head + 1u) % IPC_SHM_WATCHDOG_DEPTH;
+		chan->count--;
+		chan->busy = true;
+		pthread_mutex_unlock(&priv.lock);
+
+		ipc_ext_rx_deliver(instance, chan_id, msg.buf, msg.size,
+				   msg.copy);
+		__atomic_fetch_add(&chan->stats.deferred, 1u, __ATOMIC_RELAXED);
+
+		pthread_mutex_lock(&priv.lock);
+		chan->busy = false;
+		/* the Rx thread delivers again after the last queued message */
+		if (!chan->count && chan->promote) {
+			chan->promote = false;
+			__atomic_fetch_and(&priv.demoted[instance],
+					   ~(1u << chan_id), __ATOMIC_RELAXED);
+		}
+	}
+	pthread_mutex_unlock(&priv.lock);
+
+	return NULL;
+}
+
+/* called with the lock held */
+static int ipc_watchdog_start_thread(void)
+{
+	pthread_attr_t attr;
+	int err;
+
+	if (priv.running)
+		return 0;
+
+	/* don't inherit the SCHED_FIFO priority of the Rx thread */
+	pthread_attr_init(&attr);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+	err = pthread_create(&priv.thread, &attr, ipc_watchdog_thread, NULL);
+	pthread_attr_destroy(&attr);
+	if (err)
+		return -err;
+
+	priv.stopping = false;
+	priv.running = true;
+
+	return 0;
+}
+
+static void ipc_watchdog_demote(const uint8_t instance, int chan_id)
+{
+	int err;
+
+	pthread_mutex_lock(&priv.lock);
+	err = ipc_watchdog_start_thread();
+	if (!err) {
+		priv.chan[instance][chan_id].promote = false;
+		__atomic_fetch_or(&priv.demoted[instance], 1u << chan_id,
+				  __ATOMIC_RELAXED);
+	}
+	pthread_mutex_unlock(&priv.lock);
+
+	if (err)
+		shm_err_ch(instance, chan_id,
+			   "Can't start deferred thread for channel %d\n",
+			   chan_id);
+	else
+		shm_err_ch(instance, chan_id,
+			   "Channel %d demoted to deferred thread\n", chan_id);
+}
+
+int ipc_shm_watchdog_enable(const uint8_t instance, int chan_id,
+		const struct ipc_shm_watchdog_cfg *cfg)
+{
+	struct ipc_ext_chan *ext_chan = ipc_ext_get_chan(instance, chan_id);
+	struct ipc_watchdog_chan *chan;
+	int err;
+
+	if (!ext_chan || !ext_chan->managed)
+		return -EINVAL;
+
+	pthread_once(&priv.once, ipc_watchdog_init);
+	chan = &priv.chan[instance][chan_id];
+
+	if (!cfg) {
+		__atomic_fetch_and(&priv.enabled[instance], ~(1u << chan_id),
+				   __ATOMIC_RELAXED);
+		return 0;
+	}
+
+	if (cfg->demote_after) {
+		err = ipc_watchdog_alloc_slab(chan, ext_chan);
+		if (err) {
+			shm_err_ch(instance, chan_id,
+				   "Can't allocate slab of channel %d\n",
+				   chan_id);
+			return err;
+		}
+	}
+
+	__atomic_store_n(&chan->cfg.threshold_ns, cfg->threshold_ns,
+			 __ATOMIC_RELAXED);
+	__atomic_store_n(&chan->cfg.demote_after, cfg->demote_after,
+			 __ATOMIC_RELAXED);
+	__atomic_store_n(&chan->cfg.cb_arg, cfg->cb_arg, __ATOMIC_RELAXED);
+	__atomic_store_n(&chan->cfg.cb, cfg->cb, __ATOMIC_RELEASE);
+	__atomic_store_n(&chan->strikes, 0u, __ATOMIC_RELAXED);
+	__atomic_fetch_or(&priv.enabled[instance], 1u << chan_id,
+			  __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+int ipc_shm_watchdog_promote(const uint8_t instance, int chan_id)
+{
+	struct ipc_ext_chan *ext_chan = ipc_ext_get_chan(instance, chan_id);
+	struct ipc_watchdog_chan *chan;
+
+	if (!ext_chan || !ext_chan->managed)
+		return -EINVAL;
+
+	pthread_once(&priv.once, ipc_watchdog_init);
+	chan = &priv.chan[instance][chan_id];
+
+	pthread_mutex_lock(&priv.lock);
+	__atomic_store_n(&chan->strikes, 0u, __ATOMIC_RELAXED);
+	if (chan->count || chan->busy)
+		chan->promote = true;
+	else
+		__atomic_fetch_and(&priv.demoted[instance], ~(1u << chan_id),
+				   __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&priv.lock);
+
+	return 0;
+}
+
+int ipc_shm_watchdog_get_stats(const uint8_t instance, int chan_id,
+		struct ipc_shm_watchdog_stats *stats)
+{
+	struct ipc_ext_chan *ext_chan = ipc_ext_get_chan(instance, chan_id);
+	const struct ipc_shm_watchdog_stats *s;
+	uint32_t i;
+
+	if (!ext_chan || !ext_chan->managed || !stats)
+		return -EINVAL;
+
+	s = &priv.chan[instance][chan_id].stats;
+	stats->calls = __atomic_load_n(&s->calls, __ATOMIC_RELAXED);
+	stats->total_ns = __atomic_load_n(&s->total_ns, __ATOMIC_RELAXED);
+	stats->max_ns = __atomic_load_n(&s->max_ns, __ATOMIC_RELAXED);
+	stats->overruns = __atomic_load_n(&s->overruns, __ATOMIC_RELAXED);
+	stats->deferred = __atomic_load_n(&s->deferred, __ATOMIC_RELAXED);
+	stats->dropped = __atomic_load_n(&s->dropped, __ATOMIC_RELAXED);
+	stats->demoted = __atomic_load_n(&priv.demoted[instance],
+					 __ATOMIC_RELAXED) & (1u << chan_id);
+	for (i = 0; i < IPC_SHM_WATCHDOG_BUCKETS; i++)
+		stats->hist[i] = __atomic_load_n(&s->hist[i],
+						 __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+/**
+ * ipc_watchdog_start() - start timing an Rx callback
+ * @instance:	instance id
+ * @chan_id:	channel index
+ *
+ * Return: start time to pass to ipc_watchdog_end(), 0 if the channel isn't
+ *	   timed
+ */
+uint64_t ipc_watchdog_start(const uint8_t instance, int chan_id)
+{
+	if (!(__atomic_load_n(&priv.enabled[instance], __ATOMIC_RELAXED)
+	      & (1u << chan_id)))
+		return 0;
+
+	return ipc_watchdog_now();
+}
+
+/**
+ * ipc_watchdog_end() - record an Rx callback and handle overruns
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @start:	value returned by ipc_watchdog_start()
+ */
+void ipc_watchdog_end(const uint8_t instance, int chan_id, uint64_t start)
+{
+	struct ipc_watchdog_chan *chan;
+	uint64_t ns, threshold;
+	ipc_shm_overrun_cb cb;
+	uint32_t demote_after;
+
+	if (!start)
+		return;
+
+	ns = ipc_watchdog_now() - start;
+	chan = &priv.chan[instance][chan_id];
+	__atomic_fetch_add(&chan->stats.calls, 1u, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&chan->stats.total_ns, ns, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&chan->stats.hist[ipc_watchdog_bucket(ns)], 1u,
+			   __ATOMIC_RELAXED);
+	ipc_watchdog_max(&chan->stats.max_ns, ns);
+
+	threshold = __atomic_load_n(&chan->cfg.threshold_ns, __ATOMIC_RELAXED);
+	if (!threshold || ns <= threshold)
+		return;
+
+	__atomic_fetch_add(&chan->stats.overruns, 1u, __ATOMIC_RELAXED);
+	cb = __atomic_load_n(&chan->cfg.cb, __ATOMIC_ACQUIRE);
+	if (cb)
+		cb(__atomic_load_n(&chan->cfg.cb_arg, __ATOMIC_RELAXED),
+		   instance, chan_id, ns, threshold);
+	else
+		shm_err_ch(instance, chan_id,
+			   "Rx callback of channel %d took %llu ns, %llu ns over threshold\n",
+			   chan_id, (unsigned long long)ns,
+			   (unsigned long long)(ns - threshold));
+
+	/* overruns of the deferred thread don't count towards demotion */
+	demote_after = __atomic_load_n(&chan->cfg.demote_after,
+				       __ATOMIC_RELAXED);
+	if (demote_after
+	    && !(__atomic_load_n(&priv.demoted[instance], __ATOMIC_RELAXED)
+		 & (1u << chan_id))
+	    && __atomic_add_fetch(&chan->strikes, 1u, __ATOMIC_RELAXED)
+	       == demote_after)
+		ipc_watchdog_demote(instance, chan_id);
+}
+
+/**
+ * ipc_watchdog_defer() - queue a message of a demoted channel
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	received buffer or cached copy
+ * @size:	payload size
+ * @copy:	@buf is a cached copy, reused by the next message
+ *
+ * Cached copies are copied to the slab slot of their queue entry, with the
+ * lock held; copies larger than a slot are dropped.
+ *
+ * Return: true if the message was queued or dropped, false if the channel
+ *	   is delivered on the Rx thread
+ */
+bool ipc_watchdog_defer(const uint8_t instance, int chan_id, void *buf,
+		size_t size, bool copy)
+{
+	struct ipc_watchdog_chan *chan;
+	struct ipc_watchdog_msg msg = {
+		.buf = buf,
+		.size = size,
+		.copy = copy,
+	};
+	uint32_t idx;
+
+	if (!(__atomic_load_n(&priv.demoted[instance], __ATOMIC_RELAXED)
+	      & (1u << chan_id)))
+		return false;
+
+	chan = &priv.chan[instance][chan_id];
+	pthread_mutex_lock(&priv.lock);
+	/* promoted since, once the queue was drained */
+	if (!(__atomic_load_n(&priv.demoted[instance], __ATOMIC_RELAXED)
+	      & (1u << chan_id))) {
+		pthread_mutex_unlock(&priv.lock);
+		return false;
+	}
+
+	if (chan->count + chan->busy == IPC_SHM_WATCHDOG_DEPTH
+	    || (copy && (!chan->slab || size > chan->slot_size))) {
+		pthread_mutex_unlock(&priv.lock);
+		__atomic_fetch_add(&chan->stats.dropped, 1u, __ATOMIC_RELAXED);
+		shm_dbg_ch(instance, chan_id,
+			   "Can't queue message of channel %d\n", chan_id);
+		ipc_watchdog_drop(instance, chan_id, &msg);
+		return true;
+	}
+
+	idx = (chan->head + chan->count) % IPC_SHM_WATCHDOG_DEPTH;
+	if (copy) {
+		msg.buf = chan->slab + idx * chan->slot_size;
+		memcpy(msg.buf, buf, size);
+	}
+	chan->queue[idx] = msg;
+	chan->count++;
+	pthread_cond_signal(&priv.cond);
+	pthread_mutex_unlock(&priv.lock);
+
+	return true;
+}
+
+void ipc_watchdog_reset(void)
+{
+	pthread_once(&priv.once, ipc_watchdog_init);
+
+	pthread_mutex_lock(&priv.lock);
+	ipc_watchdog_free_slabs();
+	memset(priv.enabled, 0, sizeof(priv.enabled));
+	memset(priv.demoted, 0, sizeof(priv.demoted));
+	memset(priv.chan, 0, sizeof(priv.chan));
+	priv.next = 0;
+	pthread_mutex_unlock(&priv.lock);
+}
+
+/* stop the deferred thread and give back the messages it didn't deliver */
+void ipc_watchdog_stop(void)
+{
+	struct ipc_watchdog_chan *chan;
+	struct ipc_watchdog_msg *msg;
+	bool running;
+	uint32_t i;
+	int j;
+
+	pthread_once(&priv.once, ipc_watchdog_init);
+
+	/* the Rx thread delivers new messages itself from now on */
+	pthread_mutex_lock(&priv.lock);
+	memset(priv.demoted, 0, sizeof(priv.demoted));
+	running = priv.running;
+	priv.stopping = true;
+	pthread_cond_broadcast(&priv.cond);
+	pthread_mutex_unlock(&priv.lock);
+
+	if (running)
+		pthread_join(priv.thread, NULL);
+	priv.running = false;
+
+	for (i = 0; i < IPC_SHM_MAX_INSTANCES; i++) {
+		for (j = 0; j < (int)IPC_SHM_MAX_CHANNELS; j++) {
+			chan = &priv.chan[i][j];
+			for (; chan->count; chan->count--) {
+				msg = &chan->queue[chan->head];
+				chan->head = (chan->head + 1u)
+					     % IPC_SHM_WATCHDOG_DEPTH;
+				ipc_watchdog_drop((uint8_t)i, j, msg);
+			}
+		}
+	}
+	ipc_watchdog_free_slabs();
+}
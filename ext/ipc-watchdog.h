@@ -0,0 +1,132 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_WATCHDOG_H
+#define IPC_WATCHDOG_H
+
+#include <stdbool.h>
+
+#include "ipc-shm.h"
+
+/* log2 histogram buckets of Rx callback durations */
+#define IPC_SHM_WATCHDOG_BUCKETS	32u
+/* messages queued to the deferred thread per demoted channel */
+#define IPC_SHM_WATCHDOG_DEPTH		256u
+
+/**
+ * typedef ipc_shm_overrun_cb - called when an Rx callback overruns
+ * @arg:		callback argument
+ * @instance:		instance id
+ * @chan_id:		channel index
+ * @duration_ns:	duration of the Rx callback
+ * @threshold_ns:	overrun threshold of the channel
+ */
+typedef void (*ipc_shm_overrun_cb)(void *arg, const uint8_t instance,
+		int chan_id, uint64_t duration_ns, uint64_t threshold_ns);
+
+/**
+ * struct ipc_shm_watchdog_cfg - Rx callback watchdog settings of a channel
+ * @threshold_ns:	Rx callback duration above which it overruns, 0 to
+ *			only record durations
+ * @demote_after:	overruns after which the channel is demoted to the
+ *			deferred thread, 0 to never demote it
+ * @cb:			called on each overrun, NULL to log an error instead
+ * @cb_arg:		callback argument
+ */
+struct ipc_shm_watchdog_cfg {
+	uint64_t threshold_ns;
+	uint32_t demote_after;
+	ipc_shm_overrun_cb cb;
+	void *cb_arg;
+};
+
+/**
+ * struct ipc_shm_watchdog_stats - Rx callback statistics of a channel
+ * @calls:	Rx callbacks timed
+ * @total_ns:	total duration of the Rx callbacks
+ * @max_ns:	longest Rx callback
+ * @overruns:	Rx callbacks above the threshold
+ * @deferred:	messages delivered by the deferred thread
+ * @dropped:	messages dropped because the deferred queue was full or
+ *		their cached copy larger than a slab slot
+ * @demoted:	channel delivered by the deferred thread
+ * @hist:	Rx callbacks per duration, bucket b counting durations of
+ *		[2^b, 2^(b+1)) ns and the first and last buckets the shorter
+ *		and longer ones
+ */
+struct ipc_shm_watchdog_stats {
+	uint64_t calls;
+	uint64_t total_ns;
+	uint64_t max_ns;
+	uint64_t overruns;
+	uint64_t deferred;
+	uint64_t dropped;
+	bool demoted;
+	uint64_t hist[IPC_SHM_WATCHDOG_BUCKETS];
+};
+
+/**
+ * ipc_shm_watchdog_enable() - time the Rx callbacks of a managed channel
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ * @cfg:	watchdog settings, NULL to stop timing the channel
+ *
+ * Each call of the Rx callback of the channel is timed and recorded in a
+ * duration histogram. Calls longer than the threshold are counted and passed
+ * to the overrun callback, which runs right after the Rx callback in the
+ * same thread, or logged.
+ *
+ * Rx callbacks run on the Rx thread of the instance, at the highest SCHED_FIFO
+ * priority, so one slow callback delays all channels of the instance. After
+ * @demote_after overruns the channel is demoted: its messages are queued to a
+ * deferred thread running at normal priority (SCHED_OTHER), which calls the Rx
+ * callback instead, in order. Messages received while IPC_SHM_WATCHDOG_DEPTH
+ * messages are queued or being delivered are dropped and their buffers
+ * released. Cached copies passed to the callback in Rx copy-out mode are only
+ * valid until it returns, as on the Rx thread. Changing the settings doesn't
+ * promote the channel.
+ *
+ * A non-zero @demote_after allocates a slab of IPC_SHM_WATCHDOG_DEPTH slots
+ * sized to the largest pool of the channel, once, so that the Rx thread
+ * queues cached copies without allocating memory. Copies larger than a slot,
+ * such as decompressed messages, are dropped.
+ *
+ * Return: 0 on success, -ENOMEM if the slab can't be allocated, error code
+ *	   otherwise
+ */
+int ipc_shm_watchdog_enable(const uint8_t instance, int chan_id,
+		const struct ipc_shm_watchdog_cfg *cfg);
+
+/**
+ * ipc_shm_watchdog_promote() - deliver a demoted channel on the Rx thread again
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ *
+ * Messages already queued are delivered by the deferred thread first. The
+ * overrun count towards demotion restarts.
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_watchdog_promote(const uint8_t instance, int chan_id);
+
+/**
+ * ipc_shm_watchdog_get_stats() - get Rx callback statistics of a channel
+ * @instance:	instance id
+ * @chan_id:	managed channel index
+ * @stats:	statistics since initialization
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_shm_watchdog_get_stats(const uint8_t instance, int chan_id,
+		struct ipc_shm_watchdog_stats *stats);
+
+/* hooks called by the extended API */
+uint64_t ipc_watchdog_start(const uint8_t instance, int chan_id);
+void ipc_watchdog_end(const uint8_t instance, int chan_id, uint64_t start);
+bool ipc_watchdog_defer(const uint8_t instance, int chan_id, void *buf,
+		size_t size, bool copy);
+void ipc_watchdog_reset(void);
+void ipc_watchdog_stop(void);
+
+#endif /* IPC_WATCHDOG_H */
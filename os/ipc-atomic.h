@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#ifndef IPC_ATOMIC_H
+#define IPC_ATOMIC_H
+
+/*
+ * Memory ordering of shared memory accesses, on the C11 memory model of the
+ * compiler atomic builtins, with the Linux kernel names so that common code
+ * builds unchanged in both drivers.
+ *
+ * A queue producer writes descriptors with relaxed accesses and publishes the
+ * index following them with smp_store_release(); the consumer reads the index
+ * with smp_load_acquire() before reading the descriptors. The index then orders
+ * the descriptor accesses on each side without full barriers: on aarch64 the
+ * publication compiles to STLR and the consumption to LDAR instead of DMB
+ * around plain stores and loads, and on x86 both are plain moves.
+ *
+ * Acquire and release don't order a store before a later load. A side that
+ * publishes its index and then checks the other one, e.g. to decide whether
+ * to wake it up, needs smp_mb() in between, as the side going to sleep does
+ * before its last check.
+ *
+ * Relaxed accesses are single-copy atomic, never torn, merged or elided by the
+ * compiler, but give no ordering.
+ *
+ * The driver descriptor queues follow the same protocol through
+ * ipc_queue_load_idx() and ipc_queue_store_idx(): the producer publishes the
+ * write index after the descriptor and buffer it hands over, and the consumer
+ * publishes the read index once done with them, so that the producer doesn't
+ * reuse a slot still being read. Each side reads its own index relaxed.
+ */
+
+/* load-acquire: later accesses can't be performed before it */
+#define smp_load_acquire(p)	__atomic_load_n((p), __ATOMIC_ACQUIRE)
+
+/* store-release: earlier accesses can't be performed after it */
+#define smp_store_release(p, v) \
+	__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/* full barrier: also orders earlier stores with later loads */
+#define smp_mb()		__atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#define READ_ONCE(x)		__atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define WRITE_ONCE(x, v)	__atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+
+#define readl_relaxed(addr)	__atomic_load_n((addr), __ATOMIC_RELAXED)
+#define readw_relaxed(addr)	__atomic_load_n((addr), __ATOMIC_RELAXED)
+#define writel_relaxed(val, addr) \
+	__atomic_store_n((addr), (val), __ATOMIC_RELAXED)
+#define writew_relaxed(val, addr) \
+	__atomic_store_n((addr), (val), __ATOMIC_RELAXED)
+
+/* index of a descriptor queue written by the other side */
+#define ipc_queue_load_idx(addr)	smp_load_acquire(addr)
+/* publish an index of a descriptor queue to the other side */
+#define ipc_queue_store_idx(addr, val)	smp_store_release((addr), (val))
+
+#endif /* IPC_ATOMIC_H */
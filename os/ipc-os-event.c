@@ -0,0 +1,252 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <pthread.h>
+
+#include "ipc-os.h"
+#include "ipc-hw.h"
+
+/**
+ * struct ipc_os_event_instance - Rx event data of each instance
+ * @lock:	lock protecting Rx event sequence, with priority inheritance
+ * @cond:	signaled after each Rx softirq pass
+ * @seq:	number of Rx softirq passes completed
+ * @log_ring:	log ring of the Rx softirq thread until it starts
+ */
+struct ipc_os_event_instance {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint32_t seq;
+	struct ipc_log_ring *log_ring;
+};
+
+/**
+ * struct ipc_os_event_priv - Rx event private data shared by OS backends
+ * @id:			Rx event data per instance
+ * @rx_event_hook:	optional hooks called from Rx softirq after each pass
+ */
+static struct ipc_os_event_priv {
+	struct ipc_os_event_instance id[IPC_SHM_MAX_INSTANCES];
+	void (*rx_event_hook[IPC_OS_MAX_RX_EVENT_HOOKS])(const uint8_t instance);
+} priv;
+
+/**
+ * struct ipc_os_notify_batch - doorbells deferred by the calling thread
+ * @depth:	nesting depth of notification batches
+ * @pending:	instances to notify at the end of the outermost batch
+ */
+static __thread struct ipc_os_notify_batch {
+	uint32_t depth;
+	uint32_t pending;
+} batch;
+
+/**
+ * ipc_os_rx_event_init() - initialize Rx event data of an instance
+ * @instance:	instance id
+ */
+void ipc_os_rx_event_init(const uint8_t instance)
+{
+	struct ipc_os_event_instance *id = &priv.id[instance];
+	pthread_mutexattr_t lock_attr;
+	pthread_condattr_t attr;
+
+	/* the Rx thread takes the lock too */
+	pthread_mutexattr_init(&lock_attr);
+	pthread_mutexattr_setprotocol(&lock_attr, PTHREAD_PRIO_INHERIT);
+	pthread_mutex_init(&id->lock, &lock_attr);
+	pthread_mutexattr_destroy(&lock_attr);
+
+	/* Rx event condition uses the monotonic clock for timed waits */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&id->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	id->seq = 0;
+
+	/* the Rx softirq thread is real-time, allocate its log ring here */
+	id->log_ring = ipc_log_ring_alloc();
+}
+
+/**
+ * ipc_os_rx_thread_init() - set up the Rx softirq thread of an instance
+ * @instance:	instance id
+ *
+ * Called by the thread when it starts, before it logs.
+ */
+void ipc_os_rx_thread_init(const uint8_t instance)
+{
+	struct ipc_os_event_instance *id = &priv.id[instance];
+
+	ipc_log_ring_attach(id->log_ring);
+	id->log_ring = NULL;
+}
+
+/**
+ * ipc_os_rx_event_free() - free Rx event data of an instance
+ * @instance:	instance id
+ */
+void ipc_os_rx_event_free(const uint8_t instance)
+{
+	/* log ring of a thread that never started */
+	ipc_log_ring_put(priv.id[instance].log_ring);
+	priv.id[instance].log_ring = NULL;
+
+	pthread_cond_destroy(&priv.id[instance].cond);
+	pthread_mutex_destroy(&priv.id[instance].lock);
+}
+
+/**
+ * ipc_os_rx_event() - signal the end of an Rx softirq pass
+ * @instance:	instance id
+ *
+ * Wakes Rx event waiters, as the remote may have released buffers, then calls
+ * the Rx event hooks.
+ */
+void ipc_os_rx_event(const uint8_t instance)
+{
+	struct ipc_os_event_instance *id = &priv.id[instance];
+	void (*hook)(const uint8_t instance);
+	int i;
+
+	pthread_mutex_lock(&id->lock);
+	smp_store_release(&id->seq, id->seq + 1u);
+	pthread_cond_broadcast(&id->cond);
+	pthread_mutex_unlock(&id->lock);
+
+	for (i = 0; i < IPC_OS_MAX_RX_EVENT_HOOKS; i++) {
+		hook = smp_load_acquire(&priv.rx_event_hook[i]);
+		if (hook)
+			hook(instance);
+	}
+}
+
+/**
+ * ipc_os_rx_event_seq() - get number of Rx softirq passes completed
+ * @instance:	instance id
+ *
+ * Must be sampled before checking the condition passed to
+ * ipc_os_rx_event_wait() to avoid missing an Rx event.
+ *
+ * Return: current Rx event sequence number
+ */
+uint32_t ipc_os_rx_event_seq(const uint8_t instance)
+{
+	return smp_load_acquire(&priv.id[instance].seq);
+}
+
+/**
+ * ipc_os_rx_event_wait() - wait for the next Rx softirq pass
+ * @instance:	instance id
+ * @seq:	Rx event sequence number sampled by caller
+ * @abstime:	CLOCK_MONOTONIC deadline or NULL to wait indefinitely
+ *
+ * Return: 0 if an Rx event occurred after @seq, -ETIMEDOUT otherwise
+ */
+int ipc_os_rx_event_wait(const uint8_t instance, uint32_t seq,
+		const struct timespec *abstime)
+{
+	struct ipc_os_event_instance *id = &priv.id[instance];
+	int err = 0;
+
+	pthread_mutex_lock(&id->lock);
+	while (id->seq == seq && err == 0) {
+		if (abstime)
+			err = pthread_cond_timedwait(&id->cond, &id->lock,
+						     abstime);
+		else
+			err = pthread_cond_wait(&id->cond, &id->lock);
+	}
+	if (id->seq != seq)
+		err = 0;
+	pthread_mutex_unlock(&id->lock);
+
+	return err ? -ETIMEDOUT : 0;
+}
+
+/**
+ * ipc_os_add_rx_event_hook() - add function called after each Rx pass
+ * @hook:	function called from Rx softirq thread
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_os_add_rx_event_hook(void (*hook)(const uint8_t instance))
+{
+	void (*empty)(const uint8_t instance);
+	int i;
+
+	for (i = 0; i < IPC_OS_MAX_RX_EVENT_HOOKS; i++) {
+		empty = NULL;
+		if (__atomic_compare_exchange_n(&priv.rx_event_hook[i], &empty,
+						hook, false, __ATOMIC_RELEASE,
+						__ATOMIC_RELAXED))
+			return 0;
+	}
+
+	return -ENOSPC;
+}
+
+/**
+ * ipc_os_del_rx_event_hook() - remove function called after each Rx pass
+ * @hook:	function added with ipc_os_add_rx_event_hook()
+ */
+void ipc_os_del_rx_event_hook(void (*hook)(const uint8_t instance))
+{
+	void (*expected)(const uint8_t instance);
+	int i;
+
+	for (i = 0; i < IPC_OS_MAX_RX_EVENT_HOOKS; i++) {
+		expected = hook;
+		__atomic_compare_exchange_n(&priv.rx_event_hook[i], &expected,
+					    NULL, false, __ATOMIC_RELEASE,
+					    __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * ipc_os_notify_batch_begin() - defer remote notifications of this thread
+ *
+ * Notifications requested by the calling thread, e.g. by ipc_shm_tx(), are
+ * coalesced per instance until the matching ipc_os_notify_batch_end(), so
+ * that a burst of messages rings each doorbell once. Batches nest.
+ */
+void ipc_os_notify_batch_begin(void)
+{
+	batch.depth++;
+}
+
+/**
+ * ipc_os_notify_batch_end() - ring doorbells deferred since batch begin
+ */
+void ipc_os_notify_batch_end(void)
+{
+	uint32_t pending;
+	uint8_t i;
+
+	if (!batch.depth || --batch.depth)
+		return;
+
+	pending = batch.pending;
+	batch.pending = 0;
+	for (i = 0; pending; i++, pending >>= 1)
+		if (pending & 1u)
+			ipc_hw_irq_notify(i);
+}
+
+/**
+ * ipc_os_notify_batched() - defer notification if a batch is open
+ * @instance:	instance id
+ *
+ * Called by OS backends before ringing the doorbell of an instance.
+ *
+ * Return: true if the notification is deferred, false to ring it now
+ */
+bool ipc_os_notify_batched(const uint8_t instance)
+{
+	if (!batch.depth)
+		return false;
+
+	batch.pending |= 1u << instance;
+
+	return true;
+}
@@ -0,0 +1,336 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#include "ipc-os.h"
+#include "ipc-hw.h"
+#include "ipc-shm.h"
+
+/*
+ * OS and hardware layer for a Linux host, running the driver against a peer
+ * process such as tools/ipc-shm-peer instead of a remote core.
+ *
+ * The shared memory at each address of the configuration is a POSIX shared
+ * memory file and each side rings the doorbell of the memory it writes, a
+ * FIFO named after the same address. Both sides use the same configuration
+ * with local and remote addresses swapped, hence the same files.
+ */
+
+#define IPC_OS_HOST_NAME_LEN	64
+#define IPC_OS_HOST_SHM_NAME	"/ipc-shm-%lx"
+#define IPC_OS_HOST_FIFO_NAME	"/tmp/ipc-shm-%lx.irq"
+
+/**
+ * struct ipc_os_host_instance - host OS private data each instance
+ * @shm_size:		local/remote ShM size
+ * @local_virt_shm:	local ShM virtual address
+ * @remote_virt_shm:	remote ShM virtual address
+ * @local_shm_fd:	local ShM file descriptor
+ * @remote_shm_fd:	remote ShM file descriptor
+ * @irq_thread_id:	Rx softirq thread id
+ * @rx_fd:		doorbell rung by remote, read by Rx softirq
+ * @tx_fd:		doorbell rung to notify remote
+ */
+struct ipc_os_host_instance {
+	size_t shm_size;
+	void *local_virt_shm;
+	void *remote_virt_shm;
+	int local_shm_fd;
+	int remote_shm_fd;
+	pthread_t irq_thread_id;
+	int rx_fd;
+	int tx_fd;
+};
+
+/**
+ * struct ipc_os_host_priv - host OS private data
+ * @id:		private data per instance
+ * @rx_cb:	upper layer rx callback function
+ */
+static struct ipc_os_host_priv {
+	struct ipc_os_host_instance id[IPC_SHM_MAX_INSTANCES];
+	int (*rx_cb)(const uint8_t instance, int budget);
+} priv;
+
+/* map shared memory file of the given address, created if needed */
+static void *ipc_os_host_map(uintptr_t addr, size_t size, int *fd)
+{
+	char name[IPC_OS_HOST_NAME_LEN];
+	void *shm;
+
+	snprintf(name, sizeof(name), IPC_OS_HOST_SHM_NAME,
+		 (unsigned long)addr);
+	*fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+	if (*fd < 0) {
+		shm_err("Can't open shared memory %s\n", name);
+		return NULL;
+	}
+
+	if (ftruncate(*fd, size)) {
+		shm_err("Can't resize shared memory %s\n", name);
+		close(*fd);
+		return NULL;
+	}
+
+	/* the file is kept open to be shared with other processes */
+	shm = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+	if (shm == MAP_FAILED) {
+		shm_err("Can't map shared memory %s\n", name);
+		close(*fd);
+		return NULL;
+	}
+
+	return shm;
+}
+
+/*
+ * Open doorbell of the given address, created if needed. Opening a FIFO for
+ * both reading and writing neither blocks until the other side opens it nor
+ * reports end of file when the other side exits.
+ */
+static int ipc_os_host_doorbell(uintptr_t addr)
+{
+	char name[IPC_OS_HOST_NAME_LEN];
+	int fd;
+
+	snprintf(name, sizeof(name), IPC_OS_HOST_FIFO_NAME,
+		 (unsigned long)addr);
+	if (mkfifo(name, 0600) && errno != EEXIST) {
+		shm_err("Can't create doorbell %s\n", name);
+		return -1;
+	}
+
+	fd = open(name, O_RDWR | O_NONBLOCK);
+	if (fd < 0)
+		shm_err("Can't open doorbell %s\n", name);
+
+	return fd;
+}
+
+/* Rx softirq thread */
+static void *ipc_os_host_softirq(void *arg)
+{
+	const uint8_t instance = (uintptr_t)arg;
+	const int budget = IPC_SOFTIRQ_BUDGET;
+	struct ipc_os_host_instance *id = &priv.id[instance];
+	char rings[IPC_SOFTIRQ_BUDGET];
+	fd_set fds;
+	int work;
+
+	ipc_os_rx_thread_init(instance);
+
+	while (1) {
+		/* sleep until the remote rings, consuming all pending rings */
+		FD_ZERO(&fds);
+		FD_SET(id->rx_fd, &fds);
+		if (select(id->rx_fd + 1, &fds, NULL, NULL, NULL) < 0)
+			continue;
+		while (read(id->rx_fd, rings, sizeof(rings)) > 0)
+			;
+
+		do {
+			work = priv.rx_cb(instance, budget);
+			/* work not done, yield and wait for reschedule */
+			sched_yield();
+		} while (work >= budget);
+
+		ipc_os_rx_event(instance);
+	}
+
+	return 0;
+}
+
+/**
+ * ipc_os_init() - OS specific initialization code
+ * @instance:	instance id
+ * @cfg:	configuration parameters
+ * @rx_cb:	Rx callback to be called from Rx softirq
+ *
+ * Return: 0 on success, error code otherwise
+ */
+int ipc_os_init(const uint8_t instance, const struct ipc_shm_cfg *cfg,
+		int (*rx_cb)(const uint8_t, int))
+{
+	struct ipc_os_host_instance *id = &priv.id[instance];
+	int err;
+
+	if (!rx_cb)
+		return -EINVAL;
+
+	id->shm_size = cfg->shm_size;
+	priv.rx_cb = rx_cb;
+
+	id->local_virt_shm = ipc_os_host_map(cfg->local_shm_addr,
+					     cfg->shm_size, &id->local_shm_fd);
+	if (!id->local_virt_shm)
+		return -ENOMEM;
+
+	id->remote_virt_shm = ipc_os_host_map(cfg->remote_shm_addr,
+					      cfg->shm_size,
+					      &id->remote_shm_fd);
+	if (!id->remote_virt_shm) {
+		err = -ENOMEM;
+		goto err_unmap_local_shm;
+	}
+
+	/* the remote rings the doorbell of its local memory, our remote */
+	id->rx_fd = ipc_os_host_doorbell(cfg->remote_shm_addr);
+	if (id->rx_fd < 0) {
+		err = -ENODEV;
+		goto err_unmap_remote_shm;
+	}
+
+	id->tx_fd = ipc_os_host_doorbell(cfg->local_shm_addr);
+	if (id->tx_fd < 0) {
+		err = -ENODEV;
+		goto err_close_rx_fd;
+	}
+
+	ipc_os_rx_event_init(instance);
+
+	err = pthread_create(&id->irq_thread_id, NULL, ipc_os_host_softirq,
+			     (void *)(uintptr_t)instance);
+	if (err) {
+		shm_err("Can't start Rx softirq thread\n");
+		err = -err;
+		goto err_free_rx_event;
+	}
+
+	return 0;
+
+err_free_rx_event:
+	ipc_os_rx_event_free(instance);
+	close(id->tx_fd);
+err_close_rx_fd:
+	close(id->rx_fd);
+err_unmap_remote_shm:
+	munmap(id->remote_virt_shm, id->shm_size);
+	close(id->remote_shm_fd);
+err_unmap_local_shm:
+	munmap(id->local_virt_shm, id->shm_size);
+	close(id->local_shm_fd);
+
+	return err;
+}
+
+/**
+ * ipc_os_free() - free OS specific resources
+ */
+void ipc_os_free(const uint8_t instance)
+{
+	struct ipc_os_host_instance *id = &priv.id[instance];
+	void *res;
+
+	pthread_cancel(id->irq_thread_id);
+	pthread_join(id->irq_thread_id, &res);
+
+	close(id->tx_fd);
+	close(id->rx_fd);
+
+	munmap(id->remote_virt_shm, id->shm_size);
+	munmap(id->local_virt_shm, id->shm_size);
+	close(id->remote_shm_fd);
+	close(id->local_shm_fd);
+
+	ipc_os_rx_event_free(instance);
+}
+
+/**
+ * ipc_os_get_local_shm() - get local shared mem address
+ */
+uintptr_t ipc_os_get_local_shm(const uint8_t instance)
+{
+	return (uintptr_t)priv.id[instance].local_virt_shm;
+}
+
+/**
+ * ipc_os_get_remote_shm() - get remote shared mem address
+ */
+uintptr_t ipc_os_get_remote_shm(const uint8_t instance)
+{
+	return (uintptr_t)priv.id[instance].remote_virt_shm;
+}
+
+/**
+ * ipc_os_get_shm_fd() - get file mapping local or remote shared memory
+ * @instance:	instance id
+ * @remote:	true for remote ShM, false for local ShM
+ * @offset:	ShM offset in the file
+ *
+ * Return: file descriptor, error code otherwise
+ */
+int ipc_os_get_shm_fd(const uint8_t instance, bool remote, off_t *offset)
+{
+	*offset = 0;
+
+	return remote ? priv.id[instance].remote_shm_fd
+		      : priv.id[instance].local_shm_fd;
+}
+
+/**
+ * ipc_os_poll_channels() - invoke rx callback configured at initialization
+ *
+ * Not implemented for Linux.
+ *
+ * Return: work done, error code otherwise
+ */
+int ipc_os_poll_channels(const uint8_t instance)
+{
+	return -EOPNOTSUPP;
+}
+
+/**
+ * ipc_hw_irq_enable() - enable notifications from remote
+ *
+ * Rings are kept in the doorbell until read, none is lost.
+ */
+void ipc_hw_irq_enable(const uint8_t instance)
+{
+}
+
+/**
+ * ipc_hw_irq_disable() - disable notifications from remote
+ */
+void ipc_hw_irq_disable(const uint8_t instance)
+{
+}
+
+/**
+ * ipc_hw_irq_notify() - notify remote that data is available
+ *
+ * A full doorbell already has rings pending, so failing to write is harmless.
+ * Deferred while the calling thread has a notification batch open.
+ */
+void ipc_hw_irq_notify(const uint8_t instance)
+{
+	const char ring = 1;
+	ssize_t ret;
+
+	if (ipc_os_notify_batched(instance))
+		return;
+
+	ret = write(priv.id[instance].tx_fd, &ring, sizeof(ring));
+	if (ret != sizeof(ring)) {
+		shm_dbg_ch(instance, IPC_SHM_LOG_ALL,
+			   "Doorbell of instance %d is full\n", instance);
+	}
+}
+
+int ipc_hw_init(const uint8_t instance, const struct ipc_shm_cfg *cfg)
+{
+	/* nothing to do: doorbells are opened with the shared memory */
+	return 0;
+}
+
+void ipc_hw_free(const uint8_t instance)
+{
+}
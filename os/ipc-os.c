@@ -1,6 +1,6 @@
 /* SPDX-License-Identifier: BSD-3-Clause */
 /*
- * Copyright 2019-2023 NXP
+ * Copyright 2019-2023,2026 NXP
  */
 #include <fcntl.h>
 #include <unistd.h>
@@ -25,11 +25,6 @@
 
 #define RX_SOFTIRQ_POLICY	SCHED_FIFO
 
-/*
- * Maximum number of instances
- */
-#define IPC_SHM_MAX_INSTANCES	4u
-
 /* system call wrappers for loading and unloading kernel modules */
 #define finit_module(fd, param_values, flags) \
 	syscall(__NR_finit_module, fd, param_values, flags)
@@ -45,6 +40,8 @@
  * @remote_shm_map:	remote ShM mapped page address
  * @local_shm_offset:	local ShM offset in mapped page
  * @remote_shm_offset:	remote ShM offset in mapped page
+ * @local_shm_addr:	local ShM physical address
+ * @remote_shm_addr:	remote ShM physical address
  * @rx_cb:		upper layer Rx callback function
  * @irq_thread_id:	Rx interrupt thread id
  * @uio_fd:		UIO device file descriptor
@@ -58,6 +55,8 @@ struct ipc_os_priv_instance {
 	void *remote_shm_map;
 	size_t local_shm_offset;
 	size_t remote_shm_offset;
+	uintptr_t local_shm_addr;
+	uintptr_t remote_shm_addr;
 	int (*rx_cb)(const uint8_t instance, int budget);
 	pthread_t irq_thread_id;
 	int uio_fd;
@@ -171,6 +170,8 @@ static void *ipc_shm_softirq(void *arg)
 	int work;
 	uint8_t i = 0;
 
+	ipc_os_rx_thread_init((uintptr_t)arg);
+
 	while (1) {
 		/* block(sleep) until notified from kernel IRQ handler */
 		for (i = 0; i < IPC_SHM_MAX_INSTANCES; i++) {
@@ -183,6 +184,9 @@ static void *ipc_shm_softirq(void *arg)
 				sched_yield();
 			} while (work >= budget);
 
+			if (priv.id[i].uio_fd != 0)
+				ipc_os_rx_event(i);
+
 			/* re-enable irq */
 			ipc_hw_irq_enable(i);
 		}
@@ -213,15 +217,20 @@ int ipc_os_init(const uint8_t instance, const struct ipc_shm_cfg *cfg,
 	if (!rx_cb)
 		return -EINVAL;
 
+	ipc_os_rx_event_init(instance);
+
 	/* save params */
 	priv.id[instance].shm_size = cfg->shm_size;
+	priv.id[instance].local_shm_addr = cfg->local_shm_addr;
+	priv.id[instance].remote_shm_addr = cfg->remote_shm_addr;
 	priv.rx_cb = rx_cb;
 
 	/* open ipc-uio kernel module */
 	ipc_uio_module_fd = open(IPC_UIO_MODULE_PATH, O_RDONLY);
 	if (ipc_uio_module_fd == -1) {
 		shm_err("Can't open %s module\n", IPC_UIO_MODULE_PATH);
-		return -ENODEV;
+		err = -ENODEV;
+		goto err_free_rx_event;
 	}
 
 	/* load ipc-uio kernel module passing down hw initialization params */
@@ -325,7 +334,7 @@ int ipc_os_init(const uint8_t instance, const struct ipc_shm_cfg *cfg,
 	}
 
 	err = pthread_create(&priv.id[instance].irq_thread_id, &irq_thread_attr,
-			     ipc_shm_softirq, &priv);
+			     ipc_shm_softirq, (void *)(uintptr_t)instance);
 	if (err == -1) {
 		shm_err("Can't start Rx softirq thread\n");
 		goto err_close_uio_dev;
@@ -348,6 +357,8 @@ err_close_mem_dev:
 	close(priv.id[instance].mem_fd);
 err_close_ipc_shm_uio:
 	close(ipc_uio_module_fd);
+err_free_rx_event:
+	ipc_os_rx_event_free(instance);
 
 	return err;
 }
@@ -378,6 +389,8 @@ void ipc_os_free(const uint8_t instance)
 
 	close(priv.id[instance].mem_fd);
 
+	ipc_os_rx_event_free(instance);
+
 	/* unload ipc-uio kernel module */
 	if (delete_module(IPC_UIO_MODULE_NAME, O_NONBLOCK) != 0) {
 		shm_err("Can't unload %s module\n", IPC_UIO_MODULE_NAME);
@@ -400,6 +413,25 @@ uintptr_t ipc_os_get_remote_shm(const uint8_t instance)
 	return (uintptr_t)priv.id[instance].remote_virt_shm;
 }
 
+/**
+ * ipc_os_get_shm_fd() - get file mapping local or remote shared memory
+ * @instance:	instance id
+ * @remote:	true for remote ShM, false for local ShM
+ * @offset:	ShM offset in the file, not page aligned
+ *
+ * The file descriptor stays owned by the OS layer; other processes given a
+ * duplicate can map the same shared memory.
+ *
+ * Return: file descriptor, error code otherwise
+ */
+int ipc_os_get_shm_fd(const uint8_t instance, bool remote, off_t *offset)
+{
+	*offset = remote ? priv.id[instance].remote_shm_addr
+			 : priv.id[instance].local_shm_addr;
+
+	return priv.id[instance].mem_fd;
+}
+
 /**
  * ipc_os_poll_channels() - invoke rx callback configured at initialization
  *
@@ -440,9 +472,14 @@ void ipc_hw_irq_disable(const uint8_t instance)
 
 /**
  * ipc_hw_irq_notify() - notify remote that data is available
+ *
+ * Deferred while the calling thread has a notification batch open.
  */
 void ipc_hw_irq_notify(const uint8_t instance)
 {
+	if (ipc_os_notify_batched(instance))
+		return;
+
 	ipc_send_uio_cmd(priv.id[instance].uio_fd, IPC_UIO_TRIGGER_TX_IRQ_CMD);
 }
 
@@ -1,6 +1,6 @@
 /* SPDX-License-Identifier: BSD-3-Clause */
 /*
- * Copyright 2019,2021 NXP
+ * Copyright 2019,2021,2026 NXP
  */
 #ifndef IPC_OS_H
 #define IPC_OS_H
@@ -10,23 +10,39 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+#include <sys/types.h>
+
+#include "ipc-atomic.h"
+#include "ipc-log.h"
 
 /* softirq work budget used to prevent CPU starvation */
 #define IPC_SOFTIRQ_BUDGET 128u
 
-/* convenience wrappers for printing errors and debug messages */
+/*
+ * Maximum number of instances
+ */
+#define IPC_SHM_MAX_INSTANCES	4u
+
+/* maximum number of functions called after each Rx softirq pass */
+#define IPC_OS_MAX_RX_EVENT_HOOKS 4u
+
+/*
+ * convenience wrappers for logging errors and debug messages, formatted in the
+ * background with pr_fmt(), see ext/ipc-log.h
+ */
 #define pr_fmt(fmt) "ipc-shm-us-lib: %s(): "fmt
-#define shm_err(fmt, ...) printf(pr_fmt(fmt), __func__, ##__VA_ARGS__)
-#ifdef DEBUG
-#define shm_dbg(fmt, ...) printf(pr_fmt(fmt), __func__, ##__VA_ARGS__)
-#else
-#define shm_dbg(fmt, ...)
-#endif
-
-#define readl_relaxed(addr) *(addr)
-#define readw_relaxed(addr) *(addr)
-#define writel_relaxed(val, addr) *(addr) = (val)
-#define writew_relaxed(val, addr) *(addr) = (val)
+#define shm_err(fmt, ...) \
+	shm_log(IPC_SHM_LOG_ERR, IPC_SHM_LOG_ALL, IPC_SHM_LOG_ALL, fmt, \
+		##__VA_ARGS__)
+#define shm_dbg(fmt, ...) \
+	shm_log(IPC_SHM_LOG_DBG, IPC_SHM_LOG_ALL, IPC_SHM_LOG_ALL, fmt, \
+		##__VA_ARGS__)
+/* messages of a channel, following its log level */
+#define shm_err_ch(instance, chan_id, fmt, ...) \
+	shm_log(IPC_SHM_LOG_ERR, instance, chan_id, fmt, ##__VA_ARGS__)
+#define shm_dbg_ch(instance, chan_id, fmt, ...) \
+	shm_log(IPC_SHM_LOG_DBG, instance, chan_id, fmt, ##__VA_ARGS__)
 
 /* forward declarations */
 struct ipc_shm_cfg;
@@ -38,5 +54,20 @@ void ipc_os_free(const uint8_t instance);
 uintptr_t ipc_os_get_local_shm(const uint8_t instance);
 uintptr_t ipc_os_get_remote_shm(const uint8_t instance);
 int ipc_os_poll_channels(const uint8_t instance);
+int ipc_os_get_shm_fd(const uint8_t instance, bool remote, off_t *offset);
+uint32_t ipc_os_rx_event_seq(const uint8_t instance);
+int ipc_os_rx_event_wait(const uint8_t instance, uint32_t seq,
+		const struct timespec *abstime);
+int ipc_os_add_rx_event_hook(void (*hook)(const uint8_t instance));
+void ipc_os_del_rx_event_hook(void (*hook)(const uint8_t instance));
+void ipc_os_notify_batch_begin(void);
+void ipc_os_notify_batch_end(void);
+
+/* Rx event helpers shared by OS backends */
+void ipc_os_rx_event_init(const uint8_t instance);
+void ipc_os_rx_event_free(const uint8_t instance);
+void ipc_os_rx_thread_init(const uint8_t instance);
+void ipc_os_rx_event(const uint8_t instance);
+bool ipc_os_notify_batched(const uint8_t instance);
 
 #endif /* IPC_OS_H */
@@ -1,20 +1,32 @@
 /* SPDX-License-Identifier: BSD-3-Clause */
 /*
- * Copyright 2019-2023 NXP
+ * Copyright 2019-2023,2026 NXP
  */
+#define _GNU_SOURCE
 #include <errno.h>
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <stdbool.h>
 #include <semaphore.h>
 #include <signal.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/stat.h>
 
 #include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-flowctl.h"
+#include "ipc-prof.h"
+#include "ipc-rpc.h"
+#include "ipc-capture.h"
+#include "ipc-io.h"
 #include "ipcf_Ip_Cfg.h"
 
 #define IPC_SHM_DEV_MEM_NAME    "/dev/mem"
@@ -31,6 +43,17 @@
 #define MAX_SAMPLE_MSG_LEN 32
 #define L_BUF_LEN 4096
 #define IPC_SHM_SIZE 0x100000
+#define ACQUIRE_TIMEOUT_MS 1000
+#define BENCH_MSGS 10000
+#define BENCH_TIMEOUT_MS 1000
+#define BENCH_METHOD 0
+#define NSEC_PER_SEC 1000000000L
+#define NSEC_PER_USEC 1000L
+#define GEN_WINDOW 16
+#define GEN_LAT_BUCKETS 4096
+#define GEN_MAX_SIZES (IPC_SHM_MAX_CHANNELS * IPC_SHM_MAX_POOLS)
+#define CAPTURE_MAX_SIZE (64u << 20)
+#define CAPTURE_PAYLOAD_MAX 256u
 
 /* convenience wrappers for printing messages */
 #define pr_fmt(fmt) "ipc-shm-us-app: %s(): "fmt
@@ -46,12 +69,6 @@
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
 #endif
 
-#ifndef IPC_MEMCPY_BYTES_ALIGNED
-#define IPC_MEMCPY_BYTES_ALIGNED 8
-#endif
-
-#define IS_ALIGNED(x, a) (((x) & ((typeof(x))(a) - 1)) == 0)
-
 static int msg_sizes[IPC_SHM_MAX_POOLS] = {MAX_SAMPLE_MSG_LEN};
 static int msg_sizes_count = 1;
 
@@ -69,6 +86,16 @@ static int msg_sizes_count = 1;
  * @local_shm_map:		local ShM mapped page address
  * @sema:				binary semaphore for sync send_msg func with shm_rx_cb
  * @instance:			instance id
+ * @prof_path:			traffic profile output file, NULL if not profiling
+ * @bench_window:		RPC benchmark maximum window, 0 if not benchmarking
+ * @gen_msgs:			traffic generator messages, 0 if not generating
+ * @gen_window:			traffic generator outstanding messages
+ * @gen_rate:			traffic generator messages per second, 0 for max
+ * @gen_threaded:		traffic generator sender thread per data channel
+ * @rx_copy:			data channels Rx callbacks get cached copies
+ * @capture_path:		capture output file, NULL if not capturing
+ * @replay_path:		capture file to replay, NULL if not replaying
+ * @replay_fast:		replay as fast as possible, not at capture timing
  */
 static struct ipc_sample_app {
 	int num_channels;
@@ -83,22 +110,147 @@ static struct ipc_sample_app {
 	int *local_shm_map;
 	sem_t sema;
 	uint8_t instance;
+	const char *prof_path;
+	int bench_window;
+	int gen_msgs;
+	int gen_window;
+	int gen_rate;
+	bool gen_threaded;
+	bool rx_copy;
+	const char *capture_path;
+	const char *replay_path;
+	bool replay_fast;
 } app;
 
+/**
+ * struct ipc_sample_bench - RPC benchmark private data
+ * @window:	free slots of the window of outstanding calls
+ * @failed:	number of failed calls
+ */
+static struct ipc_sample_bench {
+	sem_t window;
+	int failed;
+} bench;
+
+/**
+ * struct gen_msg_hdr - traffic generator message header, echoed by remote
+ * @seq:	message number
+ * @size:	message size
+ * @tx_ns:	send time in ns of CLOCK_MONOTONIC
+ */
+struct gen_msg_hdr {
+	uint32_t seq;
+	uint32_t size;
+	uint64_t tx_ns;
+};
+
+/**
+ * struct gen_size - message size range of the traffic generator mix
+ * @chan_id:	channel
+ * @min:	smallest message size
+ * @max:	largest message size
+ */
+struct gen_size {
+	int chan_id;
+	uint32_t min;
+	uint32_t max;
+};
+
+/**
+ * struct gen_sender - traffic generator sender
+ * @thread:	sender thread, multi-threaded mode only
+ * @cpu:	core the sender thread is pinned to
+ * @window:	free slots of the window of outstanding messages
+ * @sizes:	message size ranges used by the sender
+ * @num_sizes:	number of message size ranges
+ * @num_msgs:	number of messages to send
+ * @sent:	number of messages sent
+ * @tx_bytes:	bytes sent
+ * @err:	error code of the sender
+ */
+struct gen_sender {
+	pthread_t thread;
+	int cpu;
+	sem_t window;
+	const struct gen_size *sizes;
+	int num_sizes;
+	int num_msgs;
+	int sent;
+	uint64_t tx_bytes;
+	int err;
+};
+
+/**
+ * struct ipc_sample_gen - traffic generator private data
+ * @num_sizes:	number of message size ranges
+ * @sizes:	message size ranges, one per data channel pool, by channel
+ * @chan_sizes:	first message size range of each channel
+ * @chan_num_sizes: number of message size ranges of each channel
+ * @num_senders: number of senders of current run
+ * @senders:	senders of current run
+ * @sender_of:	sender of each channel, whose window replies free
+ * @received:	number of echo replies received
+ * @rx_bytes:	bytes received
+ * @lat_min:	minimum round trip latency in ns
+ * @lat_max:	maximum round trip latency in ns
+ * @lat_sum:	sum of round trip latencies in ns
+ * @lat_hist:	round trip latency histogram in us, last bucket for overflow
+ */
+static struct ipc_sample_gen {
+	int num_sizes;
+	struct gen_size sizes[GEN_MAX_SIZES];
+	int chan_sizes[IPC_SHM_MAX_CHANNELS];
+	int chan_num_sizes[IPC_SHM_MAX_CHANNELS];
+	int num_senders;
+	struct gen_sender senders[IPC_SHM_MAX_CHANNELS];
+	struct gen_sender *sender_of[IPC_SHM_MAX_CHANNELS];
+	int received;
+	uint64_t rx_bytes;
+	uint64_t lat_min;
+	uint64_t lat_max;
+	uint64_t lat_sum;
+	uint32_t lat_hist[GEN_LAT_BUCKETS];
+} gen;
+
+/**
+ * struct ipc_sample_replay - capture replay private data
+ * @map:	capture file mapping, NULL if not replaying
+ * @map_size:	capture file size
+ * @pos:	offset of the next record
+ * @end:	end of the records
+ * @first_ns:	capture time of the first replayed message
+ * @start_ns:	replay time of the first replayed message
+ */
+static struct ipc_sample_replay {
+	const char *map;
+	size_t map_size;
+	size_t pos;
+	size_t end;
+	uint64_t first_ns;
+	uint64_t start_ns;
+} replay;
+
 /* link with generated variables */
 const void *rx_cb_arg = &app;
 
 /* Init IPC shared memory driver (see ipc-shm.h for API) */
 static int init_ipc_shm(void)
 {
-	int err;
+	int err, ch;
 
-	err = ipc_shm_init(&ipcf_shm_instances_cfg);
+	err = ipc_shm_ext_init(&ipcf_shm_instances_cfg);
 	if (err)
 		return err;
 
 	app.num_channels = ipcf_shm_instances_cfg.shm_cfg[0].num_channels;
 
+	/* data channels Rx callbacks get cached copies in copy-out mode */
+	for (ch = CTRL_CHAN_ID + 1; ch < app.num_channels; ch++) {
+		err = ipc_shm_ext_set_rx_copy(app.instance, ch, app.rx_copy);
+		if (err)
+			return err;
+	}
+
 	/* acquire control channel memory once */
 	app.ctrl_shm = ipc_shm_unmanaged_acquire(app.instance, CTRL_CHAN_ID);
 	if (!app.ctrl_shm) {
@@ -109,70 +261,6 @@ static int init_ipc_shm(void)
 	return 0;
 }
 
-/*
- * ipc implementation of memcpy to IO memory space
- */
-void ipc_memcpy_toio(void *dst, void *buf, size_t count)
-{
-	static int bytes_aligned = IPC_MEMCPY_BYTES_ALIGNED;
-	/* Cast to char* as memcpy copy each bytes */
-	char *dst_casted = (char *)dst;
-	char *buf_casted = (char *)buf;
-
-	while (count && !IS_ALIGNED((unsigned long)dst_casted, bytes_aligned)) {
-		*dst_casted = *buf_casted;
-		dst_casted += 1;
-		buf_casted += 1;
-		count--;
-	}
-
-	while (count >= bytes_aligned) {
-		memcpy(dst_casted, buf_casted, bytes_aligned);
-		dst_casted += bytes_aligned;
-		buf_casted += bytes_aligned;
-		count -= bytes_aligned;
-	}
-
-	while (count) {
-		*dst_casted = *buf_casted;
-		dst_casted += 1;
-		buf_casted += 1;
-		count--;
-	}
-}
-
-/*
- * ipc implementation of memcpy from IO memory space
- */
-void ipc_memcpy_fromio(void *dst, void *buf, size_t count)
-{
-	static int bytes_aligned = IPC_MEMCPY_BYTES_ALIGNED;
-	/* Cast to char* as memcpy copy each bytes */
-	char *dst_casted = (char *)dst;
-	char *buf_casted = (char *)buf;
-
-	while (count && !IS_ALIGNED((unsigned long)buf_casted, bytes_aligned)) {
-		*dst_casted = *buf_casted;
-		dst_casted += 1;
-		buf_casted += 1;
-		count--;
-	}
-
-	while (count >= bytes_aligned) {
-		memcpy(dst_casted, buf_casted, bytes_aligned);
-		dst_casted += bytes_aligned;
-		buf_casted += bytes_aligned;
-		count -= bytes_aligned;
-	}
-
-	while (count) {
-		*dst_casted = *buf_casted;
-		dst_casted += 1;
-		buf_casted += 1;
-		count--;
-	}
-}
-
 /*
  * data channel Rx callback: print message, release buffer and signal the
  * completion variable.
@@ -187,15 +275,17 @@ void data_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
 	assert(data_size <= MAX_SAMPLE_MSG_LEN);
 
 	/* process the received data */
-	ipc_memcpy_fromio(tmp, (char *)buf, data_size);
+	ipc_copy_fromio(tmp, buf, data_size);
 	sample_info("ch %d << %ld bytes: %s\n", chan_id, data_size, tmp);
 
-	/* consume received data: get number of message */
-	/* Note: without being copied locally */
+	/*
+	 * consume received data: get number of message
+	 * Note: without being copied locally, unless in copy-out mode (-c)
+	 */
 	app.last_rx_no_msg = strtol((char *)buf + strlen("#"), &endptr, 10);
 
 	/* release the buffer */
-	err = ipc_shm_release_buf(instance, chan_id, buf);
+	err = ipc_shm_ext_release_buf(instance, chan_id, buf);
 	if (err) {
 		sample_err("failed to free buffer for channel %d,"
 			    "err code %d\n", chan_id, err);
@@ -217,7 +307,7 @@ void ctrl_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
 	assert(chan_id == CTRL_CHAN_ID);
 	assert(strlen(mem) <= CTRL_CHAN_SIZE);
 
-	ipc_memcpy_fromio(tmp, (char *)mem, CTRL_CHAN_SIZE);
+	ipc_copy_fromio(tmp, mem, CTRL_CHAN_SIZE);
 	sample_info("ch %d << %ld bytes: %s\n", chan_id, strlen(tmp), tmp);
 
 	/* notify run_demo() the ctrl reply was received and demo can end */
@@ -235,7 +325,7 @@ static int send_ctrl_msg(const uint8_t instance)
 
 	/* Write number of messages to be sent in control channel memory */
 	sprintf(tmp, "SENDING MESSAGES: %d", app.num_msgs);
-	ipc_memcpy_toio(app.ctrl_shm, tmp, CTRL_CHAN_SIZE);
+	ipc_copy_toio(app.ctrl_shm, tmp, CTRL_CHAN_SIZE);
 
 	sample_info("ch %d >> %ld bytes: %s\n", chan_id, strlen(tmp), tmp);
 
@@ -267,7 +357,7 @@ static void generate_msg(char *dest, int len, int msg_no)
 	 */
 	int ret = snprintf(tmp, len, "#%d HELLO WORLD! FROM UIO", msg_no);
 
-	ipc_memcpy_toio(dest, tmp, ret);
+	ipc_copy_toio(dest, tmp, ret);
 }
 
 /**
@@ -285,7 +375,9 @@ static int send_data_msg(const uint8_t instance, int msg_len, int msg_no,
 	int err = 0;
 	char *buf = NULL;
 
-	buf = ipc_shm_acquire_buf(instance, chan_id, msg_len);
+	/* wait for remote to release a buffer if the pools are exhausted */
+	buf = ipc_shm_acquire_buf_timed(instance, chan_id, msg_len,
+					ACQUIRE_TIMEOUT_MS);
 	if (!buf) {
 		sample_err("failed to get buffer for channel ID"
 			   " %d and size %d\n", chan_id, msg_len);
@@ -296,12 +388,12 @@ static int send_data_msg(const uint8_t instance, int msg_len, int msg_no,
 	generate_msg(buf, msg_len, msg_no);
 
 	/* save data for comparison with echo reply */
-	ipc_memcpy_fromio(app.last_tx_msg, buf, msg_len);
+	ipc_copy_fromio(app.last_tx_msg, buf, msg_len);
 
 	sample_info("ch %d >> %d bytes: %s\n", chan_id, msg_len, app.last_tx_msg);
 
 	/* send data to remote peer */
-	err = ipc_shm_tx(instance, chan_id, buf, msg_len);
+	err = ipc_shm_ext_tx(instance, chan_id, buf, msg_len);
 	if (err) {
 		sample_err("tx failed for channel ID %d, size "
 			   "%d, error code %d\n", 0, msg_len, err);
@@ -353,6 +445,611 @@ static int run_demo(int num_msgs)
 	return 0;
 }
 
+static double elapsed_sec(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start->tv_sec)
+		+ (double)(now.tv_nsec - start->tv_nsec) / NSEC_PER_SEC;
+}
+
+/* RPC completion: count failures and free a window slot */
+static void bench_reply_cb(void *arg, int err, const void *reply,
+		size_t size)
+{
+	if (err)
+		__atomic_fetch_add(&bench.failed, 1, __ATOMIC_RELAXED);
+
+	sem_post(&bench.window);
+}
+
+/*
+ * Send BENCH_MSGS calls keeping up to window calls outstanding. Window 0 is
+ * the stop-and-wait baseline using synchronous calls.
+ */
+static void bench_run(int window, const char *req, size_t size)
+{
+	char reply[MAX_SAMPLE_MSG_LEN];
+	struct timespec start;
+	size_t reply_size;
+	double sec;
+	int i, n, err;
+
+	bench.failed = 0;
+	sem_init(&bench.window, 0, window);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (i = 0; i < BENCH_MSGS && app.num_msgs; i++) {
+		if (!window) {
+			reply_size = sizeof(reply);
+			err = ipc_shm_rpc_call(app.instance, BENCH_METHOD,
+					       req, size, reply, &reply_size,
+					       BENCH_TIMEOUT_MS);
+			if (err)
+				bench.failed++;
+			continue;
+		}
+
+		sem_wait(&bench.window);
+		/* retry while the remote holds all buffers */
+		do {
+			err = ipc_shm_rpc_call_async(app.instance,
+						     BENCH_METHOD, req, size,
+						     BENCH_TIMEOUT_MS,
+						     bench_reply_cb, NULL);
+			if (err == -ENOMEM)
+				sched_yield();
+		} while (err == -ENOMEM);
+		if (err) {
+			sample_err("call failed with error code %d\n", err);
+			sem_post(&bench.window);
+			break;
+		}
+	}
+
+	/* wait for outstanding calls */
+	for (n = 0; n < window; n++)
+		sem_wait(&bench.window);
+
+	sec = elapsed_sec(&start);
+	sem_destroy(&bench.window);
+
+	if (window)
+		sample_info("window %-4d", window);
+	else
+		sample_info("stop-and-wait");
+	printf(" %6d calls %9.0f calls/s %5d failed\n",
+	       i, sec > 0 ? i / sec : 0, bench.failed);
+}
+
+/*
+ * RPC benchmark: echo calls over all data channels with a window of
+ * outstanding calls doubling up to max_window, against stop-and-wait.
+ */
+static int run_bench(int max_window)
+{
+	int chan_ids[IPC_SHM_MAX_CHANNELS];
+	char req[MAX_SAMPLE_MSG_LEN - sizeof(struct ipc_rpc_hdr)] = "BENCH";
+	int num_chans = 0;
+	int window, runs = 1;
+	int err, ch;
+
+	for (ch = CTRL_CHAN_ID + 1; ch < app.num_channels; ch++)
+		chan_ids[num_chans++] = ch;
+
+	err = ipc_shm_rpc_init(app.instance, chan_ids, num_chans);
+	if (err)
+		return err;
+
+	/* signal number of messages to remote via control channel */
+	for (window = 1; window <= max_window; window *= 2)
+		runs++;
+	app.num_msgs = runs * BENCH_MSGS;
+	err = send_ctrl_msg(app.instance);
+	if (err)
+		goto out;
+
+	bench_run(0, req, sizeof(req));
+	for (window = 1; window <= max_window; window *= 2)
+		bench_run(window, req, sizeof(req));
+
+	/* wait for ctrl msg reply */
+	if (app.num_msgs)
+		sem_wait(&app.sema);
+
+out:
+	ipc_shm_rpc_free(app.instance);
+
+	return err;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+/*
+ * traffic generator data channel Rx callback: account echo reply, release
+ * buffer and free a window slot of the channel sender. Runs silently on the
+ * Rx thread.
+ */
+static void gen_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t data_size)
+{
+	struct gen_msg_hdr hdr;
+	uint64_t lat;
+
+	if (data_size >= sizeof(hdr)) {
+		ipc_copy_fromio(&hdr, buf, sizeof(hdr));
+		lat = now_ns() - hdr.tx_ns;
+
+		if (!gen.received || lat < gen.lat_min)
+			gen.lat_min = lat;
+		if (lat > gen.lat_max)
+			gen.lat_max = lat;
+		gen.lat_sum += lat;
+		gen.lat_hist[lat / NSEC_PER_USEC < GEN_LAT_BUCKETS ?
+			     lat / NSEC_PER_USEC : GEN_LAT_BUCKETS - 1]++;
+		gen.received++;
+		gen.rx_bytes += data_size;
+	}
+
+	ipc_shm_ext_release_buf(instance, chan_id, buf);
+	sem_post(&gen.sender_of[chan_id]->window);
+}
+
+/* build the message size mix from the pools of the data channels */
+static void gen_init_sizes(void)
+{
+	const struct ipc_shm_cfg *cfg = &ipcf_shm_instances_cfg.shm_cfg[0];
+	const struct ipc_shm_managed_cfg *managed;
+	struct gen_size *range;
+	uint32_t min;
+	int ch, p;
+
+	gen.num_sizes = 0;
+	for (ch = CTRL_CHAN_ID + 1; ch < app.num_channels; ch++) {
+		gen.chan_sizes[ch] = gen.num_sizes;
+		gen.chan_num_sizes[ch] = 0;
+		if (cfg->channels[ch].type != IPC_SHM_MANAGED)
+			continue;
+
+		/* messages fitting each pool, large enough for the header */
+		managed = &cfg->channels[ch].ch.managed;
+		min = sizeof(struct gen_msg_hdr);
+		for (p = 0; p < managed->num_pools; p++) {
+			if (managed->pools[p].buf_size < min)
+				continue;
+
+			range = &gen.sizes[gen.num_sizes++];
+			range->chan_id = ch;
+			range->min = min;
+			range->max = managed->pools[p].buf_size;
+			gen.chan_num_sizes[ch]++;
+			min = managed->pools[p].buf_size + 1;
+		}
+	}
+}
+
+/* latency in us below which the given permille of replies arrived */
+static int gen_lat_percentile(int permille)
+{
+	uint64_t count = 0;
+	int i;
+
+	for (i = 0; i < GEN_LAT_BUCKETS - 1; i++) {
+		count += gen.lat_hist[i];
+		if (count * 1000 >= (uint64_t)gen.received * permille)
+			break;
+	}
+
+	return i + 1;
+}
+
+/* wait for outstanding replies, false if some didn't arrive in time */
+static bool gen_drain(struct gen_sender *sender)
+{
+	struct timespec deadline;
+	int n, window = app.gen_window;
+
+	/* a slot of the failed message is still taken */
+	if (sender->err)
+		window--;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += ACQUIRE_TIMEOUT_MS / 1000 + 1;
+
+	for (n = 0; n < window; n++) {
+		if (sem_timedwait(&sender->window, &deadline))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * next captured message sent on a data channel of this instance and its time
+ * of replay, NULL at the end of the capture or at a malformed record, whose
+ * payload would overrun the record or the message buffer
+ */
+static const struct ipc_capture_rec *replay_next(struct timespec *due)
+{
+	const struct ipc_capture_rec *rec;
+	uint64_t due_ns;
+
+	while (replay.pos + sizeof(*rec) <= replay.end) {
+		rec = (const struct ipc_capture_rec *)(replay.map + replay.pos);
+		if (!rec->rec_len)
+			break;
+		if (rec->rec_len % 8u || rec->rec_len < sizeof(*rec)
+		    || rec->rec_len > replay.end - replay.pos
+		    || rec->payload_len > rec->rec_len - sizeof(*rec)
+		    || rec->payload_len > rec->size) {
+			sample_err("malformed record at offset %zu\n",
+				   replay.pos);
+			break;
+		}
+		replay.pos += rec->rec_len;
+
+		if (rec->dir != IPC_CAPTURE_TX || rec->instance != app.instance
+		    || rec->chan_id <= CTRL_CHAN_ID
+		    || rec->chan_id >= app.num_channels)
+			continue;
+
+		if (!replay.start_ns) {
+			replay.first_ns = rec->ts_ns;
+			replay.start_ns = now_ns();
+		}
+		due_ns = replay.start_ns + (rec->ts_ns - replay.first_ns);
+		due->tv_sec = due_ns / NSEC_PER_SEC;
+		due->tv_nsec = due_ns % NSEC_PER_SEC;
+
+		return rec;
+	}
+
+	return NULL;
+}
+
+/*
+ * Sender: send num_msgs messages with sizes drawn from its size ranges,
+ * keeping up to app.gen_window messages outstanding, at app.gen_rate
+ * messages per second or as fast as possible. When replaying a capture, the
+ * messages sent in the capture are sent instead, at their original timing
+ * unless app.replay_fast is set.
+ */
+static void *gen_send(void *arg)
+{
+	struct gen_sender *sender = arg;
+	const struct gen_size *range;
+	const struct ipc_capture_rec *rec = NULL;
+	struct gen_msg_hdr hdr;
+	unsigned int seed = sender->cpu + 1;
+	struct timespec next;
+	long period_ns = 0;
+	char *buf;
+	int i, chan_id;
+
+	if (app.gen_rate)
+		period_ns = NSEC_PER_SEC / app.gen_rate;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	for (i = 0; i < sender->num_msgs && app.num_msgs; i++) {
+		if (replay.map) {
+			rec = replay_next(&next);
+			if (!rec)
+				break;
+			if (!app.replay_fast)
+				clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+						&next, NULL);
+		} else if (period_ns) {
+			/* fixed rate: on schedule, catching up when late */
+			next.tv_nsec += period_ns;
+			while (next.tv_nsec >= NSEC_PER_SEC) {
+				next.tv_sec++;
+				next.tv_nsec -= NSEC_PER_SEC;
+			}
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next,
+					NULL);
+		}
+
+		sem_wait(&sender->window);
+
+		hdr.seq = i;
+		if (rec) {
+			/* replayed messages carry the header too */
+			chan_id = rec->chan_id;
+			hdr.size = rec->size > sizeof(hdr) ?
+				   rec->size : sizeof(hdr);
+		} else {
+			range = &sender->sizes[rand_r(&seed)
+					       % sender->num_sizes];
+			chan_id = range->chan_id;
+			hdr.size = range->min + rand_r(&seed)
+				   % (range->max - range->min + 1);
+		}
+
+		buf = ipc_shm_acquire_buf_timed(app.instance, chan_id,
+						hdr.size, ACQUIRE_TIMEOUT_MS);
+		if (!buf) {
+			sample_err("failed to get buffer for channel ID"
+				   " %d and size %u\n", chan_id, hdr.size);
+			sender->err = -ENOMEM;
+			break;
+		}
+
+		/*
+		 * captured payload after the header, within the buffer as
+		 * replay_next() checked it is no larger than the message
+		 */
+		if (rec && rec->payload_len > sizeof(hdr))
+			ipc_copy_toio(buf + sizeof(hdr),
+				      (char *)(rec + 1) + sizeof(hdr),
+				      rec->payload_len - sizeof(hdr));
+
+		hdr.tx_ns = now_ns();
+		ipc_copy_toio(buf, &hdr, sizeof(hdr));
+
+		sender->err = ipc_shm_ext_tx(app.instance, chan_id, buf,
+					     hdr.size);
+		if (sender->err) {
+			sample_err("tx failed for channel ID %d, size "
+				   "%u, error code %d\n", chan_id, hdr.size,
+				   sender->err);
+			ipc_shm_ext_discard_buf(app.instance, chan_id, buf,
+						hdr.size);
+			break;
+		}
+		sender->tx_bytes += hdr.size;
+	}
+	sender->sent = i;
+
+	return NULL;
+}
+
+/* start sender thread pinned to its core */
+static int gen_start_sender(struct gen_sender *sender)
+{
+	pthread_attr_t attr;
+	cpu_set_t cpus;
+	int err;
+
+	CPU_ZERO(&cpus);
+	CPU_SET(sender->cpu, &cpus);
+
+	pthread_attr_init(&attr);
+	err = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+	if (!err)
+		err = pthread_create(&sender->thread, &attr, gen_send, sender);
+	pthread_attr_destroy(&attr);
+
+	if (err)
+		sample_err("can't start sender on core %d\n", sender->cpu);
+
+	return -err;
+}
+
+/*
+ * Run num_senders senders, one per data channel on its own thread and core,
+ * or a single sender on the main thread over all data channels.
+ */
+static int gen_run(int num_senders, bool threaded, int msgs_per_sender)
+{
+	const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	struct gen_sender *sender;
+	struct timespec start;
+	uint64_t tx_bytes = 0;
+	bool drained = true;
+	int i, ch, sent = 0, err = 0;
+	double sec;
+
+	memset(gen.senders, 0, sizeof(gen.senders));
+	memset(gen.lat_hist, 0, sizeof(gen.lat_hist));
+	gen.received = 0;
+	gen.rx_bytes = 0;
+	gen.lat_sum = 0;
+	gen.lat_max = 0;
+	gen.num_senders = num_senders;
+
+	for (i = 0; i < num_senders; i++) {
+		sender = &gen.senders[i];
+		sender->num_msgs = msgs_per_sender;
+		sem_init(&sender->window, 0, app.gen_window);
+
+		if (threaded) {
+			ch = CTRL_CHAN_ID + 1 + i;
+			sender->cpu = i % num_cpus;
+			sender->sizes = &gen.sizes[gen.chan_sizes[ch]];
+			sender->num_sizes = gen.chan_num_sizes[ch];
+			gen.sender_of[ch] = sender;
+		} else {
+			sender->sizes = gen.sizes;
+			sender->num_sizes = gen.num_sizes;
+			for (ch = CTRL_CHAN_ID + 1; ch < app.num_channels; ch++)
+				gen.sender_of[ch] = sender;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (threaded) {
+		for (i = 0; i < num_senders && !err; i++)
+			err = gen_start_sender(&gen.senders[i]);
+		num_senders = i - (err ? 1 : 0);
+		for (i = 0; i < num_senders; i++)
+			pthread_join(gen.senders[i].thread, NULL);
+	} else {
+		gen_send(&gen.senders[0]);
+	}
+
+	for (i = 0; i < num_senders; i++) {
+		sender = &gen.senders[i];
+		drained &= gen_drain(sender);
+		sent += sender->sent;
+		tx_bytes += sender->tx_bytes;
+		if (!err)
+			err = sender->err;
+	}
+	sec = elapsed_sec(&start);
+
+	for (i = 0; i < gen.num_senders; i++)
+		sem_destroy(&gen.senders[i].window);
+
+	if (threaded)
+		sample_info("%d channels: ", num_senders);
+	else
+		sample_info("%s", "");
+	printf("sent %d messages, %llu bytes in %.3f s\n", sent,
+	       (unsigned long long)tx_bytes, sec);
+	sample_info("received %d replies%s, %.0f msgs/s, %.2f MB/s\n",
+		    gen.received, drained ? "" : " (some lost)",
+		    sec > 0 ? gen.received / sec : 0,
+		    sec > 0 ? (tx_bytes + gen.rx_bytes) / sec / 1e6 : 0);
+	if (gen.received)
+		sample_info("round trip us: min %.1f avg %.1f p50 %d "
+			    "p99 %d p99.9 %d max %.1f\n",
+			    (double)gen.lat_min / NSEC_PER_USEC,
+			    (double)gen.lat_sum / gen.received / NSEC_PER_USEC,
+			    gen_lat_percentile(500), gen_lat_percentile(990),
+			    gen_lat_percentile(999),
+			    (double)gen.lat_max / NSEC_PER_USEC);
+
+	return err;
+}
+
+/*
+ * Traffic generator: send app.gen_msgs messages silently and print a
+ * throughput and round trip latency summary. In multi-threaded mode, each
+ * data channel has its own sender thread pinned to its own core and the run
+ * is repeated with 1 up to all data channels, app.gen_msgs messages each.
+ */
+static int run_gen(void)
+{
+	int num_chans = app.num_channels - (CTRL_CHAN_ID + 1);
+	int n, ch, err = 0;
+
+	gen_init_sizes();
+	for (ch = CTRL_CHAN_ID + 1; ch < app.num_channels; ch++) {
+		if (!gen.chan_num_sizes[ch]) {
+			sample_err("no pool of channel %d fits generator "
+				   "messages\n", ch);
+			return -EINVAL;
+		}
+	}
+
+	for (ch = CTRL_CHAN_ID + 1; ch < app.num_channels; ch++)
+		ipc_shm_ext_set_rx_cb(app.instance, ch, gen_rx_cb, &app);
+
+	/* signal number of messages to remote via control channel */
+	app.num_msgs = app.gen_msgs;
+	if (app.gen_threaded)
+		app.num_msgs *= num_chans * (num_chans + 1) / 2;
+	err = send_ctrl_msg(app.instance);
+	if (err)
+		goto out;
+
+	if (!app.gen_threaded)
+		err = gen_run(1, false, app.gen_msgs);
+	for (n = 1; app.gen_threaded && n <= num_chans && !err; n++)
+		err = gen_run(n, true, app.gen_msgs);
+
+	/* wait for ctrl msg reply */
+	if (!err && app.num_msgs)
+		sem_wait(&app.sema);
+
+out:
+	for (ch = CTRL_CHAN_ID + 1; ch < app.num_channels; ch++)
+		ipc_shm_ext_set_rx_cb(app.instance, ch, data_chan_rx_cb,
+				      &app);
+
+	return err;
+}
+
+/*
+ * Capture replay: send the messages captured on the data channels to the
+ * remote echo with the traffic generator sender and print its summary.
+ */
+static int run_replay(void)
+{
+	const struct ipc_capture_hdr *hdr;
+	struct timespec due;
+	struct stat st;
+	int fd, ch, count = 0, err = 0;
+
+	fd = open(app.replay_path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st)) {
+		sample_err("can't open %s\n", app.replay_path);
+		err = -errno;
+		goto out_close;
+	}
+
+	replay.map_size = st.st_size;
+	replay.map = mmap(NULL, replay.map_size, PROT_READ, MAP_PRIVATE, fd,
+			  0);
+	if (replay.map == MAP_FAILED) {
+		replay.map = NULL;
+		err = -errno;
+		goto out_close;
+	}
+
+	hdr = (const struct ipc_capture_hdr *)replay.map;
+	if (replay.map_size < sizeof(*hdr) || hdr->magic != IPC_CAPTURE_MAGIC
+	    || hdr->version != IPC_CAPTURE_FORMAT_VERSION
+	    || hdr->hdr_size < sizeof(*hdr) || hdr->hdr_size % 8u
+	    || hdr->hdr_size > replay.map_size) {
+		sample_err("%s is not a capture file\n", app.replay_path);
+		err = -EINVAL;
+		goto out_unmap;
+	}
+
+	/* a capture not stopped ends at the first incomplete record */
+	replay.end = replay.map_size;
+	if (hdr->data_size && hdr->data_size <= replay.end - hdr->hdr_size)
+		replay.end = hdr->hdr_size + hdr->data_size;
+
+	replay.pos = hdr->hdr_size;
+	while (replay_next(&due))
+		count++;
+	if (!count) {
+		sample_err("no message to replay in %s\n", app.replay_path);
+		err = -EINVAL;
+		goto out_unmap;
+	}
+	replay.pos = hdr->hdr_size;
+	replay.start_ns = 0;
+
+	for (ch = CTRL_CHAN_ID + 1; ch < app.num_channels; ch++)
+		ipc_shm_ext_set_rx_cb(app.instance, ch, gen_rx_cb, &app);
+
+	/* signal number of messages to remote via control channel */
+	app.num_msgs = count;
+	err = send_ctrl_msg(app.instance);
+	if (!err)
+		err = gen_run(1, false, count);
+
+	/* wait for ctrl msg reply */
+	if (!err && app.num_msgs)
+		sem_wait(&app.sema);
+
+	for (ch = CTRL_CHAN_ID + 1; ch < app.num_channels; ch++)
+		ipc_shm_ext_set_rx_cb(app.instance, ch, data_chan_rx_cb,
+				      &app);
+
+out_unmap:
+	if (replay.map)
+		munmap((void *)replay.map, replay.map_size);
+	replay.map = NULL;
+out_close:
+	if (fd >= 0)
+		close(fd);
+
+	return err;
+}
+
 /*
  * interrupt signal handler for terminating the sample execution gracefully
  */
@@ -361,17 +1058,109 @@ void int_handler(int signum)
 	app.num_msgs = 0;
 }
 
-int main(int argc, char *argv[])
+/*
+ * Clear memory to re-init driver. On a host, the driver initializes the shared
+ * memory file again and the peer may still have it mapped.
+ */
+static void clear_local_shm(void)
 {
-	int err = 0;
-	struct sigaction sig_action;
-	app.instance = 0;
+#ifndef IPC_OS_HOST
 	size_t page_size = sysconf(_SC_PAGE_SIZE);
 	off_t page_phys_addr;
 	uintptr_t local_shm_addr = ipcf_shm_instances_cfg.shm_cfg->local_shm_addr;
 	uint32_t shm_size = ipcf_shm_instances_cfg.shm_cfg->shm_size;
 	int tmp[IPC_SHM_SIZE] = {0};
 
+	page_phys_addr = (local_shm_addr / page_size) * page_size;
+	app.local_shm_offset = local_shm_addr - page_phys_addr;
+	app.mem_fd = open(IPC_SHM_DEV_MEM_NAME, O_RDWR);
+
+	app.local_shm_map = mmap(NULL, app.local_shm_offset + shm_size,
+				  PROT_READ | PROT_WRITE, MAP_SHARED,
+				  app.mem_fd, page_phys_addr);
+
+	app.local_virt_shm = app.local_shm_map + app.local_shm_offset;
+
+	memcpy(app.local_virt_shm, tmp, shm_size);
+	munmap(app.local_shm_map, app.local_shm_offset + shm_size);
+	close(app.mem_fd);
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+	int err = 0;
+	int opt;
+	struct sigaction sig_action;
+	app.instance = 0;
+
+	app.gen_window = GEN_WINDOW;
+	while ((opt = getopt(argc, argv, "b:cC:g:mp:r:R:sw:h")) != -1) {
+		switch (opt) {
+		case 'b':
+			app.bench_window = atoi(optarg);
+			if (app.bench_window <= 0)
+				return -EINVAL;
+			break;
+		case 'c':
+			app.rx_copy = true;
+			break;
+		case 'C':
+			app.capture_path = optarg;
+			break;
+		case 'g':
+			app.gen_msgs = atoi(optarg);
+			if (app.gen_msgs <= 0)
+				return -EINVAL;
+			break;
+		case 'm':
+			app.gen_threaded = true;
+			break;
+		case 'p':
+			app.prof_path = optarg;
+			break;
+		case 'r':
+			app.gen_rate = atoi(optarg);
+			if (app.gen_rate < 0)
+				return -EINVAL;
+			break;
+		case 'R':
+			app.replay_path = optarg;
+			break;
+		case 's':
+			app.replay_fast = true;
+			break;
+		case 'w':
+			app.gen_window = atoi(optarg);
+			if (app.gen_window <= 0)
+				return -EINVAL;
+			break;
+		default:
+			printf("Usage: %s [-b window] [-c] [-g messages [-m] "
+			       "[-w window] [-r rate]] [-R capture [-s] "
+			       "[-w window]] [-C capture] [-p profile]\n"
+			       "  -b  run RPC benchmark up to window calls "
+			       "in flight and exit\n"
+			       "  -c  copy received messages to cached memory "
+			       "and release them before the callback\n"
+			       "  -g  generate traffic silently, print a "
+			       "summary and exit\n"
+			       "  -m  generator sender thread per data "
+			       "channel, pinned to its own core\n"
+			       "  -w  generator messages in flight "
+			       "(default %d)\n"
+			       "  -r  generator messages per second "
+			       "(default 0, as fast as possible)\n"
+			       "  -R  replay the messages sent in a capture "
+			       "file, print a summary and exit\n"
+			       "  -s  replay as fast as possible\n"
+			       "  -C  capture traffic to file\n"
+			       "  -p  record traffic profile to file on exit\n",
+			       argv[0], GEN_WINDOW);
+			return opt == 'h' ? 0 : -EINVAL;
+		}
+	}
+
 	sem_init(&app.sema, 0, 0);
 
 	/* init ipc shm driver */
@@ -379,11 +1168,35 @@ int main(int argc, char *argv[])
 	if (err)
 		return err;
 
+	if (app.prof_path) {
+		err = ipc_shm_prof_start();
+		if (err)
+			return err;
+	}
+
+	if (app.capture_path) {
+		err = ipc_shm_capture_start(app.capture_path, CAPTURE_MAX_SIZE,
+					    CAPTURE_PAYLOAD_MAX);
+		if (err)
+			return err;
+	}
+
 	/* catch interrupt signals to terminate the execution gracefully */
 	sig_action.sa_handler = int_handler;
 	sigaction(SIGINT, &sig_action, NULL);
 
 	app.num_msgs = 1;
+	if (app.bench_window) {
+		err = run_bench(app.bench_window);
+		app.num_msgs = 0;
+	} else if (app.gen_msgs) {
+		err = run_gen();
+		app.num_msgs = 0;
+	} else if (app.replay_path) {
+		err = run_replay();
+		app.num_msgs = 0;
+	}
+
 	while (app.num_msgs) {
 		printf("\nInput number of messages to send: ");
 		scanf("%d", &app.num_msgs);
@@ -396,22 +1209,18 @@ int main(int argc, char *argv[])
 			break;
 	}
 
-	ipc_shm_free();
-
-	/* Clear memory to re-init driver */
-	page_phys_addr = (local_shm_addr / page_size) * page_size;
-	app.local_shm_offset = local_shm_addr - page_phys_addr;
-	app.mem_fd = open(IPC_SHM_DEV_MEM_NAME, O_RDWR);
+	if (app.capture_path && ipc_shm_capture_stop())
+		sample_err("failed to write capture %s\n", app.capture_path);
 
-	app.local_shm_map = mmap(NULL, app.local_shm_offset + shm_size,
-				  PROT_READ | PROT_WRITE, MAP_SHARED,
-				  app.mem_fd, page_phys_addr);
+	if (app.prof_path) {
+		ipc_shm_prof_stop();
+		if (ipc_shm_prof_dump(app.prof_path))
+			sample_err("failed to write profile %s\n", app.prof_path);
+	}
 
-	app.local_virt_shm = app.local_shm_map + app.local_shm_offset;
+	ipc_shm_ext_free();
 
-	memcpy(app.local_virt_shm, tmp, shm_size);
-	munmap(app.local_shm_map, app.local_shm_offset + shm_size);
-	close(app.mem_fd);
+	clear_local_shm();
 
 	sem_destroy(&app.sema);
 
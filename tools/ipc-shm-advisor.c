@@ -0,0 +1,438 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ *
+ * Recommend buffer pool configurations from a profile recorded with
+ * ipc_shm_prof_dump().
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ipc-shm.h"
+#include "ipc-prof.h"
+#include "ipc-layout.h"
+
+#define MAX_INSTANCES		4
+#define MAX_CHANNELS		((int)IPC_SHM_MAX_CHANNELS)
+#define MAX_POOLS		((int)IPC_SHM_MAX_POOLS)
+#define MAX_OCCUPANCY		((int)IPC_PROF_MAX_OCCUPANCY)
+#define MAX_SIZES		((int)IPC_PROF_SIZE_BUCKETS)
+/* spare memory adds at most this many times the peak buffers in flight */
+#define FILL_HEADROOM		2u
+#define LINE_LEN		256
+
+#define pr_fmt(fmt) "ipc-shm-advisor: "fmt
+#define advisor_err(fmt, ...) fprintf(stderr, pr_fmt(fmt), ##__VA_ARGS__)
+
+
+/**
+ * struct size_count - message size histogram entry
+ * @max_size:	largest size of histogram bucket
+ * @count:	number of messages
+ */
+struct size_count {
+	uint32_t max_size;
+	uint32_t count;
+};
+
+/**
+ * struct pool_prof - profile of one buffer pool
+ * @buf_size:		configured buffer size
+ * @num_bufs:		configured number of buffers
+ * @peak:		peak received buffers in flight
+ * @occupancy:		histogram of received buffers in flight
+ * @new_size:		recommended buffer size
+ * @new_bufs:		recommended number of buffers
+ * @msgs:		messages that fit this pool first
+ */
+struct pool_prof {
+	uint32_t buf_size;
+	uint32_t num_bufs;
+	uint32_t peak;
+	uint64_t occupancy[MAX_OCCUPANCY + 1];
+	uint32_t new_size;
+	uint32_t new_bufs;
+	uint64_t msgs;
+};
+
+/**
+ * struct chan_prof - profile of one channel
+ * @valid:		channel present in profile
+ * @managed:		managed channel
+ * @unmanaged_size:	unmanaged channel memory size
+ * @num_pools:		number of pools
+ * @pools:		pools profile
+ * @sizes:		Tx and Rx message sizes histogram
+ * @num_sizes:		number of entries in @sizes
+ * @tx_fail:		failed acquire requests
+ * @tx_held_peak:	peak acquired buffers not yet transmitted
+ */
+struct chan_prof {
+	int valid;
+	int managed;
+	uint32_t unmanaged_size;
+	int num_pools;
+	struct pool_prof pools[MAX_POOLS];
+	struct size_count sizes[MAX_SIZES];
+	int num_sizes;
+	uint32_t tx_fail;
+	uint32_t tx_held_peak;
+};
+
+/**
+ * struct inst_prof - profile of one instance
+ * @valid:		instance present in profile
+ * @shm_size:		local shared memory size
+ * @num_channels:	number of channels
+ * @chan:		channels profile
+ */
+struct inst_prof {
+	int valid;
+	uint32_t shm_size;
+	int num_channels;
+	struct chan_prof chan[MAX_CHANNELS];
+};
+
+static struct inst_prof prof[MAX_INSTANCES];
+
+static int check_idx(int inst, int chan, int pool)
+{
+	return inst < 0 || inst >= MAX_INSTANCES || chan < 0
+	       || chan >= MAX_CHANNELS || pool < 0 || pool >= MAX_POOLS;
+}
+
+static int parse_line(const char *line)
+{
+	struct chan_prof *ch;
+	char dir[8], type[16];
+	uint32_t a, b;
+	int i, c, p, n;
+
+	if (sscanf(line, "inst %d shm_size %u channels %d", &i, &a, &n) == 3) {
+		if (check_idx(i, 0, 0) || n > MAX_CHANNELS)
+			return -EINVAL;
+		prof[i].valid = 1;
+		prof[i].shm_size = a;
+		prof[i].num_channels = n;
+	} else if (sscanf(line, "chan %d %d %15s %u", &i, &c, type, &a) == 4) {
+		if (check_idx(i, c, 0))
+			return -EINVAL;
+		ch = &prof[i].chan[c];
+		ch->valid = 1;
+		ch->managed = !strcmp(type, "managed");
+		if (ch->managed)
+			ch->num_pools = (int)a;
+		else
+			ch->unmanaged_size = a;
+		if (ch->num_pools > MAX_POOLS)
+			return -EINVAL;
+	} else if (sscanf(line, "pool %d %d %d %u %u", &i, &c, &p, &a, &b) == 5) {
+		if (check_idx(i, c, p))
+			return -EINVAL;
+		prof[i].chan[c].pools[p].buf_size = a;
+		prof[i].chan[c].pools[p].num_bufs = b;
+	} else if (sscanf(line, "size %d %d %7s %u %u",
+			  &i, &c, dir, &a, &b) == 5) {
+		if (check_idx(i, c, 0))
+			return -EINVAL;
+		ch = &prof[i].chan[c];
+		for (n = 0; n < ch->num_sizes; n++)
+			if (ch->sizes[n].max_size == a)
+				break;
+		if (n == ch->num_sizes) {
+			if (n == MAX_SIZES)
+				return -EINVAL;
+			ch->sizes[n].max_size = a;
+			ch->num_sizes++;
+		}
+		ch->sizes[n].count += b;
+	} else if (sscanf(line, "tx %d %d fail %u held_peak %u",
+			  &i, &c, &a, &b) == 4) {
+		if (check_idx(i, c, 0))
+			return -EINVAL;
+		prof[i].chan[c].tx_fail = a;
+		prof[i].chan[c].tx_held_peak = b;
+	} else if (sscanf(line, "rx %d %d %d peak %u", &i, &c, &p, &a) == 4) {
+		if (check_idx(i, c, p))
+			return -EINVAL;
+		prof[i].chan[c].pools[p].peak = a;
+	} else if (sscanf(line, "inflight %d %d %d %d %u",
+			  &i, &c, &p, &n, &a) == 5) {
+		if (check_idx(i, c, p) || n < 0 || n > MAX_OCCUPANCY)
+			return -EINVAL;
+		prof[i].chan[c].pools[p].occupancy[n] += a;
+	} else if (strncmp(line, "ipc-shm-prof ", 13) && line[0] != '\n') {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int load_profile(const char *path)
+{
+	char line[LINE_LEN];
+	int lineno = 0;
+	FILE *file;
+	int err = 0;
+
+	file = fopen(path, "r");
+	if (!file) {
+		advisor_err("can't open %s\n", path);
+		return -ENOENT;
+	}
+
+	if (!fgets(line, sizeof(line), file)
+	    || strncmp(line, "ipc-shm-prof 1", 14)) {
+		advisor_err("%s: unsupported profile format\n", path);
+		fclose(file);
+		return -EINVAL;
+	}
+
+	while (fgets(line, sizeof(line), file)) {
+		lineno++;
+		err = parse_line(line);
+		if (err) {
+			advisor_err("%s:%d: invalid line\n", path, lineno + 1);
+			break;
+		}
+	}
+
+	fclose(file);
+	return err;
+}
+
+/* probability that a received buffer finds more than n buffers in flight */
+static double tail_prob(const struct pool_prof *pool, uint32_t n)
+{
+	uint64_t total = 0, tail = 0;
+	int i;
+
+	for (i = 0; i <= MAX_OCCUPANCY; i++) {
+		total += pool->occupancy[i];
+		if ((uint32_t)i > n)
+			tail += pool->occupancy[i];
+	}
+
+	return total ? (double)tail / (double)total : 0.0;
+}
+
+static uint64_t chan_footprint(const struct chan_prof *ch)
+{
+	uint64_t size, total_bufs = 0;
+	int p;
+
+	if (!ch->managed)
+		return ch->unmanaged_size;
+
+	size = 0;
+	for (p = 0; p < ch->num_pools; p++) {
+		size += IPC_LAYOUT_POOL_SIZE((uint64_t)ch->pools[p].new_size,
+					     (uint64_t)ch->pools[p].new_bufs);
+		total_bufs += ch->pools[p].new_bufs;
+	}
+
+	return size + IPC_LAYOUT_MANAGED_SIZE(total_bufs);
+}
+
+/* shrink buffer sizes to the largest message seen by each pool */
+static void advise_sizes(struct chan_prof *ch)
+{
+	struct pool_prof *pool;
+	uint32_t lo, max_size, bucket;
+	int n, p;
+
+	for (p = 0; p < ch->num_pools; p++)
+		ch->pools[p].new_size = 0;
+
+	for (n = 0; n < ch->num_sizes; n++) {
+		/* smallest size of bucket decides which pool fits it first */
+		max_size = ch->sizes[n].max_size;
+		bucket = ipc_prof_size_bucket(max_size);
+		lo = bucket ? ipc_prof_size_bucket_max(bucket - 1u) + 1u : 0u;
+		for (p = 0; p < ch->num_pools - 1; p++)
+			if (ch->pools[p].buf_size >= lo)
+				break;
+		pool = &ch->pools[p];
+		if (max_size > pool->buf_size)
+			max_size = pool->buf_size;
+		if (max_size > pool->new_size)
+			pool->new_size = max_size;
+		pool->msgs += ch->sizes[n].count;
+	}
+
+	for (p = 0; p < ch->num_pools; p++) {
+		pool = &ch->pools[p];
+		/* keep unused pools and the largest pool size unchanged */
+		if (!pool->new_size || p == ch->num_pools - 1)
+			pool->new_size = pool->buf_size;
+		pool->new_size = IPC_LAYOUT_ALIGN(pool->new_size, IPC_LAYOUT_BUF_ALIGN);
+	}
+}
+
+/* smallest number of buffers meeting the target failure probability */
+static void advise_bufs(struct chan_prof *ch, double target)
+{
+	struct pool_prof *pool;
+	uint32_t n;
+	int p;
+
+	for (p = 0; p < ch->num_pools; p++) {
+		pool = &ch->pools[p];
+		for (n = 1; n < (uint32_t)MAX_OCCUPANCY; n++)
+			if (tail_prob(pool, n) <= target)
+				break;
+		if (n == (uint32_t)MAX_OCCUPANCY && pool->peak > n)
+			n = pool->peak;
+		pool->new_bufs = n;
+	}
+}
+
+/* spend spare shared memory on the pools most likely to run out */
+static void fill_spare(struct inst_prof *inst, uint64_t spare)
+{
+	struct chan_prof *ch, *best_ch;
+	struct pool_prof *pool;
+	double score, best;
+	uint64_t cost;
+	int c, p, best_p;
+
+	while (1) {
+		best = -1.0;
+		best_ch = NULL;
+		best_p = 0;
+		for (c = 0; c < inst->num_channels; c++) {
+			ch = &inst->chan[c];
+			if (!ch->managed)
+				continue;
+			for (p = 0; p < ch->num_pools; p++) {
+				pool = &ch->pools[p];
+				cost = pool->new_size + 2u * IPC_LAYOUT_BD_SIZE;
+				if (cost > spare || !pool->msgs
+				    || pool->new_bufs >= IPC_SHM_MAX_BUFS_PER_POOL
+				    || pool->new_bufs >= FILL_HEADROOM
+				       * (pool->peak ? pool->peak : 1u))
+					continue;
+				score = (tail_prob(pool, pool->new_bufs)
+					 + 1e-9 * pool->msgs) / cost;
+				if (score > best) {
+					best = score;
+					best_ch = ch;
+					best_p = p;
+				}
+			}
+		}
+		if (!best_ch)
+			break;
+
+		pool = &best_ch->pools[best_p];
+		pool->new_bufs++;
+		spare -= pool->new_size + 2u * IPC_LAYOUT_BD_SIZE;
+	}
+}
+
+static void print_chan(int i, int c, const struct chan_prof *ch)
+{
+	const struct pool_prof *pool;
+	int p;
+
+	printf("/* channel %d: %u failed acquires, %u buffers held before Tx */\n",
+	       c, ch->tx_fail, ch->tx_held_peak);
+	printf("/* Pools must be sorted in ascending order by buffer size */\n");
+	printf("static struct ipc_shm_pool_cfg ipcf_shm_cfg_buf_pools%d_%d[%d] = {\n",
+	       i, c, ch->num_pools);
+	for (p = 0; p < ch->num_pools; p++) {
+		pool = &ch->pools[p];
+		printf("\t{\n");
+		printf("\t\t.num_bufs = %u,\t/* was %u, peak %u, P(fail) %.2g */\n",
+		       pool->new_bufs, pool->num_bufs, pool->peak,
+		       tail_prob(pool, pool->new_bufs));
+		printf("\t\t.buf_size = %u,\t/* was %u */\n",
+		       pool->new_size, pool->buf_size);
+		printf("\t},\n");
+	}
+	printf("};\n\n");
+}
+
+static void usage(const char *name)
+{
+	printf("Usage: %s [-p probability] [-f] profile\n"
+	       "  -p  target probability that a buffer finds its pool empty\n"
+	       "      (default 0.001)\n"
+	       "  -f  spend spare shared memory on additional buffers, up to\n"
+	       "      twice the peak buffers in flight\n",
+	       name);
+}
+
+int main(int argc, char *argv[])
+{
+	struct inst_prof *inst;
+	struct chan_prof *ch;
+	double target = 0.001;
+	uint64_t used;
+	int fill = 0;
+	int opt, i, c;
+
+	while ((opt = getopt(argc, argv, "p:fh")) != -1) {
+		switch (opt) {
+		case 'p':
+			target = strtod(optarg, NULL);
+			break;
+		case 'f':
+			fill = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (optind != argc - 1 || target <= 0.0 || target >= 1.0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (load_profile(argv[optind]))
+		return 1;
+
+	for (i = 0; i < MAX_INSTANCES; i++) {
+		inst = &prof[i];
+		if (!inst->valid)
+			continue;
+
+		used = IPC_LAYOUT_GLOBAL_SIZE;
+		for (c = 0; c < inst->num_channels; c++) {
+			ch = &inst->chan[c];
+			if (ch->managed) {
+				advise_sizes(ch);
+				advise_bufs(ch, target);
+			}
+			used += chan_footprint(ch);
+		}
+
+		if (used > inst->shm_size) {
+			advisor_err("instance %d needs %llu bytes, shm_size is %u: "
+				    "increase shm_size or the target probability\n",
+				    i, (unsigned long long)used, inst->shm_size);
+			return 1;
+		}
+		if (fill)
+			fill_spare(inst, inst->shm_size - used);
+
+		used = IPC_LAYOUT_GLOBAL_SIZE;
+		for (c = 0; c < inst->num_channels; c++)
+			used += chan_footprint(&inst->chan[c]);
+
+		printf("/* instance %d: %llu of %u bytes used (estimate) */\n\n",
+		       i, (unsigned long long)used, inst->shm_size);
+		for (c = 0; c < inst->num_channels; c++) {
+			ch = &inst->chan[c];
+			if (ch->managed)
+				print_chan(i, c, ch);
+		}
+	}
+
+	return 0;
+}
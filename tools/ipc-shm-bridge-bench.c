@@ -0,0 +1,190 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+/*
+ * Bridge benchmark: sends messages to a channel endpoint of ipc-shm-bridge and
+ * counts the echoes of the remote, reporting the per-message cost seen by a
+ * socket application, to compare with the sample application throughput
+ * through the library on the same channel.
+ */
+
+#define BENCH_MAX_BATCH 64u
+#define BENCH_MAX_SIZE 65536u
+#define BENCH_TIMEOUT_MS 1000
+#define NSEC_PER_SEC 1000000000ull
+
+#define bench_err(fmt, ...) fprintf(stderr, "ipc-shm-bridge-bench: " fmt, \
+				    ##__VA_ARGS__)
+
+static uint64_t now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+static int bench_connect(const char *path)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	int fd;
+
+	if (strlen(path) >= sizeof(addr.sun_path))
+		return -ENAMETOOLONG;
+	strcpy(addr.sun_path, path);
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -errno;
+
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+		close(fd);
+		return -errno;
+	}
+
+	return fd;
+}
+
+int main(int argc, char *argv[])
+{
+	struct mmsghdr mmsg[BENCH_MAX_BATCH];
+	struct iovec iov[BENCH_MAX_BATCH];
+	uint32_t num_msgs = 100000, size = 64, window = 256;
+	uint32_t batch = 32, sent = 0, received = 0, n, i;
+	const char *path = NULL;
+	struct pollfd pfd;
+	uint64_t start, elapsed;
+	char *tx_buf, *rx_buf;
+	int opt, fd, ret;
+	double secs;
+
+	while ((opt = getopt(argc, argv, "s:n:z:w:b:h")) != -1) {
+		switch (opt) {
+		case 's':
+			path = optarg;
+			break;
+		case 'n':
+			num_msgs = strtoul(optarg, NULL, 0);
+			break;
+		case 'z':
+			size = strtoul(optarg, NULL, 0);
+			break;
+		case 'w':
+			window = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			batch = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			path = NULL;
+			break;
+		}
+	}
+
+	if (!path || !num_msgs || !size || size > BENCH_MAX_SIZE || !window ||
+	    !batch || batch > BENCH_MAX_BATCH) {
+		printf("Usage: %s -s socket [-n messages] [-z size] "
+		       "[-w window] [-b batch]\n"
+		       "  -s  channel socket of ipc-shm-bridge\n"
+		       "  -n  messages to send, default 100000\n"
+		       "  -z  message size, up to %u, default 64\n"
+		       "  -w  messages in flight, default 256\n"
+		       "  -b  messages per syscall, up to %u, default 32\n",
+		       argv[0], BENCH_MAX_SIZE, BENCH_MAX_BATCH);
+		return opt == 'h' ? 0 : -EINVAL;
+	}
+
+	fd = bench_connect(path);
+	if (fd < 0) {
+		bench_err("failed to connect to %s: %d\n", path, fd);
+		return fd;
+	}
+
+	tx_buf = calloc(1, size);
+	rx_buf = malloc((size_t)BENCH_MAX_BATCH * size);
+	if (!tx_buf || !rx_buf) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	start = now_ns();
+	while (received < num_msgs) {
+		/* fill the window, one syscall per batch */
+		n = num_msgs - sent;
+		if (n > window - (sent - received))
+			n = window - (sent - received);
+		if (n > batch)
+			n = batch;
+		if (n) {
+			memset(mmsg, 0, n * sizeof(mmsg[0]));
+			for (i = 0; i < n; i++) {
+				iov[i].iov_base = tx_buf;
+				iov[i].iov_len = size;
+				mmsg[i].msg_hdr.msg_iov = &iov[i];
+				mmsg[i].msg_hdr.msg_iovlen = 1;
+			}
+			ret = sendmmsg(fd, mmsg, n, MSG_DONTWAIT);
+			if (ret > 0)
+				sent += ret;
+		}
+
+		memset(mmsg, 0, batch * sizeof(mmsg[0]));
+		for (i = 0; i < batch; i++) {
+			iov[i].iov_base = rx_buf + (size_t)i * size;
+			iov[i].iov_len = size;
+			mmsg[i].msg_hdr.msg_iov = &iov[i];
+			mmsg[i].msg_hdr.msg_iovlen = 1;
+		}
+		ret = recvmmsg(fd, mmsg, batch, MSG_DONTWAIT, NULL);
+		if (ret > 0) {
+			received += ret;
+			continue;
+		}
+
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		if (sent < num_msgs && sent - received < window)
+			pfd.events |= POLLOUT;
+		ret = poll(&pfd, 1, BENCH_TIMEOUT_MS);
+		if (!ret) {
+			bench_err("no echo for %d ms\n", BENCH_TIMEOUT_MS);
+			break;
+		}
+		if (ret < 0 || pfd.revents & (POLLHUP | POLLERR)) {
+			bench_err("connection lost\n");
+			break;
+		}
+	}
+	elapsed = now_ns() - start;
+	ret = received == num_msgs ? 0 : -EIO;
+
+	secs = (double)elapsed / NSEC_PER_SEC;
+	printf("sent %u messages of %u bytes, received %u in %.3f s\n",
+	       sent, size, received, secs);
+	if (received)
+		printf("%.0f msgs/s, %.2f MB/s, %.0f ns per message\n",
+		       received / secs, (double)received * size / secs / 1e6,
+		       (double)elapsed / received);
+
+out:
+	free(rx_buf);
+	free(tx_buf);
+	close(fd);
+
+	return ret;
+}
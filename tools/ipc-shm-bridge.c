@@ -0,0 +1,624 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <linux/if.h>
+#include <linux/if_tun.h>
+
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipcf_Ip_Cfg.h"
+
+/*
+ * Bridge daemon: owns the instances of the configuration it is built with and
+ * exposes managed channels to applications that can't link the library, each
+ * as an AF_UNIX SOCK_SEQPACKET socket accepting one client at a time or as a
+ * TAP interface. Messages move in batches: received buffers are passed to the
+ * endpoint in place with one sendmmsg() and messages read from the endpoint
+ * with one recvmmsg() are sent in a burst ringing the remote doorbell once.
+ */
+
+#define BRIDGE_MAX_EPS 8u
+#define BRIDGE_RING_LEN 256u
+#define BRIDGE_MAX_BATCH 64u
+#define BRIDGE_DEFAULT_BATCH 32u
+#define BRIDGE_RETRY_US 100u
+#define BRIDGE_DEFAULT_DIR "/run/ipc-shm-bridge"
+
+#define bridge_err(fmt, ...) fprintf(stderr, "ipc-shm-bridge: " fmt, \
+				     ##__VA_ARGS__)
+#define bridge_info(fmt, ...) printf("ipc-shm-bridge: " fmt, ##__VA_ARGS__)
+
+/**
+ * struct bridge_msg - received message waiting to be passed to the endpoint
+ * @buf:	received buffer
+ * @size:	message size
+ */
+struct bridge_msg {
+	void *buf;
+	size_t size;
+};
+
+/**
+ * struct bridge_ep - channel exposed as a packet endpoint
+ * @instance:		instance id
+ * @chan_id:		managed channel index
+ * @listen_fd:		listening socket, -1 for a TAP interface
+ * @fd:			connected client socket or TAP file, -1 if none
+ * @kick_fd:		eventfd signaled when the Rx callback fills the ring
+ * @max_size:		largest message the channel can send
+ * @blocked:		endpoint full, waiting to be writable
+ * @release_lock:	lock serializing buffer releases of the channel
+ * @ring:		received messages waiting to be passed to the endpoint
+ * @head:		next message to pass, written by the bridge thread
+ * @tail:		next free ring entry, written by the Rx thread
+ * @bounce:		buffers for a batch of messages read from the endpoint
+ * @tx:			messages of the batch read from the endpoint
+ * @tx_next:		next message of the batch to send on the channel
+ * @tx_count:		number of messages of the batch
+ * @to_ep:		messages passed to the endpoint
+ * @to_ipc:		messages sent on the channel
+ * @dropped:		messages dropped, for lack of client or room, too large
+ *			or failed to be sent
+ */
+struct bridge_ep {
+	uint8_t instance;
+	int chan_id;
+	int listen_fd;
+	int fd;
+	int kick_fd;
+	size_t max_size;
+	bool blocked;
+	pthread_mutex_t release_lock;
+	struct bridge_msg ring[BRIDGE_RING_LEN];
+	uint32_t head;
+	uint32_t tail;
+	char *bounce;
+	struct iovec tx[BRIDGE_MAX_BATCH];
+	uint32_t tx_next;
+	uint32_t tx_count;
+	uint64_t to_ep;
+	uint64_t to_ipc;
+	uint64_t dropped;
+};
+
+/**
+ * struct ipc_shm_bridge - bridge private data
+ * @tap:	expose channels as TAP interfaces instead of sockets
+ * @dir:	directory of the endpoint sockets
+ * @batch:	maximum number of messages per syscall
+ * @num_eps:	number of bridged channels
+ * @ep:		bridged channels
+ */
+static struct ipc_shm_bridge {
+	bool tap;
+	const char *dir;
+	uint32_t batch;
+	uint32_t num_eps;
+	struct bridge_ep ep[BRIDGE_MAX_EPS];
+} bridge = {
+	.dir = BRIDGE_DEFAULT_DIR,
+	.batch = BRIDGE_DEFAULT_BATCH,
+};
+
+/* link with generated variables */
+const void *rx_cb_arg = &bridge;
+
+static volatile sig_atomic_t stop;
+
+static void bridge_drop(struct bridge_ep *ep, uint32_t n)
+{
+	__atomic_fetch_add(&ep->dropped, n, __ATOMIC_RELAXED);
+}
+
+static void bridge_release(struct bridge_ep *ep, const void *buf)
+{
+	pthread_mutex_lock(&ep->release_lock);
+	if (ipc_shm_ext_release_buf(ep->instance, ep->chan_id, buf))
+		bridge_err("failed to release buffer of channel %d\n",
+			   ep->chan_id);
+	pthread_mutex_unlock(&ep->release_lock);
+}
+
+/* bridged channels Rx callback: queue the buffer for the bridge thread */
+static void bridge_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size)
+{
+	struct bridge_ep *ep = arg;
+	uint32_t tail = ep->tail;
+	uint64_t one = 1;
+
+	if (tail - __atomic_load_n(&ep->head, __ATOMIC_ACQUIRE) ==
+	    BRIDGE_RING_LEN) {
+		bridge_drop(ep, 1u);
+		bridge_release(ep, buf);
+		return;
+	}
+
+	ep->ring[tail % BRIDGE_RING_LEN].buf = buf;
+	ep->ring[tail % BRIDGE_RING_LEN].size = size;
+	__atomic_store_n(&ep->tail, tail + 1u, __ATOMIC_SEQ_CST);
+
+	/* wake the bridge thread only if it may have seen the ring empty */
+	if (__atomic_load_n(&ep->head, __ATOMIC_SEQ_CST) == tail &&
+	    write(ep->kick_fd, &one, sizeof(one)) < 0)
+		bridge_err("failed to kick bridge thread\n");
+}
+
+/* unbridged data channels Rx callback */
+void data_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size)
+{
+	ipc_shm_ext_release_buf(instance, chan_id, buf);
+}
+
+/* control channel Rx callback, unmanaged channels can't be bridged */
+void ctrl_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *mem)
+{
+}
+
+static void int_handler(int signum)
+{
+	stop = 1;
+}
+
+static void bridge_disconnect(struct bridge_ep *ep)
+{
+	if (ep->listen_fd < 0)
+		return;
+
+	bridge_info("client of channel %d disconnected\n", ep->chan_id);
+	close(ep->fd);
+	ep->fd = -1;
+	ep->blocked = false;
+}
+
+/*
+ * Write a batch of messages to the endpoint. TAP files have no batched
+ * syscall, so messages are written one by one.
+ *
+ * Return: number of messages consumed, negative error code if none
+ */
+static int bridge_ep_send(struct bridge_ep *ep, struct mmsghdr *mmsg,
+		uint32_t n)
+{
+	struct iovec *iov;
+	uint32_t i;
+	int sent;
+
+	if (ep->listen_fd >= 0) {
+		sent = sendmmsg(ep->fd, mmsg, n, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (sent < 0)
+			return -errno;
+		ep->to_ep += sent;
+		return sent;
+	}
+
+	for (i = 0; i < n; i++) {
+		iov = mmsg[i].msg_hdr.msg_iov;
+		if (write(ep->fd, iov->iov_base, iov->iov_len) >= 0) {
+			ep->to_ep++;
+		} else if (errno == EAGAIN) {
+			return i ? (int)i : -EAGAIN;
+		} else {
+			/* e.g. interface down, the frame is lost */
+			bridge_drop(ep, 1u);
+		}
+	}
+
+	return n;
+}
+
+/* pass received messages to the endpoint, releasing them once written */
+static void bridge_to_ep(struct bridge_ep *ep)
+{
+	struct mmsghdr mmsg[BRIDGE_MAX_BATCH];
+	struct iovec iov[BRIDGE_MAX_BATCH];
+	struct bridge_msg *msg;
+	uint32_t head = ep->head, n, i;
+	int sent;
+
+	ep->blocked = false;
+	for (;;) {
+		n = __atomic_load_n(&ep->tail, __ATOMIC_SEQ_CST) - head;
+		if (!n)
+			break;
+		if (n > bridge.batch)
+			n = bridge.batch;
+
+		memset(mmsg, 0, n * sizeof(mmsg[0]));
+		for (i = 0; i < n; i++) {
+			msg = &ep->ring[(head + i) % BRIDGE_RING_LEN];
+			iov[i].iov_base = msg->buf;
+			iov[i].iov_len = msg->size;
+			mmsg[i].msg_hdr.msg_iov = &iov[i];
+			mmsg[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		if (ep->fd < 0) {
+			/* no client: drop */
+			sent = n;
+			bridge_drop(ep, n);
+		} else {
+			sent = bridge_ep_send(ep, mmsg, n);
+			if (sent == -EAGAIN) {
+				ep->blocked = true;
+				break;
+			}
+			if (sent < 0) {
+				bridge_disconnect(ep);
+				continue;
+			}
+		}
+
+		for (i = 0; i < (uint32_t)sent; i++)
+			bridge_release(ep, iov[i].iov_base);
+		head += sent;
+		__atomic_store_n(&ep->head, head, __ATOMIC_SEQ_CST);
+	}
+}
+
+/*
+ * Send the batch read from the endpoint. Messages lacking a Tx buffer are
+ * kept until the remote releases some, without reading the endpoint further
+ * meanwhile, so that the bridge thread keeps passing received messages.
+ */
+static void bridge_to_ipc(struct bridge_ep *ep)
+{
+	int n;
+
+	while (ep->tx_next < ep->tx_count) {
+		n = ipc_shm_ext_tx_copy_burst(ep->instance, ep->chan_id,
+					      &ep->tx[ep->tx_next],
+					      ep->tx_count - ep->tx_next);
+		if (n == -ENOMEM)
+			return;
+		if (n < 0) {
+			bridge_drop(ep, 1u);
+			n = 1;
+		} else {
+			ep->to_ipc += n;
+		}
+		ep->tx_next += n;
+	}
+}
+
+/*
+ * Read a batch of messages from the endpoint. Bounce buffers are one byte
+ * larger than the channel largest buffer to detect oversized messages.
+ */
+static void bridge_from_ep(struct bridge_ep *ep)
+{
+	struct mmsghdr mmsg[BRIDGE_MAX_BATCH];
+	struct iovec iov[BRIDGE_MAX_BATCH];
+	size_t len, slot = ep->max_size + 1;
+	ssize_t ret;
+	int i, n;
+
+	memset(mmsg, 0, sizeof(mmsg));
+	for (i = 0; i < (int)bridge.batch; i++) {
+		iov[i].iov_base = ep->bounce + i * slot;
+		iov[i].iov_len = slot;
+		mmsg[i].msg_hdr.msg_iov = &iov[i];
+		mmsg[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	ep->tx_next = 0;
+	ep->tx_count = 0;
+	if (ep->listen_fd >= 0) {
+		n = recvmmsg(ep->fd, mmsg, bridge.batch, MSG_DONTWAIT, NULL);
+		if (n < 0)
+			return;
+	} else {
+		/* TAP files have no batched syscall */
+		for (n = 0; n < (int)bridge.batch; n++) {
+			ret = read(ep->fd, iov[n].iov_base, slot);
+			if (ret < 0)
+				break;
+			mmsg[n].msg_len = ret;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		/* empty messages, also read at end of connection, skipped */
+		len = mmsg[i].msg_len;
+		if (!len)
+			continue;
+		if (len > ep->max_size ||
+		    (mmsg[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+			bridge_drop(ep, 1u);
+			continue;
+		}
+		ep->tx[ep->tx_count].iov_base = iov[i].iov_base;
+		ep->tx[ep->tx_count++].iov_len = len;
+	}
+}
+
+static void bridge_accept(struct bridge_ep *ep)
+{
+	int fd;
+
+	fd = accept4(ep->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (fd < 0)
+		return;
+
+	if (ep->fd >= 0) {
+		bridge_err("channel %d already has a client\n", ep->chan_id);
+		close(fd);
+		return;
+	}
+
+	bridge_info("client of channel %d connected\n", ep->chan_id);
+	ep->fd = fd;
+}
+
+static int bridge_open_socket(struct bridge_ep *ep)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	int len;
+
+	len = snprintf(addr.sun_path, sizeof(addr.sun_path),
+		       "%s/ipc-shm-%u-%d.sock", bridge.dir, ep->instance,
+		       ep->chan_id);
+	if (len >= (int)sizeof(addr.sun_path))
+		return -ENAMETOOLONG;
+
+	ep->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (ep->listen_fd < 0)
+		return -errno;
+
+	unlink(addr.sun_path);
+	if (bind(ep->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+	    listen(ep->listen_fd, 1)) {
+		bridge_err("failed to listen on %s\n", addr.sun_path);
+		return -errno;
+	}
+	bridge_info("channel %d of instance %u on %s\n", ep->chan_id,
+		    ep->instance, addr.sun_path);
+
+	return 0;
+}
+
+static int bridge_open_tap(struct bridge_ep *ep)
+{
+	struct ifreq ifr = { .ifr_flags = IFF_TAP | IFF_NO_PI };
+
+	snprintf(ifr.ifr_name, IFNAMSIZ, "ipcshm%u.%d", ep->instance,
+		 ep->chan_id);
+
+	ep->fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (ep->fd < 0)
+		return -errno;
+
+	if (ioctl(ep->fd, TUNSETIFF, &ifr)) {
+		bridge_err("failed to create interface %s\n", ifr.ifr_name);
+		return -errno;
+	}
+	bridge_info("channel %d of instance %u on interface %s\n",
+		    ep->chan_id, ep->instance, ifr.ifr_name);
+
+	return 0;
+}
+
+static int bridge_open(struct bridge_ep *ep)
+{
+	const struct ipc_shm_channel_cfg *chan;
+	const struct ipc_shm_managed_cfg *cfg;
+
+	if (ep->instance >= ipcf_shm_instances_cfg.num_instances ||
+	    ep->chan_id < 0 || ep->chan_id >=
+	    ipcf_shm_instances_cfg.shm_cfg[ep->instance].num_channels)
+		return -EINVAL;
+
+	chan = &ipcf_shm_instances_cfg.shm_cfg[ep->instance]
+		.channels[ep->chan_id];
+	if (chan->type != IPC_SHM_MANAGED) {
+		bridge_err("channel %d is not managed\n", ep->chan_id);
+		return -EINVAL;
+	}
+
+	/* pools are sorted by buffer size */
+	cfg = &chan->ch.managed;
+	ep->max_size = cfg->pools[cfg->num_pools - 1].buf_size;
+	ep->bounce = malloc(BRIDGE_MAX_BATCH * (ep->max_size + 1));
+	if (!ep->bounce)
+		return -ENOMEM;
+
+	ep->kick_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (ep->kick_fd < 0)
+		return -errno;
+
+	return bridge.tap ? bridge_open_tap(ep) : bridge_open_socket(ep);
+}
+
+static void bridge_close(struct bridge_ep *ep)
+{
+	if (ep->fd >= 0)
+		close(ep->fd);
+	if (ep->listen_fd >= 0)
+		close(ep->listen_fd);
+	if (ep->kick_fd >= 0)
+		close(ep->kick_fd);
+	free(ep->bounce);
+
+	bridge_info("channel %d of instance %u: %llu to endpoint, "
+		    "%llu to remote, %llu dropped\n", ep->chan_id,
+		    ep->instance, (unsigned long long)ep->to_ep,
+		    (unsigned long long)ep->to_ipc,
+		    (unsigned long long)ep->dropped);
+}
+
+/* bridge thread: serve all endpoints from a single poll loop */
+static void bridge_loop(void)
+{
+	const struct timespec retry = { .tv_nsec = BRIDGE_RETRY_US * 1000 };
+	struct pollfd fds[3 * BRIDGE_MAX_EPS];
+	struct bridge_ep *ep;
+	bool pending;
+	uint64_t kicks;
+	uint32_t i, n;
+	short events;
+
+	while (!stop) {
+		pending = false;
+		for (i = 0, n = 0; i < bridge.num_eps; i++) {
+			ep = &bridge.ep[i];
+			/* read the endpoint once the previous batch is sent */
+			events = ep->blocked ? POLLOUT : 0;
+			if (ep->tx_next == ep->tx_count)
+				events |= POLLIN;
+			else
+				pending = true;
+			fds[n++] = (struct pollfd){ ep->kick_fd, POLLIN, 0 };
+			fds[n++] = (struct pollfd){ ep->listen_fd, POLLIN, 0 };
+			fds[n++] = (struct pollfd){ ep->fd, events, 0 };
+		}
+
+		if (ppoll(fds, n, pending ? &retry : NULL, NULL) < 0)
+			continue;
+
+		for (i = 0; i < bridge.num_eps; i++) {
+			ep = &bridge.ep[i];
+			if (fds[3 * i].revents & POLLIN &&
+			    read(ep->kick_fd, &kicks, sizeof(kicks)) < 0)
+				bridge_err("failed to read kicks\n");
+			if (fds[3 * i + 1].revents & POLLIN)
+				bridge_accept(ep);
+			if (fds[3 * i + 2].revents & POLLIN)
+				bridge_from_ep(ep);
+			if (fds[3 * i + 2].revents & (POLLHUP | POLLERR))
+				bridge_disconnect(ep);
+			bridge_to_ipc(ep);
+			bridge_to_ep(ep);
+		}
+	}
+}
+
+static int bridge_parse_chan(const char *arg)
+{
+	struct bridge_ep *ep;
+	unsigned int instance;
+	int chan_id;
+
+	if (bridge.num_eps == BRIDGE_MAX_EPS ||
+	    sscanf(arg, "%u:%d", &instance, &chan_id) != 2 ||
+	    instance > UINT8_MAX)
+		return -EINVAL;
+
+	ep = &bridge.ep[bridge.num_eps++];
+	ep->instance = instance;
+	ep->chan_id = chan_id;
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct sigaction sig_action = { .sa_handler = int_handler };
+	struct bridge_ep *ep;
+	int opt, err = 0;
+	uint32_t i;
+
+	while ((opt = getopt(argc, argv, "c:s:tb:h")) != -1) {
+		switch (opt) {
+		case 'c':
+			err = bridge_parse_chan(optarg);
+			break;
+		case 's':
+			bridge.dir = optarg;
+			break;
+		case 't':
+			bridge.tap = true;
+			break;
+		case 'b':
+			bridge.batch = strtoul(optarg, NULL, 0);
+			if (!bridge.batch || bridge.batch > BRIDGE_MAX_BATCH)
+				err = -EINVAL;
+			break;
+		default:
+			err = -EINVAL;
+			break;
+		}
+		if (err || opt == 'h')
+			break;
+	}
+
+	if (err || opt == 'h' || !bridge.num_eps) {
+		printf("Usage: %s -c instance:channel [-c ...] [-s dir] [-t] "
+		       "[-b batch]\n"
+		       "  -c  managed channel to bridge, up to %u\n"
+		       "  -s  directory of the endpoint sockets, default "
+		       BRIDGE_DEFAULT_DIR "\n"
+		       "  -t  expose channels as TAP interfaces instead\n"
+		       "  -b  messages per syscall, up to %u, default %u\n",
+		       argv[0], BRIDGE_MAX_EPS, BRIDGE_MAX_BATCH,
+		       BRIDGE_DEFAULT_BATCH);
+		return opt == 'h' ? 0 : -EINVAL;
+	}
+
+	if (!bridge.tap && mkdir(bridge.dir, 0755) && errno != EEXIST) {
+		bridge_err("failed to create %s\n", bridge.dir);
+		return -errno;
+	}
+
+	err = ipc_shm_ext_init(&ipcf_shm_instances_cfg);
+	if (err) {
+		bridge_err("failed to initialize driver: %d\n", err);
+		return err;
+	}
+
+	for (i = 0; i < bridge.num_eps; i++) {
+		ep = &bridge.ep[i];
+		ep->listen_fd = -1;
+		ep->fd = -1;
+		ep->kick_fd = -1;
+		pthread_mutex_init(&ep->release_lock, NULL);
+	}
+
+	for (i = 0; i < bridge.num_eps; i++) {
+		ep = &bridge.ep[i];
+		err = bridge_open(ep);
+		if (err) {
+			bridge_err("failed to bridge channel %d of instance "
+				   "%u: %d\n", ep->chan_id, ep->instance, err);
+			goto out;
+		}
+	}
+
+	for (i = 0; i < bridge.num_eps; i++) {
+		ep = &bridge.ep[i];
+		ipc_shm_ext_set_rx_cb(ep->instance, ep->chan_id, bridge_rx_cb,
+				      ep);
+	}
+
+	sigaction(SIGINT, &sig_action, NULL);
+	sigaction(SIGTERM, &sig_action, NULL);
+	bridge_loop();
+
+out:
+	/* buffers still queued go away with the driver */
+	ipc_shm_ext_free();
+	for (i = 0; i < bridge.num_eps; i++)
+		bridge_close(&bridge.ep[i]);
+
+	return err;
+}
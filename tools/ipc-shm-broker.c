@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "ipc-shm.h"
+#include "ipc-shm-ext.h"
+#include "ipc-broker.h"
+#include "ipcf_Ip_Cfg.h"
+
+/*
+ * Broker daemon: owns the instances of the configuration it is built with
+ * and lets client processes claim their managed channels (see
+ * ext/ipc-broker.h). Messages received on unclaimed channels are released.
+ */
+
+#define BROKER_DEFAULT_PATH "/run/ipc-shm-broker.sock"
+
+#define broker_err(fmt, ...) fprintf(stderr, "ipc-shm-broker: " fmt, \
+				     ##__VA_ARGS__)
+
+/* link with generated variables */
+const void *rx_cb_arg = NULL;
+
+static volatile sig_atomic_t stop;
+
+/* unclaimed data channels Rx callback */
+void data_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size)
+{
+	ipc_shm_ext_release_buf(instance, chan_id, buf);
+}
+
+/* control channel Rx callback, unmanaged channels can't be claimed */
+void ctrl_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *mem)
+{
+}
+
+static void int_handler(int signum)
+{
+	stop = 1;
+}
+
+int main(int argc, char *argv[])
+{
+	struct sigaction sig_action = { .sa_handler = int_handler };
+	const char *path = BROKER_DEFAULT_PATH;
+	int opt, err;
+
+	while ((opt = getopt(argc, argv, "s:h")) != -1) {
+		switch (opt) {
+		case 's':
+			path = optarg;
+			break;
+		default:
+			printf("Usage: %s [-s socket]\n"
+			       "  -s  Unix socket path of the broker, "
+			       "default " BROKER_DEFAULT_PATH "\n",
+			       argv[0]);
+			return opt == 'h' ? 0 : -EINVAL;
+		}
+	}
+
+	err = ipc_shm_ext_init(&ipcf_shm_instances_cfg);
+	if (err) {
+		broker_err("failed to initialize driver: %d\n", err);
+		return err;
+	}
+
+	err = ipc_shm_broker_start(path);
+	if (err) {
+		broker_err("failed to start broker on %s: %d\n", path, err);
+		goto out;
+	}
+
+	sigaction(SIGINT, &sig_action, NULL);
+	sigaction(SIGTERM, &sig_action, NULL);
+	while (!stop)
+		pause();
+
+	ipc_shm_broker_stop();
+
+out:
+	ipc_shm_ext_free();
+
+	return err;
+}
@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ *
+ * Plan the aligned shared memory layout of the sample configuration, print its
+ * offset map and the adjusted configuration for the remote.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "ipc-shm.h"
+#include "ipc-layout.h"
+#include "ipcf_Ip_Cfg.h"
+
+#define DEFAULT_ALIGN		64u
+
+#define layout_err(fmt, ...) fprintf(stderr, "ipc-shm-layout: " fmt, \
+				     ##__VA_ARGS__)
+
+/* link with generated variables, the callbacks are never called */
+const void *rx_cb_arg;
+
+void ctrl_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *mem)
+{
+}
+
+void data_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size)
+{
+}
+
+static void print_chan(int i, int c, const struct ipc_shm_channel_cfg *cfg,
+		const struct ipc_layout_chan *chan)
+{
+	const struct ipc_shm_pool_cfg *pool;
+	int p;
+
+	if (!chan->managed) {
+		printf("/* channel %d: unmanaged .size = %u, was %u */\n\n",
+		       c, chan->size, cfg->ch.unmanaged.size);
+		return;
+	}
+
+	printf("/* Pools must be sorted in ascending order by buffer size */\n");
+	printf("static struct ipc_shm_pool_cfg ipcf_shm_cfg_buf_pools%d_%d[%d] = {\n",
+	       i, c, chan->num_pools);
+	for (p = 0; p < chan->num_pools; p++) {
+		pool = &cfg->ch.managed.pools[p];
+		printf("\t{\n");
+		printf("\t\t.num_bufs = %u,\t/* was %u */\n",
+		       chan->pools[p].num_bufs, pool->num_bufs);
+		printf("\t\t.buf_size = %u,\t/* was %u */\n",
+		       chan->pools[p].buf_size, pool->buf_size);
+		printf("\t},\n");
+	}
+	printf("};\n\n");
+}
+
+static void usage(const char *name)
+{
+	printf("Usage: %s [-a align]\n"
+	       "  -a  alignment in bytes, the cache line or bus burst size of\n"
+	       "      the platform (default %u)\n",
+	       name, DEFAULT_ALIGN);
+}
+
+int main(int argc, char *argv[])
+{
+	const struct ipc_shm_cfg *cfg;
+	uint32_t align = DEFAULT_ALIGN;
+	struct ipc_layout map;
+	int opt, i, c, err, ret = 0;
+
+	while ((opt = getopt(argc, argv, "a:h")) != -1) {
+		switch (opt) {
+		case 'a':
+			align = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (optind != argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	for (i = 0; i < ipcf_shm_instances_cfg.num_instances; i++) {
+		cfg = &ipcf_shm_instances_cfg.shm_cfg[i];
+		err = ipc_layout_plan(cfg, align, &map);
+		if (err == -EINVAL) {
+			layout_err("invalid alignment or configuration\n");
+			return 1;
+		}
+
+		printf("/* instance %d\n", i);
+		ipc_layout_print(&map, stdout);
+		printf(" */\n\n");
+		if (err) {
+			layout_err("instance %d exceeds shm_size or %u buffers "
+				   "per pool\n", i, IPC_SHM_MAX_BUFS_PER_POOL);
+			ret = 1;
+			continue;
+		}
+
+		for (c = 0; c < map.num_channels; c++)
+			print_chan(i, c, &cfg->channels[c], &map.chan[c]);
+	}
+
+	return ret;
+}
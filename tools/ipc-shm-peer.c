@@ -0,0 +1,408 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ipc-shm.h"
+#include "ipcf_Ip_Cfg.h"
+
+/*
+ * Remote peer emulator: the remote core side of the sample application on a
+ * Linux host, attached to the driver built with HOST=yes. Each message
+ * received on a data channel is echoed on the same channel and, once all the
+ * messages announced on the control channel were handled, a control reply is
+ * sent. Processing delay, jitter, drops and late releases of received buffers
+ * emulate a slow or lossy remote to exercise pool exhaustion on the local side
+ * and queue full paths.
+ */
+
+#define PEER_QUEUE_LEN 4096u
+#define PEER_CTRL_LEN 64
+#define NSEC_PER_SEC 1000000000ull
+#define NSEC_PER_USEC 1000ull
+
+#define peer_err(fmt, ...) fprintf(stderr, "ipc-shm-peer: " fmt, ##__VA_ARGS__)
+#define peer_info(fmt, ...) printf("ipc-shm-peer: " fmt, ##__VA_ARGS__)
+
+/**
+ * struct peer_msg - received message waiting to be echoed or released
+ * @instance:	instance id
+ * @chan_id:	channel index
+ * @buf:	received buffer
+ * @size:	received message size
+ * @due_ns:	time of echo, then time of release
+ */
+struct peer_msg {
+	uint8_t instance;
+	int chan_id;
+	void *buf;
+	size_t size;
+	uint64_t due_ns;
+};
+
+/**
+ * struct ipc_shm_peer - peer emulator private data
+ * @delay_us:		processing delay of each message
+ * @jitter_us:		random additional processing delay, up to
+ * @drop_permille:	messages released without echo, per thousand
+ * @release_us:		delay between echo and release of received buffers
+ * @verbose:		print each message
+ * @seed:		random generator state
+ * @lock:		lock protecting the queue and counters
+ * @cond:		signaled when a message is queued
+ * @queue:		messages being processed, in reception order
+ * @head:		next message to release
+ * @next:		next message to echo
+ * @tail:		next free queue entry
+ * @ctrl_shm:		control channel local memory
+ * @expected:		messages announced on the control channel
+ * @handled:		messages echoed or dropped since the announce
+ * @received:		messages received
+ * @echoed:		messages echoed
+ * @dropped:		messages dropped on purpose
+ * @failed:		messages not echoed for lack of buffer or tx error
+ */
+static struct ipc_shm_peer {
+	uint32_t delay_us;
+	uint32_t jitter_us;
+	uint32_t drop_permille;
+	uint32_t release_us;
+	bool verbose;
+	unsigned int seed;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	struct peer_msg queue[PEER_QUEUE_LEN];
+	uint32_t head;
+	uint32_t next;
+	uint32_t tail;
+	char *ctrl_shm;
+	int ctrl_chan_id;
+	int expected;
+	int handled;
+	uint64_t received;
+	uint64_t echoed;
+	uint64_t dropped;
+	uint64_t failed;
+} peer;
+
+/* link with generated variables */
+const void *rx_cb_arg = &peer;
+
+static volatile sig_atomic_t stop;
+
+static uint64_t now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+/* reply on the control channel once all announced messages were handled */
+static void peer_handled(const uint8_t instance)
+{
+	char tmp[PEER_CTRL_LEN] = {0};
+	bool done;
+
+	pthread_mutex_lock(&peer.lock);
+	done = (++peer.handled == peer.expected);
+	pthread_mutex_unlock(&peer.lock);
+	if (!done)
+		return;
+
+	snprintf(tmp, sizeof(tmp), "ECHOED MESSAGES: %d", peer.expected);
+	memcpy(peer.ctrl_shm, tmp, sizeof(tmp));
+	if (ipc_shm_unmanaged_tx(instance, peer.ctrl_chan_id))
+		peer_err("tx failed on control channel\n");
+}
+
+/* echo message unless dropped, then count it as handled */
+static void peer_echo(const struct peer_msg *msg)
+{
+	void *buf;
+	bool drop;
+
+	pthread_mutex_lock(&peer.lock);
+	drop = (uint32_t)rand_r(&peer.seed) % 1000u < peer.drop_permille;
+	pthread_mutex_unlock(&peer.lock);
+
+	if (drop) {
+		__atomic_fetch_add(&peer.dropped, 1u, __ATOMIC_RELAXED);
+		goto out;
+	}
+
+	buf = ipc_shm_acquire_buf(msg->instance, msg->chan_id, msg->size);
+	if (!buf) {
+		__atomic_fetch_add(&peer.failed, 1u, __ATOMIC_RELAXED);
+		goto out;
+	}
+
+	memcpy(buf, msg->buf, msg->size);
+	if (ipc_shm_tx(msg->instance, msg->chan_id, buf, msg->size)) {
+		__atomic_fetch_add(&peer.failed, 1u, __ATOMIC_RELAXED);
+		goto out;
+	}
+	__atomic_fetch_add(&peer.echoed, 1u, __ATOMIC_RELAXED);
+
+out:
+	peer_handled(msg->instance);
+}
+
+static void peer_release(const struct peer_msg *msg)
+{
+	if (ipc_shm_release_buf(msg->instance, msg->chan_id, msg->buf))
+		peer_err("failed to release buffer of channel %d\n",
+			 msg->chan_id);
+}
+
+/*
+ * Worker: echo queued messages when their processing delay expires, then
+ * release them after the release delay, in reception order.
+ */
+static void *peer_worker(void *arg)
+{
+	struct peer_msg *msg;
+	struct timespec wake;
+	uint64_t now, due;
+
+	pthread_mutex_lock(&peer.lock);
+	while (!stop) {
+		now = now_ns();
+		due = UINT64_MAX;
+
+		if (peer.head != peer.next) {
+			msg = &peer.queue[peer.head % PEER_QUEUE_LEN];
+			if (msg->due_ns <= now) {
+				pthread_mutex_unlock(&peer.lock);
+				peer_release(msg);
+				pthread_mutex_lock(&peer.lock);
+				peer.head++;
+				continue;
+			}
+			due = msg->due_ns;
+		}
+
+		if (peer.next != peer.tail) {
+			msg = &peer.queue[peer.next % PEER_QUEUE_LEN];
+			if (msg->due_ns <= now) {
+				pthread_mutex_unlock(&peer.lock);
+				peer_echo(msg);
+				msg->due_ns = now_ns()
+					      + peer.release_us * NSEC_PER_USEC;
+				pthread_mutex_lock(&peer.lock);
+				peer.next++;
+				continue;
+			}
+			if (msg->due_ns < due)
+				due = msg->due_ns;
+		}
+
+		if (due == UINT64_MAX) {
+			pthread_cond_wait(&peer.cond, &peer.lock);
+		} else {
+			wake.tv_sec = due / NSEC_PER_SEC;
+			wake.tv_nsec = due % NSEC_PER_SEC;
+			pthread_cond_timedwait(&peer.cond, &peer.lock, &wake);
+		}
+	}
+	pthread_mutex_unlock(&peer.lock);
+
+	return NULL;
+}
+
+/* data channel Rx callback: echo right away or queue for the worker */
+void data_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size)
+{
+	struct peer_msg msg = {
+		.instance = instance,
+		.chan_id = chan_id,
+		.buf = buf,
+		.size = size,
+	};
+	bool queued = false;
+
+	__atomic_fetch_add(&peer.received, 1u, __ATOMIC_RELAXED);
+	if (peer.verbose)
+		peer_info("ch %d << %zu bytes\n", chan_id, size);
+
+	if (peer.delay_us || peer.jitter_us || peer.release_us) {
+		pthread_mutex_lock(&peer.lock);
+		msg.due_ns = now_ns() + peer.delay_us * NSEC_PER_USEC;
+		if (peer.jitter_us)
+			msg.due_ns += (uint32_t)rand_r(&peer.seed)
+				      % (peer.jitter_us + 1u) * NSEC_PER_USEC;
+		if (peer.tail - peer.head < PEER_QUEUE_LEN) {
+			peer.queue[peer.tail++ % PEER_QUEUE_LEN] = msg;
+			pthread_cond_signal(&peer.cond);
+			queued = true;
+		}
+		pthread_mutex_unlock(&peer.lock);
+	}
+
+	/* no delay or queue full: handle on the Rx thread */
+	if (!queued) {
+		peer_echo(&msg);
+		peer_release(&msg);
+	}
+}
+
+/* control channel Rx callback: get number of messages announced */
+void ctrl_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *mem)
+{
+	char tmp[PEER_CTRL_LEN];
+	int num_msgs;
+
+	memcpy(tmp, mem, sizeof(tmp));
+	tmp[sizeof(tmp) - 1] = '\0';
+	peer_info("ch %d << %s\n", chan_id, tmp);
+
+	if (sscanf(tmp, "SENDING MESSAGES: %d", &num_msgs) != 1)
+		return;
+
+	pthread_mutex_lock(&peer.lock);
+	peer.ctrl_chan_id = chan_id;
+	peer.expected = num_msgs;
+	peer.handled = 0;
+	pthread_mutex_unlock(&peer.lock);
+}
+
+static void int_handler(int signum)
+{
+	stop = 1;
+}
+
+/* attach to the sample configuration from the remote side */
+static int peer_init(void)
+{
+	struct ipc_shm_cfg *cfg;
+	uintptr_t addr;
+	int i, err;
+
+	for (i = 0; i < ipcf_shm_instances_cfg.num_instances; i++) {
+		cfg = &ipcf_shm_instances_cfg.shm_cfg[i];
+		addr = cfg->local_shm_addr;
+		cfg->local_shm_addr = cfg->remote_shm_addr;
+		cfg->remote_shm_addr = addr;
+	}
+
+	err = ipc_shm_init(&ipcf_shm_instances_cfg);
+	if (err)
+		return err;
+
+	/* the control channel is the first unmanaged channel */
+	cfg = &ipcf_shm_instances_cfg.shm_cfg[0];
+	for (i = 0; i < cfg->num_channels; i++)
+		if (cfg->channels[i].type == IPC_SHM_UNMANAGED)
+			break;
+	if (i == cfg->num_channels) {
+		peer_err("no control channel\n");
+		ipc_shm_free();
+		return -EINVAL;
+	}
+
+	peer.ctrl_chan_id = i;
+	peer.ctrl_shm = ipc_shm_unmanaged_acquire(0, i);
+	if (!peer.ctrl_shm) {
+		peer_err("failed to get memory of control channel\n");
+		ipc_shm_free();
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct sigaction sig_action = { .sa_handler = int_handler };
+	pthread_condattr_t attr;
+	pthread_t worker;
+	int opt, err;
+
+	peer.seed = getpid();
+	while ((opt = getopt(argc, argv, "d:j:x:l:vh")) != -1) {
+		switch (opt) {
+		case 'd':
+			peer.delay_us = strtoul(optarg, NULL, 0);
+			break;
+		case 'j':
+			peer.jitter_us = strtoul(optarg, NULL, 0);
+			break;
+		case 'x':
+			peer.drop_permille = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			peer.release_us = strtoul(optarg, NULL, 0);
+			break;
+		case 'v':
+			peer.verbose = true;
+			break;
+		default:
+			printf("Usage: %s [-d delay] [-j jitter] [-x drops] "
+			       "[-l release] [-v]\n"
+			       "  -d  processing delay of each message in us\n"
+			       "  -j  random additional delay in us, up to\n"
+			       "  -x  messages dropped without echo, per "
+			       "thousand\n"
+			       "  -l  delay from echo to release of received "
+			       "buffers in us\n"
+			       "  -v  print each message received\n",
+			       argv[0]);
+			return opt == 'h' ? 0 : -EINVAL;
+		}
+	}
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&peer.cond, &attr);
+	pthread_condattr_destroy(&attr);
+	pthread_mutex_init(&peer.lock, NULL);
+
+	err = peer_init();
+	if (err) {
+		peer_err("failed to attach to shared memory: %d\n", err);
+		return err;
+	}
+
+	sigaction(SIGINT, &sig_action, NULL);
+	sigaction(SIGTERM, &sig_action, NULL);
+
+	err = pthread_create(&worker, NULL, peer_worker, NULL);
+	if (err) {
+		peer_err("failed to start worker\n");
+		goto out;
+	}
+
+	peer_info("echoing, press Ctrl-C to exit\n");
+	while (!stop)
+		pause();
+
+	pthread_mutex_lock(&peer.lock);
+	pthread_cond_signal(&peer.cond);
+	pthread_mutex_unlock(&peer.lock);
+	pthread_join(worker, NULL);
+
+	peer_info("received %llu, echoed %llu, dropped %llu, failed %llu\n",
+		  (unsigned long long)peer.received,
+		  (unsigned long long)peer.echoed,
+		  (unsigned long long)peer.dropped,
+		  (unsigned long long)peer.failed);
+
+out:
+	ipc_shm_free();
+
+	return err;
+}
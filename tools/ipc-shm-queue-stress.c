@@ -0,0 +1,290 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "ipc-atomic.h"
+
+/*
+ * Queue stress test: the publish/consume protocol of the driver descriptor
+ * queues, between two processes. A managed channel hands a buffer to the
+ * remote by pushing its descriptor on the channel queue, and the remote gives
+ * it back by pushing it on the free buffers queue of its pool. Here the
+ * producer takes a buffer from the free queue, fills it with a pattern of the
+ * sequence number and pushes it on the channel queue; the consumer checks
+ * descriptor and buffer, then pushes the descriptor back on the free queue.
+ * Descriptors and buffers are accessed relaxed and only ordered by the queue
+ * indices, so anything read before it was published shows as corrupted.
+ *
+ * Both sides busy poll their queue, as the Rx thread does after an interrupt.
+ */
+
+/* buffers of the pool, all in flight at most */
+#define STRESS_BUFS		64u
+/* buffer size in 32 bit words */
+#define STRESS_BUF_WORDS	64u
+/* queue elements, one more than descriptors so that full and empty differ */
+#define STRESS_QUEUE_ELEMS	(STRESS_BUFS + 1u)
+
+#define STRESS_SPINS		1024u
+#define STRESS_STALL_NS		(5u * NSEC_PER_SEC)
+#define NSEC_PER_SEC		1000000000ull
+
+#define stress_err(fmt, ...) fprintf(stderr, "ipc-shm-queue-stress: " fmt, \
+				     ##__VA_ARGS__)
+
+/**
+ * struct stress_bd - buffer descriptor, as the driver's
+ * @pool_id:	pool of the buffer
+ * @buf_id:	buffer index in the pool
+ * @data_size:	payload size, the sequence number here
+ */
+struct stress_bd {
+	uint16_t pool_id;
+	uint16_t buf_id;
+	uint32_t data_size;
+};
+
+/**
+ * struct stress_queue - descriptor queue, as the driver's ring
+ * @write:	next element to write, written by the producer
+ * @read:	next element to read, written by the consumer
+ * @bd:		descriptors
+ */
+struct stress_queue {
+	uint32_t write;
+	uint32_t read;
+	struct stress_bd bd[STRESS_QUEUE_ELEMS];
+};
+
+/* memory shared by both processes */
+static struct {
+	struct stress_queue chan;
+	struct stress_queue free;
+	uint32_t buf[STRESS_BUFS][STRESS_BUF_WORDS];
+	uint64_t corrupted;
+} *shared;
+
+static uint32_t num_msgs = 10000000, window = STRESS_BUFS;
+
+static uint64_t now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+static bool stress_push(struct stress_queue *q, const struct stress_bd *bd)
+{
+	uint32_t write = READ_ONCE(q->write);
+	uint32_t next = (write + 1u) % STRESS_QUEUE_ELEMS;
+
+	/* the consumer is done with the element once it moved read past it */
+	if (next == ipc_queue_load_idx(&q->read))
+		return false;
+
+	writew_relaxed(bd->pool_id, &q->bd[write].pool_id);
+	writew_relaxed(bd->buf_id, &q->bd[write].buf_id);
+	writel_relaxed(bd->data_size, &q->bd[write].data_size);
+	ipc_queue_store_idx(&q->write, next);
+
+	return true;
+}
+
+static bool stress_pop(struct stress_queue *q, struct stress_bd *bd)
+{
+	uint32_t read = READ_ONCE(q->read);
+
+	if (read == ipc_queue_load_idx(&q->write))
+		return false;
+
+	bd->pool_id = readw_relaxed(&q->bd[read].pool_id);
+	bd->buf_id = readw_relaxed(&q->bd[read].buf_id);
+	bd->data_size = readl_relaxed(&q->bd[read].data_size);
+	ipc_queue_store_idx(&q->read, (read + 1u) % STRESS_QUEUE_ELEMS);
+
+	return true;
+}
+
+/* every word of the buffer depends on the sequence number */
+static uint32_t stress_word(uint32_t seq, uint32_t i)
+{
+	return (seq ^ i) * 2654435761u;
+}
+
+/* spin until the queue has room or an element, -ETIMEDOUT on a stall */
+static int stress_wait(unsigned int *spins, uint64_t *since)
+{
+	uint64_t now;
+
+	if (++*spins % STRESS_SPINS)
+		return 0;
+
+	sched_yield();
+	now = now_ns();
+	if (!*since)
+		*since = now;
+
+	return now - *since > STRESS_STALL_NS ? -ETIMEDOUT : 0;
+}
+
+/* check the buffers received and give them back */
+static int stress_consumer(void)
+{
+	struct stress_bd bd;
+	unsigned int spins = 0;
+	uint64_t since = 0;
+	uint32_t seq = 0, i;
+	int err;
+
+	while (seq < num_msgs) {
+		if (!stress_pop(&shared->chan, &bd)) {
+			err = stress_wait(&spins, &since);
+			if (err)
+				return err;
+			continue;
+		}
+		since = 0;
+
+		if (bd.pool_id || bd.buf_id >= STRESS_BUFS
+		    || bd.data_size != seq) {
+			shared->corrupted++;
+			/* don't give back a buffer that isn't ours */
+			if (bd.buf_id >= STRESS_BUFS)
+				return -EIO;
+		} else {
+			for (i = 0; i < STRESS_BUF_WORDS; i++)
+				if (readl_relaxed(&shared->buf[bd.buf_id][i])
+				    != stress_word(seq, i))
+					break;
+			if (i < STRESS_BUF_WORDS)
+				shared->corrupted++;
+		}
+		seq++;
+
+		/* the free queue has room for all the buffers */
+		bd.data_size = 0;
+		if (!stress_push(&shared->free, &bd))
+			return -ENOSPC;
+	}
+
+	return 0;
+}
+
+/* send sequence numbers, keeping at most a window of buffers in flight */
+static int stress_producer(void)
+{
+	struct stress_bd bd = { 0 };
+	unsigned int spins = 0;
+	uint64_t since = 0;
+	uint32_t seq, i;
+	int err;
+
+	/* the pool starts with its free buffers queued */
+	for (i = 0; i < window; i++) {
+		bd.buf_id = i;
+		stress_push(&shared->free, &bd);
+	}
+
+	for (seq = 0; seq < num_msgs; seq++) {
+		while (!stress_pop(&shared->free, &bd)) {
+			err = stress_wait(&spins, &since);
+			if (err)
+				return err;
+		}
+		since = 0;
+
+		if (bd.buf_id >= STRESS_BUFS)
+			return -EIO;
+
+		for (i = 0; i < STRESS_BUF_WORDS; i++)
+			writel_relaxed(stress_word(seq, i),
+				       &shared->buf[bd.buf_id][i]);
+		bd.data_size = seq;
+
+		/* the channel queue has room for all the buffers */
+		if (!stress_push(&shared->chan, &bd))
+			return -ENOSPC;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t start, elapsed;
+	int opt, status, err;
+	pid_t pid;
+
+	while ((opt = getopt(argc, argv, "n:w:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			num_msgs = strtoul(optarg, NULL, 0);
+			break;
+		case 'w':
+			window = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			num_msgs = 0;
+			break;
+		}
+	}
+
+	if (!num_msgs || !window || window > STRESS_BUFS) {
+		printf("Usage: %s [-n messages] [-w window]\n"
+		       "  -n  messages to send, default 10000000\n"
+		       "  -w  buffers in flight, up to %u, default %u\n",
+		       argv[0], STRESS_BUFS, STRESS_BUFS);
+		return opt == 'h' ? 0 : -EINVAL;
+	}
+
+	shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE,
+		      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (shared == MAP_FAILED) {
+		stress_err("can't map the queues: %d\n", -errno);
+		return -errno;
+	}
+
+	start = now_ns();
+	pid = fork();
+	if (pid < 0) {
+		stress_err("can't fork the consumer: %d\n", -errno);
+		return -errno;
+	}
+	if (!pid)
+		_exit(stress_consumer() ? EXIT_FAILURE : EXIT_SUCCESS);
+
+	err = stress_producer();
+	if (err)
+		kill(pid, SIGKILL);
+	if (waitpid(pid, &status, 0) < 0)
+		err = err ? err : -errno;
+	else if (!err && (!WIFEXITED(status) || WEXITSTATUS(status)))
+		err = -ETIMEDOUT;
+	elapsed = now_ns() - start;
+
+	printf("%u messages in %.3f s, %.2f Mmsg/s\n", num_msgs,
+	       (double)elapsed / NSEC_PER_SEC, num_msgs * 1e3 / elapsed);
+	printf("corrupted: %llu\n", (unsigned long long)shared->corrupted);
+
+	if (err) {
+		stress_err("a side stalled: %d\n", err);
+		return err;
+	}
+
+	return shared->corrupted ? -EIO : 0;
+}
@@ -0,0 +1,275 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "ipc-broker-proto.h"
+
+/*
+ * Ring stress test: a producer process sends sequence numbers through the
+ * broker descriptor ring to a consumer process, which checks every descriptor
+ * and returns it on a second ring, as broker and client do with Rx and release.
+ * Both sides sleep on an eventfd when they run out of work and are only woken
+ * up when the other side finds their ring empty, so a descriptor read before
+ * it was published shows as corrupted and a missed wake-up as a ring found
+ * non-empty after a timeout.
+ */
+
+#define STRESS_TIMEOUT_MS 100
+#define STRESS_STALLS 20
+#define STRESS_SPINS 1024u
+#define NSEC_PER_SEC 1000000000ull
+
+#define stress_err(fmt, ...) fprintf(stderr, "ipc-shm-ring-stress: " fmt, \
+				     ##__VA_ARGS__)
+
+/**
+ * struct stress_side - ring consumed by one side
+ * @ring:	descriptors to consume
+ * @fd:		eventfd the side sleeps on
+ * @corrupted:	descriptors with unexpected content
+ * @lost:	wake-ups missed, ring found non-empty after a timeout
+ */
+struct stress_side {
+	struct ipc_broker_ring ring;
+	int fd;
+	uint64_t corrupted;
+	uint64_t lost;
+};
+
+/* memory shared by both processes */
+static struct {
+	struct stress_side fwd;
+	struct stress_side back;
+} *shared;
+
+static uint32_t num_msgs = 10000000, window = IPC_BROKER_RING_LEN;
+static int busy;
+
+static uint64_t now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+/* every field of the descriptor depends on the sequence number */
+static void stress_fill(struct ipc_broker_desc *desc, uint32_t seq)
+{
+	desc->slot = (uint16_t)(seq >> 3);
+	desc->pool = (uint16_t)~seq;
+	desc->off = seq;
+	desc->size = seq * 2654435761u;
+	desc->reserved = ~seq;
+}
+
+static int stress_check(const struct ipc_broker_desc *desc, uint32_t seq)
+{
+	struct ipc_broker_desc expected;
+
+	stress_fill(&expected, seq);
+
+	return memcmp(desc, &expected, sizeof(expected)) ? -EIO : 0;
+}
+
+static void stress_push(struct stress_side *peer, uint32_t seq)
+{
+	struct ipc_broker_desc desc;
+	uint64_t one = 1;
+	bool was_empty;
+
+	stress_fill(&desc, seq);
+	if (!ipc_broker_push(&peer->ring, &desc, &was_empty)) {
+		/* in flight descriptors are bounded by the window */
+		stress_err("ring full\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (was_empty && !busy
+	    && write(peer->fd, &one, sizeof(one)) != sizeof(one)) {
+		stress_err("can't wake up the peer: %d\n", -errno);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * consume the descriptors of a side in order, sleeping when its ring is
+ * empty; return the number consumed, negative if the peer stalled
+ */
+static int stress_pop(struct stress_side *side, uint32_t *seq)
+{
+	struct pollfd pfd = { .fd = side->fd, .events = POLLIN };
+	struct ipc_broker_desc desc;
+	unsigned int spins = 0;
+	int stalls = 0, n = 0;
+	uint64_t count;
+
+	for (;;) {
+		while (ipc_broker_pop(&side->ring, &desc)) {
+			if (stress_check(&desc, *seq))
+				side->corrupted++;
+			(*seq)++;
+			n++;
+		}
+		if (n)
+			return n;
+
+		if (busy) {
+			if (++spins % STRESS_SPINS == 0)
+				sched_yield();
+			continue;
+		}
+
+		if (poll(&pfd, 1, STRESS_TIMEOUT_MS) > 0) {
+			if (read(side->fd, &count, sizeof(count)) < 0)
+				return -errno;
+			continue;
+		}
+
+		/* woken up by the timeout with descriptors to consume */
+		if (ipc_broker_ring_count(&side->ring)) {
+			side->lost++;
+			continue;
+		}
+		if (++stalls == STRESS_STALLS)
+			return -ETIMEDOUT;
+	}
+}
+
+/* check the descriptors sent and return them */
+static int stress_consumer(void)
+{
+	uint32_t seq = 0, i;
+	int n;
+
+	while (seq < num_msgs) {
+		i = seq;
+		n = stress_pop(&shared->fwd, &seq);
+		if (n < 0)
+			return n;
+		for (; i < seq; i++)
+			stress_push(&shared->back, i);
+	}
+
+	return 0;
+}
+
+/* send sequence numbers, keeping at most a window of them in flight */
+static int stress_producer(void)
+{
+	uint32_t sent = 0, returned = 0;
+	int n;
+
+	while (returned < num_msgs) {
+		while (sent < num_msgs && sent - returned < window)
+			stress_push(&shared->fwd, sent++);
+
+		n = stress_pop(&shared->back, &returned);
+		if (n < 0)
+			return n;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t start, elapsed;
+	int opt, status, err;
+	pid_t pid;
+
+	while ((opt = getopt(argc, argv, "n:w:bh")) != -1) {
+		switch (opt) {
+		case 'n':
+			num_msgs = strtoul(optarg, NULL, 0);
+			break;
+		case 'w':
+			window = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			busy = 1;
+			break;
+		default:
+			num_msgs = 0;
+			break;
+		}
+	}
+
+	if (!num_msgs || !window || window > IPC_BROKER_RING_LEN) {
+		printf("Usage: %s [-n messages] [-w window] [-b]\n"
+		       "  -n  messages to send, default 10000000\n"
+		       "  -w  messages in flight, up to %u, default %u\n"
+		       "  -b  busy poll the rings instead of sleeping\n",
+		       argv[0], IPC_BROKER_RING_LEN, IPC_BROKER_RING_LEN);
+		return opt == 'h' ? 0 : -EINVAL;
+	}
+
+	shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE,
+		      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (shared == MAP_FAILED) {
+		stress_err("can't map the rings: %d\n", -errno);
+		return -errno;
+	}
+
+	shared->fwd.fd = eventfd(0, EFD_NONBLOCK);
+	shared->back.fd = eventfd(0, EFD_NONBLOCK);
+	if (shared->fwd.fd < 0 || shared->back.fd < 0) {
+		stress_err("can't create eventfds: %d\n", -errno);
+		return -errno;
+	}
+
+	start = now_ns();
+	pid = fork();
+	if (pid < 0) {
+		stress_err("can't fork the consumer: %d\n", -errno);
+		return -errno;
+	}
+	if (!pid)
+		_exit(stress_consumer() ? EXIT_FAILURE : EXIT_SUCCESS);
+
+	err = stress_producer();
+	if (err)
+		kill(pid, SIGKILL);
+	if (waitpid(pid, &status, 0) < 0)
+		err = err ? err : -errno;
+	else if (!err && (!WIFEXITED(status) || WEXITSTATUS(status)))
+		err = -ETIMEDOUT;
+	elapsed = now_ns() - start;
+
+	printf("%u messages in %.3f s, %.2f Mmsg/s round trip, %s\n",
+	       num_msgs, (double)elapsed / NSEC_PER_SEC,
+	       num_msgs * 1e3 / elapsed, busy ? "busy polling" : "sleeping");
+	printf("corrupted: %llu sent, %llu returned\n",
+	       (unsigned long long)shared->fwd.corrupted,
+	       (unsigned long long)shared->back.corrupted);
+	printf("lost wake-ups: %llu consumer, %llu producer\n",
+	       (unsigned long long)shared->fwd.lost,
+	       (unsigned long long)shared->back.lost);
+
+	if (err) {
+		stress_err("a side stalled: %d\n", err);
+		return err;
+	}
+
+	if (shared->fwd.corrupted || shared->back.corrupted
+	    || shared->fwd.lost || shared->back.lost)
+		return -EIO;
+
+	return 0;
+}
@@ -0,0 +1,726 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Copyright 2026 NXP
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ipc-shm.h"
+#include "ipc-layout.h"
+#include "ipcf_Ip_Cfg.h"
+
+/*
+ * Shared memory inspector: maps the local and remote shared memory of the
+ * instances of the sample configuration read-only and decodes the descriptor
+ * rings of the driver layout (see ext/ipc-layout.h), showing per channel the
+ * queue depth of each direction, the buffers in use per pool and message
+ * rates sampled over time. Nothing is written to shared memory and no
+ * doorbell or interrupt is touched, so the running application is not
+ * disturbed.
+ *
+ * A ring starts with its write index, advanced by the side owning the memory,
+ * and its read index, advanced by the other side, followed by 8 byte buffer
+ * descriptors made of the pool index, the buffer index and the data size. The
+ * channel ring of a region holds the buffers sent by its owner and not yet
+ * received, and the ring of each pool the buffers its owner released, free for
+ * the other side to send.
+ */
+
+#define TOP_MAX_INSTANCES 4u
+#define TOP_MAX_CHANNELS ((int)IPC_SHM_MAX_CHANNELS)
+#define TOP_MAX_POOLS ((int)IPC_SHM_MAX_POOLS)
+#define TOP_DEV_MEM "/dev/mem"
+/* shared memory files of the driver built with HOST=yes */
+#define TOP_HOST_SHM_NAME "/ipc-shm-%lx"
+#define TOP_NAME_LEN 64
+#define NSEC_PER_SEC 1000000000ull
+#define NSEC_PER_MSEC 1000000ull
+#define NSEC_PER_USEC 1000ull
+
+#define top_err(fmt, ...) fprintf(stderr, "ipc-shm-top: " fmt, ##__VA_ARGS__)
+
+/**
+ * struct top_ring - descriptor queue ring being watched
+ * @idx:	write and read indices, followed by the descriptors
+ * @elem_num:	ring entries, one more than the descriptors it can hold
+ * @seen:	sampled at least once
+ * @valid:	indices were in range at the last sample
+ * @depth:	descriptors in the ring at the last sample
+ * @min:	smallest depth sampled since the last refresh
+ * @max:	largest depth sampled since the last refresh
+ * @write:	write index at the last sample
+ * @pushed:	descriptors pushed since the last refresh
+ */
+struct top_ring {
+	const volatile uint32_t *idx;
+	uint32_t elem_num;
+	bool seen;
+	bool valid;
+	uint32_t depth;
+	uint32_t min;
+	uint32_t max;
+	uint32_t write;
+	uint64_t pushed;
+};
+
+/**
+ * struct top_pool - buffer pool of a managed channel
+ * @buf_size:	buffer size
+ * @num_bufs:	number of buffers
+ * @tx_free:	remote ring of the buffers free for local Tx
+ * @rx_free:	local ring of the buffers free for remote Tx
+ * @bad:	descriptors of the free rings not belonging to the pool
+ */
+struct top_pool {
+	uint32_t buf_size;
+	uint32_t num_bufs;
+	struct top_ring tx_free;
+	struct top_ring rx_free;
+	uint32_t bad;
+};
+
+/**
+ * struct top_chan - channel of an instance
+ * @managed:	managed channel
+ * @size:	unmanaged channel memory size
+ * @num_pools:	number of pools
+ * @tx:		local ring of the buffers sent, not yet received by the remote
+ * @rx:		remote ring of the buffers received, not yet read locally
+ * @pools:	pools of managed channels
+ */
+struct top_chan {
+	bool managed;
+	uint32_t size;
+	int num_pools;
+	struct top_ring tx;
+	struct top_ring rx;
+	struct top_pool pools[TOP_MAX_POOLS];
+};
+
+/**
+ * struct top_inst - instance being watched
+ * @cfg:		instance configuration
+ * @local_map:		local shared memory mapping
+ * @remote_map:		remote shared memory mapping
+ * @local_size:		local shared memory mapping size
+ * @remote_size:	remote shared memory mapping size
+ * @local:		local shared memory
+ * @remote:		remote shared memory
+ * @num_channels:	number of channels
+ * @chan:		channels
+ */
+struct top_inst {
+	const struct ipc_shm_cfg *cfg;
+	void *local_map;
+	void *remote_map;
+	size_t local_size;
+	size_t remote_size;
+	const volatile uint8_t *local;
+	const volatile uint8_t *remote;
+	int num_channels;
+	struct top_chan chan[TOP_MAX_CHANNELS];
+};
+
+/**
+ * struct ipc_shm_top - inspector private data
+ * @host:		map shared memory files of the host build
+ * @align:		layout alignment, see ipc_shm_ext_set_layout()
+ * @json:		print one JSON snapshot and exit
+ * @period_ns:		sampling period
+ * @interval_ns:	refresh interval
+ * @count:		refreshes before exit, 0 for no limit
+ * @num_instances:	number of instances
+ * @inst:		instances
+ */
+static struct ipc_shm_top {
+	bool host;
+	bool json;
+	uint32_t align;
+	uint64_t period_ns;
+	uint64_t interval_ns;
+	uint32_t count;
+	uint32_t num_instances;
+	struct top_inst inst[TOP_MAX_INSTANCES];
+} top;
+
+/* link with generated variables, the callbacks are never called */
+const void *rx_cb_arg = &top;
+
+void ctrl_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *mem)
+{
+}
+
+void data_chan_rx_cb(void *arg, const uint8_t instance, int chan_id,
+		void *buf, size_t size)
+{
+}
+
+static volatile sig_atomic_t stop;
+
+static void top_stop(int sig)
+{
+	stop = 1;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+/* map shared memory read-only the way the OS layer maps it read-write */
+static int top_map(uintptr_t addr, size_t size, void **map, size_t *map_size,
+		const volatile uint8_t **shm)
+{
+	size_t page_size = sysconf(_SC_PAGE_SIZE);
+	char name[TOP_NAME_LEN];
+	size_t offset = 0;
+	struct stat st;
+	int fd;
+
+	if (top.host) {
+		snprintf(name, sizeof(name), TOP_HOST_SHM_NAME,
+			 (unsigned long)addr);
+		fd = shm_open(name, O_RDONLY, 0);
+		if (fd < 0) {
+			top_err("can't open %s: %s\n", name, strerror(errno));
+			return -errno;
+		}
+		if (fstat(fd, &st) || (size_t)st.st_size < size) {
+			top_err("%s is smaller than shm_size\n", name);
+			close(fd);
+			return -EINVAL;
+		}
+	} else {
+		fd = open(TOP_DEV_MEM, O_RDONLY);
+		if (fd < 0) {
+			top_err("can't open %s: %s\n", TOP_DEV_MEM,
+				strerror(errno));
+			return -errno;
+		}
+		/* truncate address to a multiple of page size */
+		offset = addr % page_size;
+		addr -= offset;
+	}
+
+	*map_size = offset + size;
+	*map = mmap(NULL, *map_size, PROT_READ, MAP_SHARED, fd,
+		    top.host ? 0 : (off_t)addr);
+	close(fd);
+	if (*map == MAP_FAILED) {
+		top_err("can't map memory %lx: %s\n", (unsigned long)addr,
+			strerror(errno));
+		return -ENOMEM;
+	}
+	*shm = (const volatile uint8_t *)*map + offset;
+
+	return 0;
+}
+
+static void top_ring_init(struct top_ring *ring, const volatile uint8_t *shm,
+		uint32_t num_bds)
+{
+	memset(ring, 0, sizeof(*ring));
+	ring->idx = (const volatile uint32_t *)shm;
+	ring->elem_num = num_bds + 1u;
+}
+
+/* locate the rings of each channel following the driver layout */
+static int top_layout(struct top_inst *inst)
+{
+	const struct ipc_layout_chan *lc;
+	struct ipc_layout map;
+	struct top_chan *chan;
+	struct top_pool *pool;
+	uint32_t bufs;
+	int c, p, err;
+
+	err = ipc_layout_plan(inst->cfg, top.align, &map);
+	if (err)
+		return err;
+	inst->num_channels = map.num_channels;
+
+	for (c = 0; c < map.num_channels; c++) {
+		chan = &inst->chan[c];
+		lc = &map.chan[c];
+		if (!lc->managed) {
+			chan->size = lc->size;
+			continue;
+		}
+
+		chan->managed = true;
+		chan->num_pools = lc->num_pools;
+
+		bufs = 0;
+		for (p = 0; p < lc->num_pools; p++)
+			bufs += lc->pools[p].num_bufs;
+		top_ring_init(&chan->tx, inst->local + lc->start, bufs);
+		top_ring_init(&chan->rx, inst->remote + lc->start, bufs);
+
+		for (p = 0; p < lc->num_pools; p++) {
+			pool = &chan->pools[p];
+			pool->buf_size = lc->pools[p].buf_size;
+			pool->num_bufs = lc->pools[p].num_bufs;
+			top_ring_init(&pool->rx_free,
+				      inst->local + lc->pools[p].ring,
+				      pool->num_bufs);
+			top_ring_init(&pool->tx_free,
+				      inst->remote + lc->pools[p].ring,
+				      pool->num_bufs);
+		}
+	}
+
+	return 0;
+}
+
+static int top_attach(uint32_t i)
+{
+	struct top_inst *inst = &top.inst[i];
+	const struct ipc_shm_cfg *cfg;
+	int err;
+
+	cfg = &ipcf_shm_instances_cfg.shm_cfg[i];
+	inst->cfg = cfg;
+
+	err = top_map(cfg->local_shm_addr, cfg->shm_size, &inst->local_map,
+		      &inst->local_size, &inst->local);
+	if (err)
+		return err;
+
+	err = top_map(cfg->remote_shm_addr, cfg->shm_size, &inst->remote_map,
+		      &inst->remote_size, &inst->remote);
+	if (err) {
+		munmap(inst->local_map, inst->local_size);
+		inst->local_map = NULL;
+		return err;
+	}
+
+	err = top_layout(inst);
+	if (err)
+		top_err("instance %u layout exceeds shm_size\n", i);
+
+	return err;
+}
+
+static void top_detach(uint32_t i)
+{
+	struct top_inst *inst = &top.inst[i];
+
+	if (!inst->local_map)
+		return;
+
+	munmap(inst->remote_map, inst->remote_size);
+	munmap(inst->local_map, inst->local_size);
+	inst->local_map = NULL;
+}
+
+/* read the indices once, as a consistent pair is not guaranteed anyway */
+static void top_ring_sample(struct top_ring *ring)
+{
+	uint32_t write = ring->idx[0];
+	uint32_t read = ring->idx[1];
+	uint32_t n = ring->elem_num;
+
+	ring->valid = write < n && read < n;
+	if (!ring->valid) {
+		ring->seen = false;
+		return;
+	}
+
+	ring->depth = (write + n - read) % n;
+	if (!ring->seen) {
+		ring->min = ring->depth;
+		ring->max = ring->depth;
+		ring->write = write;
+		ring->seen = true;
+	}
+
+	if (ring->depth < ring->min)
+		ring->min = ring->depth;
+	if (ring->depth > ring->max)
+		ring->max = ring->depth;
+
+	/* undercounts if the ring wrapped between two samples */
+	ring->pushed += (write + n - ring->write) % n;
+	ring->write = write;
+}
+
+static void top_ring_reset(struct top_ring *ring)
+{
+	ring->min = ring->depth;
+	ring->max = ring->depth;
+	ring->pushed = 0;
+}
+
+/* count free list descriptors that don't belong to the pool */
+static uint32_t top_free_check(const struct top_ring *ring, int pool_id,
+		uint32_t num_bufs)
+{
+	const volatile uint32_t *bds = ring->idx + 2;
+	uint32_t i, j, bd, bad = 0;
+	int16_t bd_pool;
+
+	if (!ring->valid)
+		return 0;
+
+	for (i = 0, j = ring->idx[1] % ring->elem_num; i < ring->depth;
+	     i++, j = (j + 1u) % ring->elem_num) {
+		bd = bds[2u * j];
+		bd_pool = (int16_t)(bd & 0xffffu);
+		if (bd_pool != pool_id || (bd >> 16) >= num_bufs)
+			bad++;
+	}
+
+	return bad;
+}
+
+static void top_sample(void)
+{
+	struct top_chan *chan;
+	struct top_pool *pool;
+	uint32_t i;
+	int c, p;
+
+	for (i = 0; i < top.num_instances; i++) {
+		for (c = 0; c < top.inst[i].num_channels; c++) {
+			chan = &top.inst[i].chan[c];
+			if (!chan->managed)
+				continue;
+
+			top_ring_sample(&chan->tx);
+			top_ring_sample(&chan->rx);
+			for (p = 0; p < chan->num_pools; p++) {
+				pool = &chan->pools[p];
+				top_ring_sample(&pool->tx_free);
+				top_ring_sample(&pool->rx_free);
+			}
+		}
+	}
+}
+
+static void top_reset(void)
+{
+	struct top_chan *chan;
+	struct top_pool *pool;
+	uint32_t i;
+	int c, p;
+
+	for (i = 0; i < top.num_instances; i++) {
+		for (c = 0; c < top.inst[i].num_channels; c++) {
+			chan = &top.inst[i].chan[c];
+			top_ring_reset(&chan->tx);
+			top_ring_reset(&chan->rx);
+			for (p = 0; p < chan->num_pools; p++) {
+				pool = &chan->pools[p];
+				top_ring_reset(&pool->tx_free);
+				top_ring_reset(&pool->rx_free);
+			}
+		}
+	}
+}
+
+/* walk the free lists once per refresh, they are longer than the indices */
+static void top_check(void)
+{
+	struct top_chan *chan;
+	struct top_pool *pool;
+	uint32_t i;
+	int c, p;
+
+	for (i = 0; i < top.num_instances; i++) {
+		for (c = 0; c < top.inst[i].num_channels; c++) {
+			chan = &top.inst[i].chan[c];
+			for (p = 0; p < chan->num_pools; p++) {
+				pool = &chan->pools[p];
+				pool->bad = top_free_check(&pool->tx_free, p,
+							   pool->num_bufs)
+					    + top_free_check(&pool->rx_free, p,
+							     pool->num_bufs);
+			}
+		}
+	}
+}
+
+static double top_rate(const struct top_ring *ring, uint64_t elapsed)
+{
+	return elapsed ? (double)ring->pushed * NSEC_PER_SEC / elapsed : 0.0;
+}
+
+static uint64_t top_state(const volatile uint8_t *shm)
+{
+	return *(const volatile uint64_t *)shm;
+}
+
+static void top_print_queue(const struct top_ring *ring, uint64_t elapsed)
+{
+	if (!ring->valid) {
+		printf(" %9s %5s %9s", "-", "-", "-");
+		return;
+	}
+
+	printf(" %4u/%-4u %5u %9.0f", ring->depth, ring->elem_num - 1u,
+	       ring->max, top_rate(ring, elapsed));
+}
+
+/* buffers not in the free list, taken by the other side or in flight */
+static void top_print_used(const struct top_ring *ring, uint32_t num_bufs)
+{
+	if (!ring->valid) {
+		printf(" %9s %5s", "-", "-");
+		return;
+	}
+
+	printf(" %4u/%-4u %5u", num_bufs - ring->depth, num_bufs,
+	       num_bufs - ring->min);
+}
+
+static void top_print(uint64_t elapsed)
+{
+	const struct top_inst *inst;
+	const struct top_chan *chan;
+	const struct top_pool *pool;
+	uint32_t i;
+	int c, p;
+
+	/* clear the terminal like top */
+	printf("\033[H\033[2J");
+	printf("ipc-shm-top - %s shared memory, %.1f s interval\n",
+	       top.host ? "host" : "physical", (double)elapsed / NSEC_PER_SEC);
+
+	for (i = 0; i < top.num_instances; i++) {
+		inst = &top.inst[i];
+		printf("\ninstance %u: local %#lx state %#llx, "
+		       "remote %#lx state %#llx, size %#x\n", i,
+		       (unsigned long)inst->cfg->local_shm_addr,
+		       (unsigned long long)top_state(inst->local),
+		       (unsigned long)inst->cfg->remote_shm_addr,
+		       (unsigned long long)top_state(inst->remote),
+		       inst->cfg->shm_size);
+		printf("%4s %-9s %9s %5s %9s %9s %5s %9s\n", "CHAN", "TYPE",
+		       "TX QUEUE", "PEAK", "TX/s", "RX QUEUE", "PEAK", "RX/s");
+
+		for (c = 0; c < inst->num_channels; c++) {
+			chan = &inst->chan[c];
+			if (!chan->managed) {
+				printf("%4d %-9s %u bytes\n", c, "unmanaged",
+				       chan->size);
+				continue;
+			}
+
+			printf("%4d %-9s", c, "managed");
+			top_print_queue(&chan->tx, elapsed);
+			top_print_queue(&chan->rx, elapsed);
+			printf("\n");
+
+			printf("%4s %4s %9s %9s %5s %9s %5s %4s\n", "", "POOL",
+			       "BUF SIZE", "TX IN USE", "PEAK", "RX IN USE",
+			       "PEAK", "BAD");
+			for (p = 0; p < chan->num_pools; p++) {
+				pool = &chan->pools[p];
+				printf("%4s %4d %9u", "", p, pool->buf_size);
+				top_print_used(&pool->tx_free, pool->num_bufs);
+				top_print_used(&pool->rx_free, pool->num_bufs);
+				printf(" %4u\n", pool->bad);
+			}
+		}
+	}
+	fflush(stdout);
+}
+
+static void top_json_queue(const char *name, const struct top_ring *ring,
+		uint64_t elapsed)
+{
+	printf("\"%s\": {\"valid\": %s, \"depth\": %u, \"capacity\": %u, "
+	       "\"peak\": %u, \"rate\": %.1f}", name,
+	       ring->valid ? "true" : "false", ring->depth,
+	       ring->elem_num - 1u, ring->max, top_rate(ring, elapsed));
+}
+
+static void top_json_used(const char *name, const struct top_ring *ring,
+		uint32_t num_bufs)
+{
+	printf("\"%s\": {\"valid\": %s, \"in_use\": %u, \"peak\": %u}", name,
+	       ring->valid ? "true" : "false",
+	       ring->valid ? num_bufs - ring->depth : 0u,
+	       ring->valid ? num_bufs - ring->min : 0u);
+}
+
+static void top_json(uint64_t elapsed)
+{
+	const struct top_inst *inst;
+	const struct top_chan *chan;
+	const struct top_pool *pool;
+	uint32_t i;
+	int c, p;
+
+	printf("{\"interval_ns\": %llu, \"instances\": [",
+	       (unsigned long long)elapsed);
+	for (i = 0; i < top.num_instances; i++) {
+		inst = &top.inst[i];
+		printf("%s\n  {\"instance\": %u, \"local_shm_addr\": %lu, "
+		       "\"local_state\": %llu, \"remote_shm_addr\": %lu, "
+		       "\"remote_state\": %llu, \"shm_size\": %u, "
+		       "\"channels\": [", i ? "," : "", i,
+		       (unsigned long)inst->cfg->local_shm_addr,
+		       (unsigned long long)top_state(inst->local),
+		       (unsigned long)inst->cfg->remote_shm_addr,
+		       (unsigned long long)top_state(inst->remote),
+		       inst->cfg->shm_size);
+
+		for (c = 0; c < inst->num_channels; c++) {
+			chan = &inst->chan[c];
+			printf("%s\n    {\"channel\": %d, ", c ? "," : "", c);
+			if (!chan->managed) {
+				printf("\"type\": \"unmanaged\", "
+				       "\"size\": %u}", chan->size);
+				continue;
+			}
+
+			printf("\"type\": \"managed\", ");
+			top_json_queue("tx_queue", &chan->tx, elapsed);
+			printf(", ");
+			top_json_queue("rx_queue", &chan->rx, elapsed);
+			printf(", \"pools\": [");
+			for (p = 0; p < chan->num_pools; p++) {
+				pool = &chan->pools[p];
+				printf("%s\n      {\"pool\": %d, "
+				       "\"buf_size\": %u, \"num_bufs\": %u, ",
+				       p ? "," : "", p, pool->buf_size,
+				       pool->num_bufs);
+				top_json_used("tx", &pool->tx_free,
+					      pool->num_bufs);
+				printf(", ");
+				top_json_used("rx", &pool->rx_free,
+					      pool->num_bufs);
+				printf(", \"bad\": %u}", pool->bad);
+			}
+			printf("]}");
+		}
+		printf("]}");
+	}
+	printf("\n]}\n");
+}
+
+static void top_sleep(uint64_t ns)
+{
+	struct timespec ts = {
+		.tv_sec = ns / NSEC_PER_SEC,
+		.tv_nsec = ns % NSEC_PER_SEC,
+	};
+
+	nanosleep(&ts, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t period_us = 1000, interval_ms = 1000, i;
+	uint64_t last, now;
+	int opt, err = 0;
+
+	top.align = IPC_LAYOUT_BUF_ALIGN;
+	while ((opt = getopt(argc, argv, "Hjs:d:n:a:h")) != -1) {
+		switch (opt) {
+		case 'H':
+			top.host = true;
+			break;
+		case 'j':
+			top.json = true;
+			break;
+		case 's':
+			period_us = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			interval_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			top.count = strtoul(optarg, NULL, 0);
+			break;
+		case 'a':
+			top.align = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			period_us = 0;
+			break;
+		}
+	}
+
+	if (!period_us || !interval_ms
+	    || (uint64_t)period_us > (uint64_t)interval_ms * 1000u
+	    || top.align < IPC_LAYOUT_BUF_ALIGN
+	    || top.align > IPC_LAYOUT_MAX_ALIGN
+	    || (top.align & (top.align - 1u))) {
+		printf("Usage: %s [-H] [-j] [-s period] [-d interval] "
+		       "[-n count] [-a align]\n"
+		       "  -H  watch the shared memory files of the host build\n"
+		       "  -j  print one JSON snapshot after one interval\n"
+		       "  -s  sampling period in us, default 1000\n"
+		       "  -d  refresh interval in ms, default 1000\n"
+		       "  -n  refreshes before exit, default unlimited\n"
+		       "  -a  layout alignment, default 8 (as configured)\n",
+		       argv[0]);
+		return opt == 'h' ? 0 : -EINVAL;
+	}
+	top.period_ns = period_us * NSEC_PER_USEC;
+	top.interval_ns = interval_ms * NSEC_PER_MSEC;
+
+	top.num_instances = ipcf_shm_instances_cfg.num_instances;
+	if (top.num_instances > TOP_MAX_INSTANCES) {
+		top_err("only the first %u instances are watched\n",
+			TOP_MAX_INSTANCES);
+		top.num_instances = TOP_MAX_INSTANCES;
+	}
+
+	for (i = 0; i < top.num_instances; i++) {
+		err = top_attach(i);
+		if (err)
+			goto out;
+	}
+
+	signal(SIGINT, top_stop);
+	signal(SIGTERM, top_stop);
+
+	top_sample();
+	top_reset();
+	last = now_ns();
+	while (!stop) {
+		top_sleep(top.period_ns);
+		top_sample();
+
+		now = now_ns();
+		if (now - last < top.interval_ns)
+			continue;
+
+		top_check();
+		if (top.json) {
+			top_json(now - last);
+			break;
+		}
+		top_print(now - last);
+		if (top.count && !--top.count)
+			break;
+
+		top_reset();
+		last = now;
+	}
+
+out:
+	for (i = 0; i < top.num_instances; i++)
+		top_detach(i);
+
+	return err;
+}